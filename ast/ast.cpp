@@ -1,70 +1,341 @@
 #include "..\main.h"
 
-Ast::Ast(const Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs) : bytecode(bytecode), ignoreDebugInfo(ignoreDebugInfo), minimizeDiffs(minimizeDiffs) {}
+Ast::Ast(Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs, const bool& isStreaming, const Budget& budget)
+	: bytecode(bytecode), ignoreDebugInfo(ignoreDebugInfo), minimizeDiffs(minimizeDiffs), isStreaming(isStreaming), budget(budget), deadline(budget.timeLimit ? GetTickCount64() + budget.timeLimit : 0) {}
+
+thread_local Ast::NodePool* Ast::nodePool = nullptr;
 
 Ast::~Ast() {
-	for (uint32_t i = statements.size(); i--;) {
-		delete statements[i];
+	for (uint32_t i = streamNodePools.size(); i--;) {
+		delete_nodes(streamNodePools[i]);
 	}
 
-	for (uint32_t i = functions.size(); i--;) {
-		delete functions[i];
+	for (uint32_t i = nodePools.size(); i--;) {
+		delete_nodes(nodePools[i]);
+	}
+}
+
+void Ast::delete_nodes(NodePool& nodePool) {
+	for (uint32_t i = nodePool.statements.size(); i--;) {
+		delete nodePool.statements[i];
+	}
+
+	for (uint32_t i = nodePool.functions.size(); i--;) {
+		delete nodePool.functions[i];
 	}
 
-	for (uint32_t i = expressions.size(); i--;) {
-		delete expressions[i];
+	for (uint32_t i = nodePool.expressions.size(); i--;) {
+		delete nodePool.expressions[i];
 	}
+
+	nodePool = {};
 }
 
 Ast::Function*& Ast::new_function(const Bytecode::Prototype& prototype, const uint32_t& level) {
-	return functions.emplace_back(new Function(prototype, level, ignoreDebugInfo));
+	if (budget.nodeLimit) nodeCount.fetch_add(1, std::memory_order_relaxed);
+	nodePool->add_memory_usage(sizeof(Function));
+	bytecode.load_prototype(prototype);
+	return nodePool->functions.emplace_back(new Function(prototype, level, ignoreDebugInfo));
 }
 
 Ast::Statement*& Ast::new_statement(const AST_STATEMENT& type) {
-	return statements.emplace_back(new Statement(type));
+	if (budget.nodeLimit) nodeCount.fetch_add(1, std::memory_order_relaxed);
+	nodePool->add_memory_usage(sizeof(Statement));
+	return nodePool->statements.emplace_back(new Statement(type));
 }
 
 Ast::Expression*& Ast::new_expression(const AST_EXPRESSION& type) {
-	return expressions.emplace_back(new Expression(type));
+	if (budget.nodeLimit) nodeCount.fetch_add(1, std::memory_order_relaxed);
+	nodePool->add_memory_usage(sizeof(Expression));
+	return nodePool->expressions.emplace_back(new Expression(type));
+}
+
+void Ast::reserve_block(Statement& statement, const uint32_t& size) {
+	statement.block.create()->reserve(size);
+	nodePool->add_memory_usage(size * sizeof(Statement*));
+}
+
+void Ast::check_budget() {
+	if (deadline && GetTickCount64() > deadline) exceed_budget("Time limit of " + std::to_string(budget.timeLimit / 1000) + " seconds exceeded", bytecode.filePath, DEBUG_INFO);
+	if (budget.nodeLimit && nodeCount.load(std::memory_order_relaxed) > budget.nodeLimit) exceed_budget("Node limit of " + std::to_string(budget.nodeLimit) + " nodes exceeded", bytecode.filePath, DEBUG_INFO);
+	if (budget.memoryLimit && memoryUsage.load(std::memory_order_relaxed) > budget.memoryLimit) exceed_budget("Memory limit of " + std::to_string(budget.memoryLimit >> 20) + " MB exceeded", bytecode.filePath, DEBUG_INFO);
 }
 
 void Ast::operator()() {
+	(*this)(*bytecode.main);
+}
+
+void Ast::operator()(const Bytecode::Prototype& prototype) {
 	print_progress_bar();
-	chunk = new_function(*bytecode.main, 0);
+	bytecode.load_prototype(prototype);
+	nodePools.resize(isStreaming ? 1 : std::min(get_file_thread_count(), prototype.descendants + 1));
+
+	for (uint32_t i = nodePools.size(); i--;) {
+		if (budget.memoryLimit) nodePools[i].memoryUsage = &memoryUsage;
+	}
+
+	nodePool = &nodePools.front();
+	chunk = new_function(prototype, 0);
+	chunk->upvalues.resize(prototype.upvalues.size());
+
+	for (uint8_t i = chunk->upvalues.size(); i--;) {
+		chunk->upvalues[i].slot = prototype.upvalues[i];
+		chunk->upvalues[i].slotScope = chunk->slotScopeCollector.new_slot_scope();
+		(*chunk->upvalues[i].slotScope)->name = chunk->hasDebugInfo ? Symbol(prototype.upvalueNames[i]) : Symbol(AST_SYMBOL_UPVALUE, 0, i);
+	}
+
 	isFR2Enabled = bytecode.header.version == Bytecode::BC_VERSION_2 && (bytecode.header.flags & Bytecode::BC_F_FR2);
 	prototypeDataLeft = bytecode.prototypesTotalSize;
-	uint32_t functionCounter = 0;
-	build_functions(*chunk, functionCounter);
-	functions.shrink_to_fit();
-	statements.shrink_to_fit();
-	expressions.shrink_to_fit();
+	build_function_trees(nodePools, { chunk });
 	erase_progress_bar();
 }
 
-void Ast::build_functions(Function& function, uint32_t& functionCounter) {
-	function.id = functionCounter;
-	functionCounter++;
+void Ast::build_functions(const std::vector<Function*>& functions) {
+	uint32_t functionCount = 0;
+
+	for (uint32_t i = functions.size(); i--;) {
+		bytecode.load_prototype(functions[i]->prototype);
+		functions[i]->usedGlobals.clear();
+		functionCount += functions[i]->prototype.descendants + 1;
+	}
+
+	streamNodePools.resize(std::min(get_file_thread_count(), functionCount));
+
+	for (uint32_t i = streamNodePools.size(); i--;) {
+		if (budget.memoryLimit) streamNodePools[i].memoryUsage = &memoryUsage;
+	}
+
+	build_function_trees(streamNodePools, functions);
+}
+
+void Ast::release_functions(const std::vector<Function*>& functions) {
+	for (uint32_t i = streamNodePools.size(); i--;) {
+		if (budget.nodeLimit) nodeCount -= streamNodePools[i].statements.size() + streamNodePools[i].functions.size() + streamNodePools[i].expressions.size();
+		streamNodePools[i].remove_memory_usage(streamNodePools[i].memoryCharged);
+		delete_nodes(streamNodePools[i]);
+	}
+
+	streamNodePools.clear();
+
+	for (uint32_t i = functions.size(); i--;) {
+		for (uint32_t j = functions[i]->slotScopeCollector.slotScopes.size(); j--;) {
+			delete functions[i]->slotScopeCollector.slotScopes[j];
+		}
+
+		functions[i]->slotScopeCollector.slotScopes = {};
+		functions[i]->slotScopeCollector.slotInfos = {};
+		functions[i]->locals = {};
+		functions[i]->labels = {};
+		functions[i]->labelIndices = {};
+		functions[i]->parameterNames = {};
+		functions[i]->block = {};
+		functions[i]->childFunctions = {};
+		functions[i]->usedGlobals = {};
+		functions[i]->declaredNames = {};
+		functions[i]->nameConstants = {};
+		bytecode.unload_prototypes(functions[i]->prototype);
+	}
+}
+
+void Ast::build_function_trees(std::vector<NodePool>& pools, const std::vector<Function*>& functions) {
+	static const auto has_smaller_subtree = [](Function* const& first, Function* const& second)->bool {
+		return first->prototype.descendants < second->prototype.descendants;
+	};
+
+	run_task_tree<Function*>(pools.size(), functions, has_smaller_subtree, [this, &pools](const uint32_t& worker, Function* const& function, std::vector<Function*>& childFunctions) {
+		nodePool = &pools[worker];
+		build_function(*function);
+
+		for (uint32_t i = function->childFunctions.size(), id = function->id + 1; i--;) {
+			function->childFunctions[i]->id = id;
+			id += function->childFunctions[i]->prototype.descendants + 1;
+
+			if (isStreaming && function == chunk) {
+				declare_function(*function->childFunctions[i]);
+				bytecode.unload_prototypes(function->childFunctions[i]->prototype);
+				continue;
+			}
+
+			childFunctions.emplace_back(function->childFunctions[i]);
+		}
+
+		prototypeDataLeft -= function->prototype.prototypeSize;
+		if (!worker) print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	});
+
+	for (uint32_t i = pools.size(); i--;) {
+		pools[i].functions.shrink_to_fit();
+		pools[i].statements.shrink_to_fit();
+		pools[i].expressions.shrink_to_fit();
+		pools[i].conditionNodePool = {};
+	}
+}
+
+void Ast::declare_function(Function& function) {
+	function.parameterNames.resize(function.prototype.header.parameters);
+
+	if (!function.hasDebugInfo) {
+		for (uint8_t i = function.parameterNames.size(); i--;) {
+			function.parameterNames[i] = Symbol(AST_SYMBOL_ARGUMENT, minimizeDiffs ? function.level : function.id, i);
+		}
+
+		return;
+	}
+
+	std::vector<std::string_view> names;
+	uint64_t namesSize = 0;
+
+	for (uint8_t i = 0; i < function.parameterNames.size(); i++) {
+		names.emplace_back(function.prototype.variableInfos[i].name);
+	}
+
+	for (uint32_t i = 0; i < function.prototype.instructions.size(); i++) {
+		switch (function.prototype.instructions[i].type) {
+		case Bytecode::BC_OP_GGET:
+		case Bytecode::BC_OP_GSET:
+			names.emplace_back(function.get_string_constant(function.prototype.instructions[i].d));
+		}
+	}
+
+	for (uint32_t i = names.size(); i--;) {
+		namesSize += names[i].size();
+	}
+
+	function.declaredNames.reserve(namesSize);
+
+	for (uint32_t i = 0; i < names.size(); i++) {
+		function.declaredNames += names[i];
+	}
+
+	for (uint32_t i = 0, offset = 0; i < names.size(); offset += names[i].size(), i++) {
+		if (i < function.parameterNames.size()) {
+			function.parameterNames[i] = Symbol(std::string_view(function.declaredNames.data() + offset, names[i].size()));
+			continue;
+		}
+
+		function.usedGlobals.emplace_back(function.declaredNames.data() + offset, names[i].size());
+	}
+}
+
+void Ast::build_function(Function& function) {
+	const uint32_t statementBase = nodePool->statements.size();
+	const uint32_t expressionBase = nodePool->expressions.size();
 	build_instructions(function);
 	function.usedGlobals.shrink_to_fit();
 	if (!function.hasDebugInfo) function.slotScopeCollector.build_upvalue_scopes();
+	check_budget();
 	build_slot_scopes(function, function.block, nullptr);
 	assert(function.slotScopeCollector.assert_scopes_closed(), "Failed to close slot scopes", bytecode.filePath, DEBUG_INFO);
+	check_budget();
 	eliminate_slots(function, function.block, nullptr);
+	check_budget();
 	eliminate_conditions(function, function.block, nullptr);
+	check_budget();
+	function.blockOffsetIndices.resize(function.prototype.instructions.size(), INVALID_ID);
+	nodePool->add_memory_usage(function.blockOffsetIndices.size() * sizeof(uint32_t));
 	build_if_statements(function, function.block, nullptr);
+	check_budget();
+	nodePool->remove_memory_usage(function.blockOffsetIndices.size() * sizeof(uint32_t));
+	function.blockOffsets = {};
+	function.blockOffsetIndices = {};
 	clean_up(function);
+	function.slotScopeCollector.flatten_scopes();
 	function.block.shrink_to_fit();
-	prototypeDataLeft -= function.prototype.prototypeSize;
-	print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	delete_unused_nodes(function, statementBase, expressionBase);
+}
 
-	for (uint32_t i = function.childFunctions.size(); i--;) {
-		build_functions(*function.childFunctions[i], functionCounter);
+void Ast::delete_unused_nodes(Function& function, const uint32_t& statementBase, const uint32_t& expressionBase) {
+	std::vector<Statement*> statements(function.block.begin(), function.block.end());
+	std::vector<Expression*> expressions;
+
+	for (uint32_t i = 0; i < statements.size(); i++) {
+		statements.insert(statements.end(), statements[i]->block->begin(), statements[i]->block->end());
+		if (!statements[i]->assignment.payload) continue;
+		expressions.insert(expressions.end(), statements[i]->assignment->expressions.begin(), statements[i]->assignment->expressions.end());
+		expressions.emplace_back(statements[i]->assignment->multresReturn);
+
+		for (uint32_t j = statements[i]->assignment->variables.size(); j--;) {
+			expressions.emplace_back(statements[i]->assignment->variables[j].table);
+			expressions.emplace_back(statements[i]->assignment->variables[j].tableIndex);
+		}
 	}
+
+	for (uint32_t i = 0; i < expressions.size(); i++) {
+		if (!expressions[i]) continue;
+
+		switch (expressions[i]->type) {
+		case AST_EXPRESSION_VARIABLE:
+			expressions.emplace_back(expressions[i]->variable->table);
+			expressions.emplace_back(expressions[i]->variable->tableIndex);
+			continue;
+		case AST_EXPRESSION_FUNCTION_CALL:
+			expressions.emplace_back(expressions[i]->functionCall->function);
+			expressions.insert(expressions.end(), expressions[i]->functionCall->arguments.begin(), expressions[i]->functionCall->arguments.end());
+			expressions.emplace_back(expressions[i]->functionCall->multresArgument);
+			continue;
+		case AST_EXPRESSION_TABLE:
+			expressions.insert(expressions.end(), expressions[i]->table->constants.list.begin(), expressions[i]->table->constants.list.end());
+
+			for (uint32_t j = expressions[i]->table->constants.fields.size(); j--;) {
+				expressions.emplace_back(expressions[i]->table->constants.fields[j].key);
+				expressions.emplace_back(expressions[i]->table->constants.fields[j].value);
+			}
+
+			for (uint32_t j = expressions[i]->table->fields.size(); j--;) {
+				expressions.emplace_back(expressions[i]->table->fields[j].key);
+				expressions.emplace_back(expressions[i]->table->fields[j].value);
+			}
+
+			expressions.emplace_back(expressions[i]->table->multresField);
+			continue;
+		case AST_EXPRESSION_BINARY_OPERATION:
+			expressions.emplace_back(expressions[i]->binaryOperation->leftOperand);
+			expressions.emplace_back(expressions[i]->binaryOperation->rightOperand);
+			continue;
+		case AST_EXPRESSION_UNARY_OPERATION:
+			expressions.emplace_back(expressions[i]->unaryOperation->operand);
+			continue;
+		}
+	}
+
+	std::sort(statements.begin(), statements.end());
+	std::sort(expressions.begin(), expressions.end());
+	uint32_t statementCount = statementBase;
+	uint32_t expressionCount = expressionBase;
+
+	for (uint32_t i = statementBase; i < nodePool->statements.size(); i++) {
+		if (std::binary_search(statements.begin(), statements.end(), nodePool->statements[i])) {
+			nodePool->statements[statementCount] = nodePool->statements[i];
+			statementCount++;
+			continue;
+		}
+
+		nodePool->remove_memory_usage(sizeof(Statement)
+			+ (nodePool->statements[i]->assignment.payload ? sizeof(Statement::Assignment) : 0)
+			+ (nodePool->statements[i]->block.payload ? sizeof(std::vector<Statement*>) : 0));
+		delete nodePool->statements[i];
+	}
+
+	for (uint32_t i = expressionBase; i < nodePool->expressions.size(); i++) {
+		if (std::binary_search(expressions.begin(), expressions.end(), nodePool->expressions[i])) {
+			nodePool->expressions[expressionCount] = nodePool->expressions[i];
+			expressionCount++;
+			continue;
+		}
+
+		nodePool->remove_memory_usage(sizeof(Expression) + nodePool->expressions[i]->get_payload_size());
+		delete nodePool->expressions[i];
+	}
+
+	if (budget.nodeLimit) nodeCount -= nodePool->statements.size() - statementCount + nodePool->expressions.size() - expressionCount;
+	nodePool->statements.resize(statementCount);
+	nodePool->expressions.resize(expressionCount);
 }
 
 void Ast::build_instructions(Function& function) {
 	std::vector<uint8_t> upvalues;
 	function.block.resize(function.prototype.instructions.size(), nullptr);
+	nodePool->add_memory_usage(function.block.size() * sizeof(Statement*));
 
 	for (uint32_t i = function.block.size(); i--;) {
 		function.block[i] = new_statement(AST_STATEMENT_INSTRUCTION);
@@ -129,7 +400,7 @@ void Ast::assign_debug_info(Function& function) {
 	function.parameterNames.resize(function.prototype.header.parameters);
 
 	for (uint8_t i = function.parameterNames.size(); i--;) {
-		function.parameterNames[i] = function.prototype.variableInfos[i].name;
+		function.parameterNames[i] = Symbol(function.prototype.variableInfos[i].name);
 		activeLocalScopes.emplace_back(function.prototype.variableInfos[i].scopeEnd);
 	}
 
@@ -233,7 +504,7 @@ void Ast::group_jumps(Function& function) {
 		}
 	}
 
-	function.labels.shrink_to_fit();
+	function.sort_labels();
 	uint32_t index;
 
 	for (uint32_t i = function.block.size(); i--;) {
@@ -300,9 +571,10 @@ void Ast::group_jumps(Function& function) {
 		break;
 	}
 
-	return build_loops(function);
+	return isFR2Enabled ? build_loops<true>(function) : build_loops<false>(function);
 }
 
+template <bool isFR2>
 void Ast::build_loops(Function& function) {
 	static const auto build_break_statements = [](std::vector<Statement*>& block, const uint32_t& breakTarget)->void {
 		for (uint32_t i = block.size(); i--;) {
@@ -328,24 +600,24 @@ void Ast::build_loops(Function& function) {
 			function.block[i]->instruction.label = function.block[i]->instruction.target;
 			function.block[i]->instruction.target = function.block[targetIndex + 1]->instruction.id + 1;
 			function.block[targetIndex]->type = AST_STATEMENT_EMPTY;
-			function.block[i]->block.reserve(targetIndex - i);
-			function.block[i]->block.insert(function.block[i]->block.begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex + 1);
+			reserve_block(*function.block[i], targetIndex - i);
+			function.block[i]->block.create()->insert(function.block[i]->block->begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex + 1);
 			function.block.erase(function.block.begin() + i + 1, function.block.begin() + targetIndex + 2);
 			function.slotScopeCollector.add_loop(function.block[i]->instruction.id, function.block[i]->instruction.target);
-			build_break_statements(function.block[i]->block, breakTarget);
-			build_local_scopes(function, function.block[i]->block);
+			build_break_statements(*function.block[i]->block.create(), breakTarget);
+			build_local_scopes<isFR2>(function, *function.block[i]->block.create());
 			continue;
 		case Bytecode::BC_OP_FORI:
 			function.block[i]->type = AST_STATEMENT_NUMERIC_FOR;
 			targetIndex = get_block_index_from_id(function.block, function.block[i]->instruction.target);
 			breakTarget = get_extended_id_from_statement(function.block[targetIndex]);
 			function.block[targetIndex - 1]->type = AST_STATEMENT_EMPTY;
-			function.block[i]->block.reserve(targetIndex - 1 - i);
-			function.block[i]->block.insert(function.block[i]->block.begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex);
+			reserve_block(*function.block[i], targetIndex - 1 - i);
+			function.block[i]->block.create()->insert(function.block[i]->block->begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex);
 			function.block.erase(function.block.begin() + i + 1, function.block.begin() + targetIndex);
 			function.slotScopeCollector.add_loop(function.block[i]->instruction.id, function.block[i]->instruction.target);
-			build_break_statements(function.block[i]->block, breakTarget);
-			build_local_scopes(function, function.block[i]->block);
+			build_break_statements(*function.block[i]->block.create(), breakTarget);
+			build_local_scopes<isFR2>(function, *function.block[i]->block.create());
 			continue;
 		case Bytecode::BC_OP_LOOP:
 			assert(function.block[i]->instruction.target >= function.block[i]->instruction.id, "LOOP instruction has invalid jump target", bytecode.filePath, DEBUG_INFO);
@@ -365,46 +637,47 @@ void Ast::build_loops(Function& function) {
 			function.block[i]->type = AST_STATEMENT_LOOP;
 			targetIndex = get_block_index_from_id(function.block, function.block[i]->instruction.target);
 			breakTarget = get_extended_id_from_statement(function.block[targetIndex]);
-			function.block[i]->block.reserve(targetIndex - 1 - i);
-			function.block[i]->block.insert(function.block[i]->block.begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex);
+			reserve_block(*function.block[i], targetIndex - 1 - i);
+			function.block[i]->block.create()->insert(function.block[i]->block->begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex);
 			function.block.erase(function.block.begin() + i + 1, function.block.begin() + targetIndex);
 			function.slotScopeCollector.add_loop(function.block[i]->instruction.id, function.block[i]->instruction.target);
-			build_break_statements(function.block[i]->block, breakTarget);
+			build_break_statements(*function.block[i]->block.create(), breakTarget);
 
-			if (function.block[i]->block.size()
+			if (function.block[i]->block->size()
 				//TODO
-				&& function.block[i]->block.back()->type == AST_STATEMENT_CONDITION
+				&& function.block[i]->block->back()->type == AST_STATEMENT_CONDITION
 				&& function.is_valid_label(function.block[i]->instruction.label)
 				&& breakTarget != function.block[i]->instruction.id) {
 				for (uint32_t j = function.labels[function.block[i]->instruction.label].jumpIds.size(); j--
 					&& function.labels[function.block[i]->instruction.label].jumpIds[j] > function.block[i]->instruction.id;) {
 					if (function.labels[function.block[i]->instruction.label].jumpIds[j] >= function.block[i]->instruction.target) continue;
-					targetIndex = get_block_index_from_id(function.block[i]->block, function.labels[function.block[i]->instruction.label].jumpIds[j] - 1);
-
-					if (targetIndex != INVALID_ID && function.block[i]->block[targetIndex]->type == AST_STATEMENT_CONDITION) {
-						function.block[i]->block.emplace_back(new_statement(AST_STATEMENT_BREAK));
-						function.block[i]->block.back()->instruction.type = Bytecode::BC_OP_JMP;
-						function.block[i]->block.back()->instruction.target = breakTarget;
-						function.block[i]->block.emplace_back(new_statement(AST_STATEMENT_GOTO));
-						function.block[i]->block.back()->instruction.type = Bytecode::BC_OP_JMP;
-						function.block[i]->block.back()->instruction.target = function.block[i]->instruction.id;
+					targetIndex = get_block_index_from_id(*function.block[i]->block, function.labels[function.block[i]->instruction.label].jumpIds[j] - 1);
+
+					if (targetIndex != INVALID_ID && (*function.block[i]->block)[targetIndex]->type == AST_STATEMENT_CONDITION) {
+						function.block[i]->block.create()->emplace_back(new_statement(AST_STATEMENT_BREAK));
+						function.block[i]->block->back()->instruction.type = Bytecode::BC_OP_JMP;
+						function.block[i]->block->back()->instruction.target = breakTarget;
+						function.block[i]->block.create()->emplace_back(new_statement(AST_STATEMENT_GOTO));
+						function.block[i]->block->back()->instruction.type = Bytecode::BC_OP_JMP;
+						function.block[i]->block->back()->instruction.target = function.block[i]->instruction.id;
 					}
 
 					break;
 				}
 			}
 
-			build_local_scopes(function, function.block[i]->block);
+			build_local_scopes<isFR2>(function, *function.block[i]->block.create());
 			continue;
 		}
 	}
 
 	function.slotScopeCollector.upvalueInfos.shrink_to_fit();
-	return build_local_scopes(function, function.block);
+	return build_local_scopes<isFR2>(function, function.block);
 }
 
+template <bool isFR2>
 void Ast::build_local_scopes(Function& function, std::vector<Statement*>& block) {
-	if (!function.hasDebugInfo) return build_expressions(function, block);
+	if (!function.hasDebugInfo) return build_expressions<isFR2>(function, block);
 	uint32_t scopeBeginIndex, scopeEndIndex;
 
 	for (uint32_t i = function.locals.size(); i--;) {
@@ -431,142 +704,206 @@ void Ast::build_local_scopes(Function& function, std::vector<Statement*>& block)
 				scopeEndIndex--;
 			}
 
-			block[scopeBeginIndex]->block.reserve(scopeEndIndex - 1 - scopeBeginIndex);
-			block[scopeBeginIndex]->block.insert(block[scopeBeginIndex]->block.begin(), block.begin() + scopeBeginIndex + 1, block.begin() + scopeEndIndex);
+			reserve_block(*block[scopeBeginIndex], scopeEndIndex - 1 - scopeBeginIndex);
+			block[scopeBeginIndex]->block.create()->insert(block[scopeBeginIndex]->block->begin(), block.begin() + scopeBeginIndex + 1, block.begin() + scopeEndIndex);
 			block.erase(block.begin() + scopeBeginIndex + 1, block.begin() + scopeEndIndex);
-			build_expressions(function, block[scopeBeginIndex]->block);
+			build_expressions<isFR2>(function, *block[scopeBeginIndex]->block.create());
 		}
 	}
 
-	return build_expressions(function, block);
+	return build_expressions<isFR2>(function, block);
 }
 
+template <bool isFR2>
 void Ast::build_expressions(Function& function, std::vector<Statement*>& block) {
-	for (uint32_t i = block.size(); i--;) {
-		switch (block[i]->type) {
-		case AST_STATEMENT_INSTRUCTION:
-			block[i]->type = AST_STATEMENT_ASSIGNMENT;
-			block[i]->assignment.expressions.resize(1, nullptr);
+	static constexpr std::array<Lowering, Bytecode::BC_OP_INVALID> LOWERINGS = [] {
+		std::array<Lowering, Bytecode::BC_OP_INVALID> lowerings;
 
-			switch (block[i]->instruction.type) {
+		for (uint8_t i = Bytecode::BC_OP_INVALID; i--;) {
+			lowerings[i] = Lowering{ .format = Bytecode::get_op_format((Bytecode::BC_OP)i) };
+
+			switch (i) {
+			case Bytecode::BC_OP_ISLT:
+			case Bytecode::BC_OP_ISGE:
+			case Bytecode::BC_OP_ISLE:
+			case Bytecode::BC_OP_ISGT:
+				lowerings[i].allowSlotSwap = true;
+			case Bytecode::BC_OP_ISEQV:
+			case Bytecode::BC_OP_ISNEV:
+			case Bytecode::BC_OP_ISEQS:
+			case Bytecode::BC_OP_ISNES:
+			case Bytecode::BC_OP_ISEQN:
+			case Bytecode::BC_OP_ISNEN:
+			case Bytecode::BC_OP_ISEQP:
+			case Bytecode::BC_OP_ISNEP:
+				lowerings[i].type = LOWERING_COMPARISON;
+				break;
 			case Bytecode::BC_OP_MOV:
-				block[i]->assignment.expressions.back() = new_slot(block[i]->instruction.d);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
+			case Bytecode::BC_OP_KSTR:
+			case Bytecode::BC_OP_KCDATA:
+			case Bytecode::BC_OP_KSHORT:
+			case Bytecode::BC_OP_KNUM:
+			case Bytecode::BC_OP_KPRI:
+				lowerings[i].type = LOWERING_OPERAND;
 				break;
 			case Bytecode::BC_OP_NOT:
+				lowerings[i].type = LOWERING_UNARY;
+				lowerings[i].operation = AST_UNARY_NOT;
+				lowerings[i].allowedConstantType = INVALID_CONSTANT;
+				break;
 			case Bytecode::BC_OP_UNM:
+				lowerings[i].type = LOWERING_UNARY;
+				lowerings[i].operation = AST_UNARY_MINUS;
+				lowerings[i].allowedConstantType = BOOL_CONSTANT;
+				break;
 			case Bytecode::BC_OP_LEN:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_UNARY_OPERATION);
-
-				switch (block[i]->instruction.type) {
-				case Bytecode::BC_OP_NOT:
-					block[i]->assignment.expressions.back()->unaryOperation->type = AST_UNARY_NOT;
-					block[i]->assignment.allowedConstantType = INVALID_CONSTANT;
-					break;
-				case Bytecode::BC_OP_UNM:
-					block[i]->assignment.expressions.back()->unaryOperation->type = AST_UNARY_MINUS;
-					block[i]->assignment.allowedConstantType = BOOL_CONSTANT;
-					break;
-				case Bytecode::BC_OP_LEN:
-					block[i]->assignment.expressions.back()->unaryOperation->type = AST_UNARY_LENGTH;
-					break;
-				}
-
-				block[i]->assignment.expressions.back()->unaryOperation->operand = new_slot(block[i]->instruction.d);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->unaryOperation->operand);
+				lowerings[i].type = LOWERING_UNARY;
+				lowerings[i].operation = AST_UNARY_LENGTH;
 				break;
-			case Bytecode::BC_OP_ADDVN:
-			case Bytecode::BC_OP_SUBVN:
-			case Bytecode::BC_OP_MULVN:
-			case Bytecode::BC_OP_DIVVN:
-			case Bytecode::BC_OP_MODVN:
 			case Bytecode::BC_OP_ADDNV:
 			case Bytecode::BC_OP_SUBNV:
 			case Bytecode::BC_OP_MULNV:
 			case Bytecode::BC_OP_DIVNV:
 			case Bytecode::BC_OP_MODNV:
+				lowerings[i].isSwapped = true;
+			case Bytecode::BC_OP_ADDVN:
+			case Bytecode::BC_OP_SUBVN:
+			case Bytecode::BC_OP_MULVN:
+			case Bytecode::BC_OP_DIVVN:
+			case Bytecode::BC_OP_MODVN:
 			case Bytecode::BC_OP_ADDVV:
 			case Bytecode::BC_OP_SUBVV:
 			case Bytecode::BC_OP_MULVV:
 			case Bytecode::BC_OP_DIVVV:
 			case Bytecode::BC_OP_MODVV:
 			case Bytecode::BC_OP_POW:
-				block[i]->assignment.allowedConstantType = BOOL_CONSTANT;
-			case Bytecode::BC_OP_CAT:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
+				lowerings[i].type = LOWERING_BINARY;
+				lowerings[i].allowedConstantType = BOOL_CONSTANT;
 
-				switch (block[i]->instruction.type) {
+				switch (i) {
 				case Bytecode::BC_OP_ADDVN:
 				case Bytecode::BC_OP_ADDNV:
 				case Bytecode::BC_OP_ADDVV:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_ADDITION;
+					lowerings[i].operation = AST_BINARY_ADDITION;
 					break;
 				case Bytecode::BC_OP_SUBVN:
 				case Bytecode::BC_OP_SUBNV:
 				case Bytecode::BC_OP_SUBVV:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_SUBTRACTION;
+					lowerings[i].operation = AST_BINARY_SUBTRACTION;
 					break;
 				case Bytecode::BC_OP_MULVN:
 				case Bytecode::BC_OP_MULNV:
 				case Bytecode::BC_OP_MULVV:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_MULTIPLICATION;
+					lowerings[i].operation = AST_BINARY_MULTIPLICATION;
 					break;
 				case Bytecode::BC_OP_DIVVN:
 				case Bytecode::BC_OP_DIVNV:
 				case Bytecode::BC_OP_DIVVV:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_DIVISION;
+					lowerings[i].operation = AST_BINARY_DIVISION;
 					break;
 				case Bytecode::BC_OP_MODVN:
 				case Bytecode::BC_OP_MODNV:
 				case Bytecode::BC_OP_MODVV:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_MODULO;
+					lowerings[i].operation = AST_BINARY_MODULO;
 					break;
 				case Bytecode::BC_OP_POW:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_EXPONENTATION;
-					break;
-				case Bytecode::BC_OP_CAT:
-					block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_CONCATENATION;
+					lowerings[i].operation = AST_BINARY_EXPONENTATION;
 					break;
 				}
 
+				break;
+			case Bytecode::BC_OP_USETV:
+			case Bytecode::BC_OP_USETS:
+			case Bytecode::BC_OP_USETN:
+			case Bytecode::BC_OP_USETP:
+				lowerings[i].type = LOWERING_UPVALUE_SET;
+				break;
+			case Bytecode::BC_OP_TGETV:
+			case Bytecode::BC_OP_TGETS:
+			case Bytecode::BC_OP_TGETB:
+				lowerings[i].type = LOWERING_TABLE_GET;
+				break;
+			case Bytecode::BC_OP_TSETV:
+			case Bytecode::BC_OP_TSETS:
+			case Bytecode::BC_OP_TSETB:
+				lowerings[i].type = LOWERING_TABLE_SET;
+				break;
+			}
+		}
+
+		return lowerings;
+	}();
+
+	static_assert(LOWERINGS[Bytecode::BC_OP_GSET].type == LOWERING_NONE && LOWERINGS[Bytecode::BC_OP_GSET].allowedConstantType == NUMBER_CONSTANT);
+	static_assert(LOWERINGS[Bytecode::BC_OP_KSTR].type == LOWERING_OPERAND && LOWERINGS[Bytecode::BC_OP_KSTR].allowedConstantType == NUMBER_CONSTANT);
+	static_assert(LOWERINGS[Bytecode::BC_OP_NOT].operation == AST_UNARY_NOT && LOWERINGS[Bytecode::BC_OP_NOT].allowedConstantType == INVALID_CONSTANT);
+	static_assert(LOWERINGS[Bytecode::BC_OP_SUBNV].isSwapped && LOWERINGS[Bytecode::BC_OP_SUBNV].operation == AST_BINARY_SUBTRACTION);
+	static_assert(LOWERINGS[Bytecode::BC_OP_ISLT].allowSlotSwap && !LOWERINGS[Bytecode::BC_OP_ISEQV].allowSlotSwap);
+
+	const Lowering* lowering;
+
+	for (uint32_t i = block.size(); i--;) {
+		switch (block[i]->type) {
+		case AST_STATEMENT_INSTRUCTION:
+			block[i]->type = AST_STATEMENT_ASSIGNMENT;
+			block[i]->assignment.create()->expressions.resize(1, nullptr);
+			lowering = &LOWERINGS[block[i]->instruction.type];
+			block[i]->assignment.create()->allowedConstantType = lowering->allowedConstantType;
+
+			switch (lowering->type) {
+			case LOWERING_OPERAND:
+				build_operand(function, *block[i], block[i]->assignment.create()->expressions.back(), lowering->format.d, block[i]->instruction.d);
+				break;
+			case LOWERING_UNARY:
+				block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_UNARY_OPERATION);
+				block[i]->assignment->expressions.back()->unaryOperation->type = (AST_UNARY_OPERATION)lowering->operation;
+				build_operand(function, *block[i], block[i]->assignment->expressions.back()->unaryOperation->operand, lowering->format.d, block[i]->instruction.d);
+				break;
+			case LOWERING_BINARY:
+				block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
+				block[i]->assignment->expressions.back()->binaryOperation->type = (AST_BINARY_OPERATION)lowering->operation;
+
+				if (lowering->isSwapped) {
+					build_operand(function, *block[i], block[i]->assignment->expressions.back()->binaryOperation->leftOperand, lowering->format.c, block[i]->instruction.c);
+					build_operand(function, *block[i], block[i]->assignment->expressions.back()->binaryOperation->rightOperand, lowering->format.b, block[i]->instruction.b);
+				} else {
+					build_operand(function, *block[i], block[i]->assignment->expressions.back()->binaryOperation->leftOperand, lowering->format.b, block[i]->instruction.b);
+					build_operand(function, *block[i], block[i]->assignment->expressions.back()->binaryOperation->rightOperand, lowering->format.c, block[i]->instruction.c);
+				}
+
+				break;
+			case LOWERING_TABLE_GET:
+				block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
+				block[i]->assignment->expressions.back()->variable->type = AST_VARIABLE_TABLE_INDEX;
+				build_operand(function, *block[i], block[i]->assignment->expressions.back()->variable->table, lowering->format.b, block[i]->instruction.b);
+				build_operand(function, *block[i], block[i]->assignment->expressions.back()->variable->tableIndex, lowering->format.c, block[i]->instruction.c);
+				break;
+			case LOWERING_TABLE_SET:
+				block[i]->assignment.create()->variables.resize(1);
+				block[i]->assignment.create()->variables.back().type = AST_VARIABLE_TABLE_INDEX;
+				block[i]->assignment.create()->variables.back().table = new_slot(block[i]->instruction.b);
+				build_operand(function, *block[i], block[i]->assignment.create()->variables.back().tableIndex, lowering->format.c, block[i]->instruction.c);
+				build_operand(function, *block[i], block[i]->assignment.create()->expressions.back(), lowering->format.a, block[i]->instruction.a);
+				continue;
+			case LOWERING_UPVALUE_SET:
+				block[i]->assignment.create()->variables.resize(1);
+				block[i]->assignment.create()->variables.back().type = AST_VARIABLE_UPVALUE;
+				block[i]->assignment.create()->variables.back().slotScope = function.upvalues[block[i]->instruction.a].slotScope;
+				build_operand(function, *block[i], block[i]->assignment.create()->expressions.back(), lowering->format.d, block[i]->instruction.d);
+				continue;
+			default:
 				switch (block[i]->instruction.type) {
-				case Bytecode::BC_OP_ADDVN:
-				case Bytecode::BC_OP_SUBVN:
-				case Bytecode::BC_OP_MULVN:
-				case Bytecode::BC_OP_DIVVN:
-				case Bytecode::BC_OP_MODVN:
-					block[i]->assignment.expressions.back()->binaryOperation->leftOperand = new_slot(block[i]->instruction.b);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->binaryOperation->leftOperand);
-					block[i]->assignment.expressions.back()->binaryOperation->rightOperand = new_number(function, block[i]->instruction.c);
-					break;
-				case Bytecode::BC_OP_ADDNV:
-				case Bytecode::BC_OP_SUBNV:
-				case Bytecode::BC_OP_MULNV:
-				case Bytecode::BC_OP_DIVNV:
-				case Bytecode::BC_OP_MODNV:
-					block[i]->assignment.expressions.back()->binaryOperation->leftOperand = new_number(function, block[i]->instruction.c);
-					block[i]->assignment.expressions.back()->binaryOperation->rightOperand = new_slot(block[i]->instruction.b);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->binaryOperation->rightOperand);
-					break;
-				case Bytecode::BC_OP_ADDVV:
-				case Bytecode::BC_OP_SUBVV:
-				case Bytecode::BC_OP_MULVV:
-				case Bytecode::BC_OP_DIVVV:
-				case Bytecode::BC_OP_MODVV:
-				case Bytecode::BC_OP_POW:
-					block[i]->assignment.expressions.back()->binaryOperation->leftOperand = new_slot(block[i]->instruction.b);
-					block[i]->assignment.expressions.back()->binaryOperation->rightOperand = new_slot(block[i]->instruction.c);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->binaryOperation->leftOperand, block[i]->assignment.expressions.back()->binaryOperation->rightOperand);
-					break;
 				case Bytecode::BC_OP_CAT:
-					block[i]->assignment.expressions.back()->binaryOperation->leftOperand = new_slot(block[i]->instruction.b);
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
+					block[i]->assignment->expressions.back()->binaryOperation->type = AST_BINARY_CONCATENATION;
+					block[i]->assignment->expressions.back()->binaryOperation->leftOperand = new_slot(block[i]->instruction.b);
 
-					for (Expression* expression = block[i]->assignment.expressions.back(); true; expression = expression->binaryOperation->rightOperand) {
-						block[i]->assignment.register_slots(expression->binaryOperation->leftOperand);
+					for (Expression* expression = block[i]->assignment->expressions.back(); true; expression = expression->binaryOperation->rightOperand) {
+						block[i]->assignment.create()->register_slots(expression->binaryOperation->leftOperand);
 
 						if (expression->binaryOperation->leftOperand->variable->slot == block[i]->instruction.c - 1) {
 							expression->binaryOperation->rightOperand = new_slot(block[i]->instruction.c);
-							block[i]->assignment.register_slots(expression->binaryOperation->rightOperand);
+							block[i]->assignment.create()->register_slots(expression->binaryOperation->rightOperand);
 							break;
 						}
 
@@ -576,221 +913,133 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 					}
 
 					break;
-				}
-
-				break;
-			case Bytecode::BC_OP_KSTR:
-				block[i]->assignment.expressions.back() = new_string(function, block[i]->instruction.d);
-				check_valid_name(block[i]->assignment.expressions.back()->constant);
-				break;
-			case Bytecode::BC_OP_KCDATA:
-				block[i]->assignment.expressions.back() = new_cdata(function, block[i]->instruction.d);
-				break;
-			case Bytecode::BC_OP_KSHORT:
-				block[i]->assignment.expressions.back() = new_signed_literal(block[i]->instruction.d);
-				break;
-			case Bytecode::BC_OP_KNUM:
-				block[i]->assignment.expressions.back() = new_number(function, block[i]->instruction.d);
-				break;
-			case Bytecode::BC_OP_KPRI:
-				block[i]->assignment.expressions.back() = new_primitive(block[i]->instruction.d);
-				break;
-			case Bytecode::BC_OP_KNIL:
-				block[i]->assignment.expressions.back() = new_primitive(0);
-				if (block[i]->instruction.a == block[i]->instruction.d) break;
-				block.emplace(block.begin() + i, new_statement(AST_STATEMENT_INSTRUCTION));
-				block[i]->instruction = block[i + 1]->instruction;
-				block[i]->instruction.d--;
-				i++;
-				block[i]->instruction.a = block[i]->instruction.d;
-				block[i]->instruction.id = INVALID_ID;
-				block[i]->instruction.label = INVALID_ID;
-				break;
-			case Bytecode::BC_OP_UGET:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
-				block[i]->assignment.expressions.back()->variable->type = AST_VARIABLE_UPVALUE;
-				block[i]->assignment.expressions.back()->variable->slotScope = function.upvalues[block[i]->instruction.d].slotScope;
-				break;
-			case Bytecode::BC_OP_USETV:
-			case Bytecode::BC_OP_USETS:
-			case Bytecode::BC_OP_USETN:
-			case Bytecode::BC_OP_USETP:
-				block[i]->assignment.variables.resize(1);
-				block[i]->assignment.variables.back().type = AST_VARIABLE_UPVALUE;
-				block[i]->assignment.variables.back().slotScope = function.upvalues[block[i]->instruction.a].slotScope;
-
-				switch (block[i]->instruction.type) {
-				case Bytecode::BC_OP_USETV:
-					block[i]->assignment.expressions.back() = new_slot(block[i]->instruction.d);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
-					break;
-				case Bytecode::BC_OP_USETS:
-					block[i]->assignment.expressions.back() = new_string(function, block[i]->instruction.d);
+				case Bytecode::BC_OP_KNIL:
+					block[i]->assignment.create()->expressions.back() = new_primitive(0);
+					if (block[i]->instruction.a == block[i]->instruction.d) break;
+					block.emplace(block.begin() + i, new_statement(AST_STATEMENT_INSTRUCTION));
+					block[i]->instruction = block[i + 1]->instruction;
+					block[i]->instruction.d--;
+					i++;
+					block[i]->instruction.a = block[i]->instruction.d;
+					block[i]->instruction.id = INVALID_ID;
+					block[i]->instruction.label = INVALID_ID;
 					break;
-				case Bytecode::BC_OP_USETN:
-					block[i]->assignment.expressions.back() = new_number(function, block[i]->instruction.d);
+				case Bytecode::BC_OP_UGET:
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
+					block[i]->assignment->expressions.back()->variable->type = AST_VARIABLE_UPVALUE;
+					block[i]->assignment->expressions.back()->variable->slotScope = function.upvalues[block[i]->instruction.d].slotScope;
 					break;
-				case Bytecode::BC_OP_USETP:
-					block[i]->assignment.expressions.back() = new_primitive(block[i]->instruction.d);
+				case Bytecode::BC_OP_FNEW:
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_FUNCTION);
+					block[i]->assignment->expressions.back()->function = block[i]->function;
 					break;
-				}
-
-				continue;
-			case Bytecode::BC_OP_FNEW:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_FUNCTION);
-				block[i]->assignment.expressions.back()->function = block[i]->function;
-				break;
-			case Bytecode::BC_OP_TNEW:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_TABLE);
-				block[i]->assignment.isTableConstructor = true;
-				break;
-			case Bytecode::BC_OP_TDUP:
-				block[i]->assignment.expressions.back() = new_table(function, block[i]->instruction.d);
-				block[i]->assignment.isTableConstructor = true;
-				break;
-			case Bytecode::BC_OP_GGET:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
-				block[i]->assignment.expressions.back()->variable->type = AST_VARIABLE_GLOBAL;
-				block[i]->assignment.expressions.back()->variable->name = function.get_constant(block[i]->instruction.d).string;
-				if (function.hasDebugInfo) function.usedGlobals.emplace_back(&function.get_constant(block[i]->instruction.d).string);
-				break;
-			case Bytecode::BC_OP_GSET:
-				block[i]->assignment.variables.resize(1);
-				block[i]->assignment.variables.back().type = AST_VARIABLE_GLOBAL;
-				block[i]->assignment.variables.back().name = function.get_constant(block[i]->instruction.d).string;
-				if (function.hasDebugInfo) function.usedGlobals.emplace_back(&function.get_constant(block[i]->instruction.d).string);
-				block[i]->assignment.expressions.back() = new_slot(block[i]->instruction.a);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
-				continue;
-			case Bytecode::BC_OP_TGETV:
-			case Bytecode::BC_OP_TGETS:
-			case Bytecode::BC_OP_TGETB:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
-				block[i]->assignment.expressions.back()->variable->type = AST_VARIABLE_TABLE_INDEX;
-				block[i]->assignment.expressions.back()->variable->table = new_slot(block[i]->instruction.b);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->variable->table);
-
-				switch (block[i]->instruction.type) {
-				case Bytecode::BC_OP_TGETV:
-					block[i]->assignment.expressions.back()->variable->tableIndex = new_slot(block[i]->instruction.c);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->variable->tableIndex);
+				case Bytecode::BC_OP_TNEW:
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_TABLE);
+					block[i]->assignment.create()->isTableConstructor = true;
 					break;
-				case Bytecode::BC_OP_TGETS:
-					block[i]->assignment.expressions.back()->variable->tableIndex = new_string(function, block[i]->instruction.c);
-					check_valid_name(block[i]->assignment.expressions.back()->variable->tableIndex->constant);
+				case Bytecode::BC_OP_TDUP:
+					block[i]->assignment.create()->expressions.back() = new_table(function, block[i]->instruction.d);
+					block[i]->assignment.create()->isTableConstructor = true;
 					break;
-				case Bytecode::BC_OP_TGETB:
-					block[i]->assignment.expressions.back()->variable->tableIndex = new_literal(block[i]->instruction.c);
+				case Bytecode::BC_OP_GGET:
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
+					block[i]->assignment->expressions.back()->variable->type = AST_VARIABLE_GLOBAL;
+					block[i]->assignment->expressions.back()->variable->name = function.get_string_constant(block[i]->instruction.d);
+					if (function.hasDebugInfo) function.usedGlobals.emplace_back(function.get_string_constant(block[i]->instruction.d));
 					break;
-				}
-
-				break;
-			case Bytecode::BC_OP_TSETV:
-			case Bytecode::BC_OP_TSETS:
-			case Bytecode::BC_OP_TSETB:
-				block[i]->assignment.variables.resize(1);
-				block[i]->assignment.variables.back().type = AST_VARIABLE_TABLE_INDEX;
-				block[i]->assignment.variables.back().table = new_slot(block[i]->instruction.b);
+				case Bytecode::BC_OP_GSET:
+					block[i]->assignment.create()->variables.resize(1);
+					block[i]->assignment.create()->variables.back().type = AST_VARIABLE_GLOBAL;
+					block[i]->assignment.create()->variables.back().name = function.get_string_constant(block[i]->instruction.d);
+					if (function.hasDebugInfo) function.usedGlobals.emplace_back(function.get_string_constant(block[i]->instruction.d));
+					block[i]->assignment.create()->expressions.back() = new_slot(block[i]->instruction.a);
+					block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions.back());
+					continue;
+				case Bytecode::BC_OP_TSETM:
+					block[i]->assignment.create()->variables.resize(1);
+					block[i]->assignment.create()->variables.back().type = AST_VARIABLE_TABLE_INDEX;
+					block[i]->assignment.create()->variables.back().isMultres = true;
+					block[i]->assignment.create()->variables.back().table = new_slot(block[i]->instruction.a - 1);
+					assert(function.get_number_constant(block[i]->instruction.d).type == Bytecode::BC_KNUM_NUM && (uint32_t)function.get_number_constant(block[i]->instruction.d).number,
+						"Multres table index is not a valid number constant", bytecode.filePath, DEBUG_INFO);
+					block[i]->assignment.create()->variables.back().multresIndex = function.get_number_constant(block[i]->instruction.d).number;
+					block[i]->assignment.create()->expressions.back() = new_slot(block[i]->instruction.a);
+					block[i]->assignment->expressions.back()->variable->isMultres = true;
+					block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions.back());
+					continue;
+				case Bytecode::BC_OP_CALLM:
+				case Bytecode::BC_OP_CALL:
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_FUNCTION_CALL);
 
-				switch (block[i]->instruction.type) {
-				case Bytecode::BC_OP_TSETV:
-					block[i]->assignment.variables.back().tableIndex = new_slot(block[i]->instruction.c);
-					block[i]->assignment.register_slots(block[i]->assignment.variables.back().tableIndex);
-					break;
-				case Bytecode::BC_OP_TSETS:
-					block[i]->assignment.variables.back().tableIndex = new_string(function, block[i]->instruction.c);
-					check_valid_name(block[i]->assignment.variables.back().tableIndex->constant);
-					break;
-				case Bytecode::BC_OP_TSETB:
-					block[i]->assignment.variables.back().tableIndex = new_literal(block[i]->instruction.c);
-					break;
-				}
+					if (block[i]->instruction.b) {
+						if (block[i]->instruction.b == 1) {
+							block[i]->type = AST_STATEMENT_FUNCTION_CALL;
+						} else {
+							block[i]->assignment.create()->variables.resize(block[i]->instruction.b - 1);
 
-				block[i]->assignment.expressions.back() = new_slot(block[i]->instruction.a);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
-				continue;
-			case Bytecode::BC_OP_TSETM:
-				block[i]->assignment.variables.resize(1);
-				block[i]->assignment.variables.back().type = AST_VARIABLE_TABLE_INDEX;
-				block[i]->assignment.variables.back().isMultres = true;
-				block[i]->assignment.variables.back().table = new_slot(block[i]->instruction.a - 1);
-				assert(function.get_number_constant(block[i]->instruction.d).type == Bytecode::BC_KNUM_NUM && (uint32_t)function.get_number_constant(block[i]->instruction.d).number,
-					"Multres table index is not a valid number constant", bytecode.filePath, DEBUG_INFO);
-				block[i]->assignment.variables.back().multresIndex = function.get_number_constant(block[i]->instruction.d).number;
-				block[i]->assignment.expressions.back() = new_slot(block[i]->instruction.a);
-				block[i]->assignment.expressions.back()->variable->isMultres = true;
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
-				continue;
-			case Bytecode::BC_OP_CALLM:
-			case Bytecode::BC_OP_CALL:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_FUNCTION_CALL);
+							for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+								block[i]->assignment.create()->variables[j].type = AST_VARIABLE_SLOT;
+								block[i]->assignment.create()->variables[j].slot = block[i]->instruction.a + j;
+							}
 
-				if (block[i]->instruction.b) {
-					if (block[i]->instruction.b == 1) {
-						block[i]->type = AST_STATEMENT_FUNCTION_CALL;
+							block[i]->assignment->expressions.back()->functionCall->returnCount = block[i]->assignment->variables.size();
+						}
 					} else {
-						block[i]->assignment.variables.resize(block[i]->instruction.b - 1);
+						block[i]->assignment.create()->variables.resize(1);
+						block[i]->assignment.create()->variables.back().type = AST_VARIABLE_SLOT;
+						block[i]->assignment.create()->variables.back().slot = block[i]->instruction.a;
+						block[i]->assignment.create()->variables.back().isMultres = true;
+					}
 
-						for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-							block[i]->assignment.variables[j].type = AST_VARIABLE_SLOT;
-							block[i]->assignment.variables[j].slot = block[i]->instruction.a + j;
-						}
+					block[i]->assignment->expressions.back()->functionCall->function = new_slot(block[i]->instruction.a);
+					block[i]->assignment.create()->register_slots(block[i]->assignment->expressions.back()->functionCall->function);
+					block[i]->assignment->expressions.back()->functionCall->arguments.resize(block[i]->instruction.c + (block[i]->instruction.type == Bytecode::BC_OP_CALLM ? 0 : -1), nullptr);
+					if (block[i]->assignment->expressions.back()->functionCall->arguments.size()) block[i]->assignment.create()->isPotentialMethod = true;
 
-						block[i]->assignment.expressions.back()->functionCall->returnCount = block[i]->assignment.variables.size();
+					for (uint8_t j = 0; j < block[i]->assignment->expressions.back()->functionCall->arguments.size(); j++) {
+						block[i]->assignment->expressions.back()->functionCall->arguments[j] = new_slot(block[i]->instruction.a + (isFR2 ? 2 : 1) + j);
+						block[i]->assignment.create()->register_slots(block[i]->assignment->expressions.back()->functionCall->arguments[j]);
 					}
-				} else {
-					block[i]->assignment.variables.resize(1);
-					block[i]->assignment.variables.back().type = AST_VARIABLE_SLOT;
-					block[i]->assignment.variables.back().slot = block[i]->instruction.a;
-					block[i]->assignment.variables.back().isMultres = true;
-				}
 
-				block[i]->assignment.expressions.back()->functionCall->function = new_slot(block[i]->instruction.a);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->functionCall->function);
-				block[i]->assignment.expressions.back()->functionCall->arguments.resize(block[i]->instruction.c + (block[i]->instruction.type == Bytecode::BC_OP_CALLM ? 0 : -1), nullptr);
-				if (block[i]->assignment.expressions.back()->functionCall->arguments.size()) block[i]->assignment.isPotentialMethod = true;
-
-				for (uint8_t j = 0; j < block[i]->assignment.expressions.back()->functionCall->arguments.size(); j++) {
-					block[i]->assignment.expressions.back()->functionCall->arguments[j] = new_slot(block[i]->instruction.a + (isFR2Enabled ? 2 : 1) + j);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->functionCall->arguments[j]);
-				}
+					if (block[i]->instruction.type == Bytecode::BC_OP_CALLM) {
+						block[i]->assignment->expressions.back()->functionCall->multresArgument = new_slot(block[i]->instruction.a + (isFR2 ? 2 : 1) + block[i]->instruction.c);
+						block[i]->assignment->expressions.back()->functionCall->multresArgument->variable->isMultres = true;
+						block[i]->assignment.create()->register_slots(block[i]->assignment->expressions.back()->functionCall->multresArgument);
+					}
 
-				if (block[i]->instruction.type == Bytecode::BC_OP_CALLM) {
-					block[i]->assignment.expressions.back()->functionCall->multresArgument = new_slot(block[i]->instruction.a + (isFR2Enabled ? 2 : 1) + block[i]->instruction.c);
-					block[i]->assignment.expressions.back()->functionCall->multresArgument->variable->isMultres = true;
-					block[i]->assignment.register_slots(block[i]->assignment.expressions.back()->functionCall->multresArgument);
-				}
+					continue;
+				case Bytecode::BC_OP_VARG:
+					block[i]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_VARARG);
 
-				continue;
-			case Bytecode::BC_OP_VARG:
-				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_VARARG);
+					if (block[i]->instruction.b) {
+						if (block[i]->instruction.b == 1) {
+							block[i]->type = AST_STATEMENT_FUNCTION_CALL;
+						} else {
+							block[i]->assignment.create()->variables.resize(block[i]->instruction.b - 1);
 
-				if (block[i]->instruction.b) {
-					if (block[i]->instruction.b == 1) {
-						block[i]->type = AST_STATEMENT_FUNCTION_CALL;
-					} else {
-						block[i]->assignment.variables.resize(block[i]->instruction.b - 1);
+							for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+								block[i]->assignment.create()->variables[j].type = AST_VARIABLE_SLOT;
+								block[i]->assignment.create()->variables[j].slot = block[i]->instruction.a + j;
+							}
 
-						for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-							block[i]->assignment.variables[j].type = AST_VARIABLE_SLOT;
-							block[i]->assignment.variables[j].slot = block[i]->instruction.a + j;
+							block[i]->assignment->expressions.back()->returnCount = block[i]->assignment->variables.size();
 						}
-
-						block[i]->assignment.expressions.back()->returnCount = block[i]->assignment.variables.size();
+					} else {
+						block[i]->assignment.create()->variables.resize(1);
+						block[i]->assignment.create()->variables.back().type = AST_VARIABLE_SLOT;
+						block[i]->assignment.create()->variables.back().slot = block[i]->instruction.a;
+						block[i]->assignment.create()->variables.back().isMultres = true;
 					}
-				} else {
-					block[i]->assignment.variables.resize(1);
-					block[i]->assignment.variables.back().type = AST_VARIABLE_SLOT;
-					block[i]->assignment.variables.back().slot = block[i]->instruction.a;
-					block[i]->assignment.variables.back().isMultres = true;
+
+					continue;
 				}
 
-				continue;
+				break;
 			}
 
-			block[i]->assignment.variables.resize(1);
-			block[i]->assignment.variables.back().type = AST_VARIABLE_SLOT;
-			block[i]->assignment.variables.back().slot = block[i]->instruction.a;
+			block[i]->assignment.create()->variables.resize(1);
+			block[i]->assignment.create()->variables.back().type = AST_VARIABLE_SLOT;
+			block[i]->assignment.create()->variables.back().slot = block[i]->instruction.a;
 			continue;
 		case AST_STATEMENT_RETURN:
 			if (i
@@ -806,38 +1055,38 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 			switch (block[i]->instruction.type) {
 			case Bytecode::BC_OP_CALLMT:
 			case Bytecode::BC_OP_CALLT:
-				block[i]->assignment.multresReturn = new_expression(AST_EXPRESSION_FUNCTION_CALL);
-				block[i]->assignment.multresReturn->functionCall->function = new_slot(block[i]->instruction.a);
-				block[i]->assignment.register_slots(block[i]->assignment.multresReturn->functionCall->function);
-				block[i]->assignment.multresReturn->functionCall->arguments.resize(block[i]->instruction.d + (block[i]->instruction.type == Bytecode::BC_OP_CALLMT ? 0 : -1), nullptr);
-				if (block[i]->assignment.multresReturn->functionCall->arguments.size()) block[i]->assignment.isPotentialMethod = true;
-
-				for (uint8_t j = 0; j < block[i]->assignment.multresReturn->functionCall->arguments.size(); j++) {
-					block[i]->assignment.multresReturn->functionCall->arguments[j] = new_slot(block[i]->instruction.a + (isFR2Enabled ? 2 : 1) + j);
-					block[i]->assignment.register_slots(block[i]->assignment.multresReturn->functionCall->arguments[j]);
+				block[i]->assignment.create()->multresReturn = new_expression(AST_EXPRESSION_FUNCTION_CALL);
+				block[i]->assignment->multresReturn->functionCall->function = new_slot(block[i]->instruction.a);
+				block[i]->assignment.create()->register_slots(block[i]->assignment->multresReturn->functionCall->function);
+				block[i]->assignment->multresReturn->functionCall->arguments.resize(block[i]->instruction.d + (block[i]->instruction.type == Bytecode::BC_OP_CALLMT ? 0 : -1), nullptr);
+				if (block[i]->assignment->multresReturn->functionCall->arguments.size()) block[i]->assignment.create()->isPotentialMethod = true;
+
+				for (uint8_t j = 0; j < block[i]->assignment->multresReturn->functionCall->arguments.size(); j++) {
+					block[i]->assignment->multresReturn->functionCall->arguments[j] = new_slot(block[i]->instruction.a + (isFR2 ? 2 : 1) + j);
+					block[i]->assignment.create()->register_slots(block[i]->assignment->multresReturn->functionCall->arguments[j]);
 				}
 
 				if (block[i]->instruction.type == Bytecode::BC_OP_CALLMT) {
-					block[i]->assignment.multresReturn->functionCall->multresArgument = new_slot(block[i]->instruction.a + (isFR2Enabled ? 2 : 1) + block[i]->instruction.d);
-					block[i]->assignment.multresReturn->functionCall->multresArgument->variable->isMultres = true;
-					block[i]->assignment.register_slots(block[i]->assignment.multresReturn->functionCall->multresArgument);
+					block[i]->assignment->multresReturn->functionCall->multresArgument = new_slot(block[i]->instruction.a + (isFR2 ? 2 : 1) + block[i]->instruction.d);
+					block[i]->assignment->multresReturn->functionCall->multresArgument->variable->isMultres = true;
+					block[i]->assignment.create()->register_slots(block[i]->assignment->multresReturn->functionCall->multresArgument);
 				}
 
 				break;
 			case Bytecode::BC_OP_RETM:
 			case Bytecode::BC_OP_RET:
 			case Bytecode::BC_OP_RET1:
-				block[i]->assignment.expressions.resize(block[i]->instruction.d + (block[i]->instruction.type == Bytecode::BC_OP_RETM ? 0 : -1), nullptr);
+				block[i]->assignment.create()->expressions.resize(block[i]->instruction.d + (block[i]->instruction.type == Bytecode::BC_OP_RETM ? 0 : -1), nullptr);
 
-				for (uint8_t j = 0; j < block[i]->assignment.expressions.size(); j++) {
-					block[i]->assignment.expressions[j] = new_slot(block[i]->instruction.a + j);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions[j]);
+				for (uint8_t j = 0; j < block[i]->assignment->expressions.size(); j++) {
+					block[i]->assignment.create()->expressions[j] = new_slot(block[i]->instruction.a + j);
+					block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions[j]);
 				}
 
 				if (block[i]->instruction.type == Bytecode::BC_OP_RETM) {
-					block[i]->assignment.multresReturn = new_slot(block[i]->instruction.a + block[i]->instruction.d);
-					block[i]->assignment.multresReturn->variable->isMultres = true;
-					block[i]->assignment.register_slots(block[i]->assignment.multresReturn);
+					block[i]->assignment.create()->multresReturn = new_slot(block[i]->instruction.a + block[i]->instruction.d);
+					block[i]->assignment->multresReturn->variable->isMultres = true;
+					block[i]->assignment.create()->register_slots(block[i]->assignment.create()->multresReturn);
 				}
 
 				break;
@@ -845,106 +1094,74 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 
 			continue;
 		case AST_STATEMENT_CONDITION:
-			switch (block[i]->instruction.type) {
-			case Bytecode::BC_OP_ISLT:
-			case Bytecode::BC_OP_ISGE:
-			case Bytecode::BC_OP_ISLE:
-			case Bytecode::BC_OP_ISGT:
-			case Bytecode::BC_OP_ISEQV:
-			case Bytecode::BC_OP_ISNEV:
-			case Bytecode::BC_OP_ISEQS:
-			case Bytecode::BC_OP_ISNES:
-			case Bytecode::BC_OP_ISEQN:
-			case Bytecode::BC_OP_ISNEN:
-			case Bytecode::BC_OP_ISEQP:
-			case Bytecode::BC_OP_ISNEP:
-				block[i]->assignment.expressions.resize(2, nullptr);
-				block[i]->assignment.expressions[0] = new_slot(block[i]->instruction.a);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions[0]);
+			lowering = &LOWERINGS[block[i]->instruction.type];
 
-				switch (block[i]->instruction.type) {
-				case Bytecode::BC_OP_ISLT:
-				case Bytecode::BC_OP_ISGE:
-				case Bytecode::BC_OP_ISLE:
-				case Bytecode::BC_OP_ISGT:
-					block[i]->condition.allowSlotSwap = true;
-				case Bytecode::BC_OP_ISEQV:
-				case Bytecode::BC_OP_ISNEV:
-					block[i]->assignment.expressions[1] = new_slot(block[i]->instruction.d);
-					block[i]->assignment.register_slots(block[i]->assignment.expressions[1]);
-					break;
-				case Bytecode::BC_OP_ISEQS:
-				case Bytecode::BC_OP_ISNES:
-					block[i]->assignment.expressions[1] = new_string(function, block[i]->instruction.d);
-					break;
-				case Bytecode::BC_OP_ISEQN:
-				case Bytecode::BC_OP_ISNEN:
-					block[i]->assignment.expressions[1] = new_number(function, block[i]->instruction.d);
-					break;
-				case Bytecode::BC_OP_ISEQP:
-				case Bytecode::BC_OP_ISNEP:
-					block[i]->assignment.expressions[1] = new_primitive(block[i]->instruction.d);
-					break;
-				}
+			if (lowering->type == LOWERING_COMPARISON) {
+				block[i]->assignment.create()->expressions.resize(2, nullptr);
+				block[i]->assignment.create()->condition.allowSlotSwap = lowering->allowSlotSwap;
+				build_operand(function, *block[i], block[i]->assignment.create()->expressions[0], lowering->format.a, block[i]->instruction.a);
+				build_operand(function, *block[i], block[i]->assignment.create()->expressions[1], lowering->format.d, block[i]->instruction.d);
+				continue;
+			}
 
-				break;
+			switch (block[i]->instruction.type) {
 			case Bytecode::BC_OP_ISTC:
 			case Bytecode::BC_OP_ISFC:
-				block[i]->assignment.variables.resize(1);
-				block[i]->assignment.variables.back().type = AST_VARIABLE_SLOT;
-				block[i]->assignment.variables.back().slot = block[i]->instruction.a;
+				block[i]->assignment.create()->variables.resize(1);
+				block[i]->assignment.create()->variables.back().type = AST_VARIABLE_SLOT;
+				block[i]->assignment.create()->variables.back().slot = block[i]->instruction.a;
 			case Bytecode::BC_OP_IST:
 			case Bytecode::BC_OP_ISF:
-				block[i]->assignment.expressions.resize(1, new_slot(block[i]->instruction.d));
-				block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
-				block[i]->assignment.allowedConstantType = INVALID_CONSTANT;
+				block[i]->assignment.create()->expressions.resize(1, new_slot(block[i]->instruction.d));
+				block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions.back());
+				block[i]->assignment.create()->allowedConstantType = INVALID_CONSTANT;
 				break;
 			}
 
 			continue;
 		case AST_STATEMENT_NUMERIC_FOR:
-			block[i]->assignment.variables.resize(1);
-			block[i]->assignment.variables.back().type = AST_VARIABLE_SLOT;
-			block[i]->assignment.variables.back().slot = block[i]->instruction.a + 3;
+			block[i]->assignment.create()->variables.resize(1);
+			block[i]->assignment.create()->variables.back().type = AST_VARIABLE_SLOT;
+			block[i]->assignment.create()->variables.back().slot = block[i]->instruction.a + 3;
 			assert(!function.hasDebugInfo
 				|| (block[i]->locals
-					&& block[i]->assignment.variables.back().slot == block[i]->locals->baseSlot
+					&& block[i]->assignment->variables.back().slot == block[i]->locals->baseSlot
 					&& block[i]->locals->names.size() == 1),
 				"Numeric for loop variable does not match with debug info", bytecode.filePath, DEBUG_INFO);
-			block[i]->assignment.expressions.resize(3, nullptr);
-			block[i]->assignment.expressions[0] = new_slot(block[i]->instruction.a);
-			block[i]->assignment.expressions[1] = new_slot(block[i]->instruction.a + 1);
-			block[i]->assignment.expressions[2] = new_slot(block[i]->instruction.a + 2);
-			block[i]->assignment.register_slots(block[i]->assignment.expressions[0], block[i]->assignment.expressions[1], block[i]->assignment.expressions[2]);
+			block[i]->assignment.create()->expressions.resize(3, nullptr);
+			block[i]->assignment.create()->expressions[0] = new_slot(block[i]->instruction.a);
+			block[i]->assignment.create()->expressions[1] = new_slot(block[i]->instruction.a + 1);
+			block[i]->assignment.create()->expressions[2] = new_slot(block[i]->instruction.a + 2);
+			block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions[0], block[i]->assignment.create()->expressions[1], block[i]->assignment.create()->expressions[2]);
 			continue;
 		case AST_STATEMENT_GENERIC_FOR:
-			block[i]->assignment.variables.resize(block[i]->instruction.b - 1);
+			block[i]->assignment.create()->variables.resize(block[i]->instruction.b - 1);
 
-			for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-				block[i]->assignment.variables[j].type = AST_VARIABLE_SLOT;
-				block[i]->assignment.variables[j].slot = block[i]->instruction.a + j;
+			for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+				block[i]->assignment.create()->variables[j].type = AST_VARIABLE_SLOT;
+				block[i]->assignment.create()->variables[j].slot = block[i]->instruction.a + j;
 			}
 
 			assert(!function.hasDebugInfo
 				|| (block[i]->locals
-					&& block[i]->assignment.variables.front().slot == block[i]->locals->baseSlot
-					&& block[i]->locals->names.size() == block[i]->assignment.variables.size()),
+					&& block[i]->assignment->variables.front().slot == block[i]->locals->baseSlot
+					&& block[i]->locals->names.size() == block[i]->assignment->variables.size()),
 				"Generic for loop variables do not match with debug info", bytecode.filePath, DEBUG_INFO);
-			block[i]->assignment.expressions.resize(3, nullptr);
-			block[i]->assignment.expressions[0] = new_slot(block[i]->instruction.a - 3);
-			block[i]->assignment.expressions[1] = new_slot(block[i]->instruction.a - 2);
-			block[i]->assignment.expressions[2] = new_slot(block[i]->instruction.a - 1);
-			block[i]->assignment.register_slots(block[i]->assignment.expressions[0], block[i]->assignment.expressions[1], block[i]->assignment.expressions[2]);
+			block[i]->assignment.create()->expressions.resize(3, nullptr);
+			block[i]->assignment.create()->expressions[0] = new_slot(block[i]->instruction.a - 3);
+			block[i]->assignment.create()->expressions[1] = new_slot(block[i]->instruction.a - 2);
+			block[i]->assignment.create()->expressions[2] = new_slot(block[i]->instruction.a - 1);
+			block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions[0], block[i]->assignment.create()->expressions[1], block[i]->assignment.create()->expressions[2]);
 			continue;
 		case AST_STATEMENT_DECLARATION:
-			block[i]->assignment.variables.resize(block[i]->locals->names.size());
-			block[i]->assignment.expressions.resize(block[i]->assignment.variables.size(), nullptr);
+			block[i]->assignment.create()->variables.resize(block[i]->locals->names.size());
+			block[i]->assignment.create()->expressions.resize(block[i]->assignment->variables.size(), nullptr);
 
-			for (uint8_t j = 0; j < block[i]->assignment.variables.size(); j++) {
-				block[i]->assignment.variables[j].type = AST_VARIABLE_SLOT;
-				block[i]->assignment.variables[j].slot = block[i]->locals->baseSlot + j;
-				block[i]->assignment.expressions[j] = new_slot(block[i]->assignment.variables[j].slot);
-				block[i]->assignment.register_slots(block[i]->assignment.expressions[j]);
+			for (uint8_t j = 0; j < block[i]->assignment->variables.size(); j++) {
+				block[i]->assignment.create()->variables[j].type = AST_VARIABLE_SLOT;
+				block[i]->assignment.create()->variables[j].slot = block[i]->locals->baseSlot + j;
+				block[i]->assignment.create()->expressions[j] = new_slot(block[i]->assignment->variables[j].slot);
+				block[i]->assignment.create()->register_slots(block[i]->assignment.create()->expressions[j]);
 			}
 
 			continue;
@@ -955,33 +1172,34 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock) {
 	const auto build_nil_assignment = [this](const uint8_t& slot)->Statement* const {
 		Statement* const statement = new_statement(AST_STATEMENT_ASSIGNMENT);
-		statement->assignment.expressions.resize(1, new_primitive(0));
-		statement->assignment.variables.resize(1);
-		statement->assignment.variables.back().type = AST_VARIABLE_SLOT;
-		statement->assignment.variables.back().slot = slot;
+		statement->assignment.create()->expressions.resize(1, new_primitive(0));
+		statement->assignment.create()->variables.resize(1);
+		statement->assignment.create()->variables.back().type = AST_VARIABLE_SLOT;
+		statement->assignment.create()->variables.back().slot = slot;
 		return statement;
 	};
 
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 	uint32_t id, index, targetLabel, extendedTargetLabel;
 	uint8_t targetSlot;
-	SlotScope** targetSlotScope;
+	SlotScope* targetSlotScope;
 	bool isPossibleCondition;
 	bool hasBoolConstruct;
 	std::vector<std::vector<Statement*>> conditionBlocks;
 
 	for (uint32_t i = block.size(); i--;) {
+		check_budget();
 		switch (block[i]->type) {
 		case AST_STATEMENT_NUMERIC_FOR:
 		case AST_STATEMENT_GENERIC_FOR:
-			for (uint32_t j = block[i]->assignment.variables.size(); j--;) {
-				assert(!function.slotScopeCollector.slotInfos[block[i]->assignment.variables[j].slot].activeSlotScope, "Slot scope does not match with for loop variable", bytecode.filePath, DEBUG_INFO);
-				function.slotScopeCollector.begin_scope(block[i]->assignment.variables[j].slot, block[i]->instruction.target - 1);
+			for (uint32_t j = block[i]->assignment->variables.size(); j--;) {
+				assert(!function.slotScopeCollector.slotInfos[block[i]->assignment->variables[j].slot].activeSlotScope, "Slot scope does not match with for loop variable", bytecode.filePath, DEBUG_INFO);
+				function.slotScopeCollector.begin_scope(block[i]->assignment->variables[j].slot, block[i]->instruction.target - 1);
 			}
 		case AST_STATEMENT_LOOP:
 			function.slotScopeCollector.extend_scopes(block[i]->instruction.id);
 			blockInfo.index = i;
-			build_slot_scopes(function, block[i]->block, block[i]->type == AST_STATEMENT_LOOP ? &blockInfo : nullptr);
+			build_slot_scopes(function, *block[i]->block.create(), block[i]->type == AST_STATEMENT_LOOP ? &blockInfo : nullptr);
 			function.slotScopeCollector.merge_scopes(block[i]->instruction.target - 1);
 			break;
 		case AST_STATEMENT_DECLARATION:
@@ -994,30 +1212,30 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 					assert(function.slotScopeCollector.slotInfos[k].activeSlotScope && function.slotScopeCollector.slotInfos[k].minScopeBegin == INVALID_ID,
 						"Slot scope does not match with variable debug info", bytecode.filePath, DEBUG_INFO);
 					block.emplace(block.begin() + i + 1, build_nil_assignment(k));
-					function.slotScopeCollector.close_scope(k, block[i + 1]->assignment.variables.back().slotScope, block[i]->locals->scopeEnd);
+					function.slotScopeCollector.close_scope(k, block[i + 1]->assignment.create()->variables.back().slotScope, block[i]->locals->scopeEnd);
 					if (k == block[i]->locals->baseSlot) break;
 				}
 
 				break;
 			}
 
-			for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-				function.slotScopeCollector.begin_scope(block[i]->assignment.variables[j].slot, block[i]->locals->scopeEnd);
+			for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+				function.slotScopeCollector.begin_scope(block[i]->assignment->variables[j].slot, block[i]->locals->scopeEnd);
 			}
 
 			function.slotScopeCollector.extend_scopes(block[i]->locals->scopeBegin);
 			blockInfo.index = i;
-			build_slot_scopes(function, block[i]->block, &blockInfo);
+			build_slot_scopes(function, *block[i]->block.create(), &blockInfo);
 
-			for (uint8_t j = function.slotScopeCollector.slotInfos.size(); j-- && j >= block[i]->assignment.variables.back().slot + 1;) {
+			for (uint8_t j = function.slotScopeCollector.slotInfos.size(); j-- && j >= block[i]->assignment->variables.back().slot + 1;) {
 				if (!function.slotScopeCollector.slotInfos[j].activeSlotScope) continue;
 
 				for (uint8_t k = j; true; k--) {
 					assert(function.slotScopeCollector.slotInfos[k].activeSlotScope && function.slotScopeCollector.slotInfos[k].minScopeBegin == INVALID_ID,
 						"Slot scope does not match with variable debug info", bytecode.filePath, DEBUG_INFO);
-					block[i]->block.emplace(block[i]->block.begin(), build_nil_assignment(k));
-					function.slotScopeCollector.close_scope(k, block[i]->block.front()->assignment.variables.back().slotScope, block[i]->locals->scopeBegin);
-					if (k == block[i]->assignment.variables.back().slot + 1) break;
+					block[i]->block.create()->emplace(block[i]->block->begin(), build_nil_assignment(k));
+					function.slotScopeCollector.close_scope(k, block[i]->block->front()->assignment.create()->variables.back().slotScope, block[i]->locals->scopeBegin);
+					if (k == block[i]->assignment->variables.back().slot + 1) break;
 				}
 
 				break;
@@ -1045,32 +1263,32 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 
 					switch (block[i]->type) {
 					case AST_STATEMENT_CONDITION:
-						if (!block[i]->assignment.variables.size() && block[i]->instruction.target == function.labels[extendedTargetLabel].target) {
+						if (!block[i]->assignment->variables.size() && block[i]->instruction.target == function.labels[extendedTargetLabel].target) {
 							switch (block[index]->type) {
 							case AST_STATEMENT_CONDITION:
-								if (block[index]->assignment.expressions.size() == 1) {
-									if (block[index]->assignment.variables.size()) {
-										if (function.slotScopeCollector.slotInfos[block[index]->assignment.variables.back().slot].activeSlotScope
-											&& function.slotScopeCollector.slotInfos[block[index]->assignment.variables.back().slot].minScopeBegin == block[index]->instruction.id) {
+								if (block[index]->assignment->expressions.size() == 1) {
+									if (block[index]->assignment->variables.size()) {
+										if (function.slotScopeCollector.slotInfos[block[index]->assignment->variables.back().slot].activeSlotScope
+											&& function.slotScopeCollector.slotInfos[block[index]->assignment->variables.back().slot].minScopeBegin == block[index]->instruction.id) {
 											isPossibleCondition = true;
-											targetSlot = block[index]->assignment.variables.back().slot;
+											targetSlot = block[index]->assignment->variables.back().slot;
 										}
-									} else if (function.slotScopeCollector.slotInfos[block[index]->assignment.expressions.back()->variable->slot].activeSlotScope
-										&& function.slotScopeCollector.slotInfos[block[index]->assignment.expressions.back()->variable->slot].minScopeBegin == block[index]->instruction.id) {
+									} else if (function.slotScopeCollector.slotInfos[block[index]->assignment->expressions.back()->variable->slot].activeSlotScope
+										&& function.slotScopeCollector.slotInfos[block[index]->assignment->expressions.back()->variable->slot].minScopeBegin == block[index]->instruction.id) {
 										isPossibleCondition = true;
-										targetSlot = block[index]->assignment.expressions.back()->variable->slot;
+										targetSlot = block[index]->assignment->expressions.back()->variable->slot;
 									}
 								}
 
 								break;
 							case AST_STATEMENT_ASSIGNMENT:
-								if (block[index]->assignment.variables.size() == 1
-									&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT
-									&& function.slotScopeCollector.slotInfos[block[index]->assignment.variables.back().slot].activeSlotScope
-									&& function.slotScopeCollector.slotInfos[block[index]->assignment.variables.back().slot].minScopeBegin == block[index]->instruction.id
-									&& get_constant_type(block[index]->assignment.expressions.back())) {
+								if (block[index]->assignment->variables.size() == 1
+									&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT
+									&& function.slotScopeCollector.slotInfos[block[index]->assignment->variables.back().slot].activeSlotScope
+									&& function.slotScopeCollector.slotInfos[block[index]->assignment->variables.back().slot].minScopeBegin == block[index]->instruction.id
+									&& get_constant_type(block[index]->assignment->expressions.back())) {
 									isPossibleCondition = true;
-									targetSlot = block[index]->assignment.variables.back().slot;
+									targetSlot = block[index]->assignment->variables.back().slot;
 								}
 
 								break;
@@ -1079,13 +1297,13 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 
 						break;
 					case AST_STATEMENT_ASSIGNMENT:
-						if (block[i]->assignment.variables.size() == 1) {
-							switch (block[i]->assignment.variables.back().type) {
+						if (block[i]->assignment->variables.size() == 1) {
+							switch (block[i]->assignment->variables.back().type) {
 							case AST_VARIABLE_SLOT:
-								if (function.slotScopeCollector.slotInfos[block[i]->assignment.variables.back().slot].activeSlotScope
-									&& function.slotScopeCollector.slotInfos[block[i]->assignment.variables.back().slot].minScopeBegin == block[index]->instruction.id) {
+								if (function.slotScopeCollector.slotInfos[block[i]->assignment->variables.back().slot].activeSlotScope
+									&& function.slotScopeCollector.slotInfos[block[i]->assignment->variables.back().slot].minScopeBegin == block[index]->instruction.id) {
 									isPossibleCondition = true;
-									targetSlot = block[i]->assignment.variables.back().slot;
+									targetSlot = block[i]->assignment->variables.back().slot;
 									if (i >= 5
 										&& index <= i - 4
 										&& (((block[i - 3]->type == AST_STATEMENT_GOTO
@@ -1093,17 +1311,17 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 												&& !function.is_valid_label(block[i - 3]->instruction.label)
 												&& block[i - 3]->instruction.target == function.labels[extendedTargetLabel].target)
 											|| (block[i - 3]->type == AST_STATEMENT_CONDITION
-												&& block[i - 3]->assignment.expressions.size() == 2
+												&& block[i - 3]->assignment->expressions.size() == 2
 												&& block[i - 3]->instruction.target == block[i]->instruction.id))
-										&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-										&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_TRUE
+										&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+										&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_TRUE
 										&& (block[i - 1]->type == AST_STATEMENT_GOTO
 											|| block[i - 1]->type == AST_STATEMENT_BREAK)
 										&& !function.is_valid_label(block[i - 1]->instruction.label)
 										&& block[i - 1]->instruction.target == function.labels[targetLabel].target
 										&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
-										&& block[i - 2]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-										&& block[i - 2]->assignment.expressions.back()->constant->type == AST_CONSTANT_FALSE
+										&& block[i - 2]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+										&& block[i - 2]->assignment->expressions.back()->constant->type == AST_CONSTANT_FALSE
 										&& (function.is_valid_label(block[i]->instruction.label)
 											|| function.is_valid_label(block[i - 2]->instruction.label)))
 										hasBoolConstruct = true;
@@ -1111,10 +1329,10 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 
 								break;
 							case AST_VARIABLE_TABLE_INDEX:
-								if (function.slotScopeCollector.slotInfos[block[i]->assignment.variables.back().table->variable->slot].activeSlotScope
-									&& function.slotScopeCollector.slotInfos[block[i]->assignment.variables.back().table->variable->slot].minScopeBegin == block[index]->instruction.id) {
+								if (function.slotScopeCollector.slotInfos[block[i]->assignment->variables.back().table->variable->slot].activeSlotScope
+									&& function.slotScopeCollector.slotInfos[block[i]->assignment->variables.back().table->variable->slot].minScopeBegin == block[index]->instruction.id) {
 									isPossibleCondition = true;
-									targetSlot = block[i]->assignment.variables.back().table->variable->slot;
+									targetSlot = block[i]->assignment->variables.back().table->variable->slot;
 								}
 
 								break;
@@ -1141,20 +1359,20 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 							isPossibleCondition = false;
 
 							if (block[index]->type == AST_STATEMENT_ASSIGNMENT
-								&& block[index]->assignment.variables.size() == 1
-								&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT) {
-								if (block[index]->assignment.variables.back().slot == targetSlot) isPossibleCondition = true;
+								&& block[index]->assignment->variables.size() == 1
+								&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT) {
+								if (block[index]->assignment->variables.back().slot == targetSlot) isPossibleCondition = true;
 							} else if ((block[index]->type == AST_STATEMENT_ASSIGNMENT
-									&& block[index]->assignment.variables.size() == 1
-									&& block[index]->assignment.variables.back().type == AST_VARIABLE_TABLE_INDEX
-									&& block[index]->assignment.variables.back().table->variable->slot == targetSlot)
+									&& block[index]->assignment->variables.size() == 1
+									&& block[index]->assignment->variables.back().type == AST_VARIABLE_TABLE_INDEX
+									&& block[index]->assignment->variables.back().table->variable->slot == targetSlot)
 								|| (block[index]->type == AST_STATEMENT_CONDITION
 									&& block[index]->instruction.target == function.labels[extendedTargetLabel].target
-									&& !block[index]->assignment.variables.size())) {
+									&& !block[index]->assignment->variables.size())) {
 								while (index--) {
 									switch (block[index]->type) {
 									case AST_STATEMENT_CONDITION:
-										if (!block[index]->assignment.variables.size() && block[index]->instruction.target == function.labels[extendedTargetLabel].target) continue;
+										if (!block[index]->assignment->variables.size() && block[index]->instruction.target == function.labels[extendedTargetLabel].target) continue;
 									case AST_STATEMENT_GOTO:
 									case AST_STATEMENT_BREAK:
 										if (block[index]->instruction.target == function.labels[targetLabel].target
@@ -1163,10 +1381,10 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 											break;
 										continue;
 									case AST_STATEMENT_ASSIGNMENT:
-										if (block[index]->assignment.variables.size() == 1
-											&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT
-											&& block[index]->assignment.variables.back().slot == targetSlot) {
-											if (block[index]->assignment.isTableConstructor
+										if (block[index]->assignment->variables.size() == 1
+											&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT
+											&& block[index]->assignment->variables.back().slot == targetSlot) {
+											if (block[index]->assignment->isTableConstructor
 												&& (hasBoolConstruct
 													|| block[index]->instruction.id > function.labels[targetLabel].jumpIds.front())
 												&& function.is_valid_block_range(block[index]->instruction.id, block[hasBoolConstruct ? i - 4 : i]->instruction.id, true))
@@ -1205,29 +1423,29 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 
 								switch (block[index]->type) {
 								case AST_STATEMENT_CONDITION:
-									if (block[index]->assignment.expressions.size() != 1) break;
+									if (block[index]->assignment->expressions.size() != 1) break;
 
-									if (block[index]->assignment.variables.size()) {
-										if (block[index]->assignment.variables.back().slot == targetSlot) isPossibleCondition = true;
-									} else if (index && block[index]->assignment.expressions.back()->variable->slot == targetSlot) {
+									if (block[index]->assignment->variables.size()) {
+										if (block[index]->assignment->variables.back().slot == targetSlot) isPossibleCondition = true;
+									} else if (index && block[index]->assignment->expressions.back()->variable->slot == targetSlot) {
 										index--;
 
 										if (block[index]->type == AST_STATEMENT_ASSIGNMENT
-											&& block[index]->assignment.variables.size() == 1
-											&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT) {
-											if (block[index]->assignment.variables.back().slot == targetSlot && !function.is_valid_label(block[index + 1]->instruction.label)) isPossibleCondition = true;
+											&& block[index]->assignment->variables.size() == 1
+											&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT) {
+											if (block[index]->assignment->variables.back().slot == targetSlot && !function.is_valid_label(block[index + 1]->instruction.label)) isPossibleCondition = true;
 										} else if ((block[index]->type == AST_STATEMENT_ASSIGNMENT
-												&& block[index]->assignment.variables.size() == 1
-												&& block[index]->assignment.variables.back().type == AST_VARIABLE_TABLE_INDEX
-												&& block[index]->assignment.variables.back().table->variable->slot == targetSlot
+												&& block[index]->assignment->variables.size() == 1
+												&& block[index]->assignment->variables.back().type == AST_VARIABLE_TABLE_INDEX
+												&& block[index]->assignment->variables.back().table->variable->slot == targetSlot
 												&& !function.is_valid_label(block[index + 1]->instruction.label))
 											|| (block[index]->type == AST_STATEMENT_CONDITION
 												&& block[index]->instruction.target == block[blockIndex]->instruction.id
-												&& !block[index]->assignment.variables.size())) {
+												&& !block[index]->assignment->variables.size())) {
 											while (index--) {
 												switch (block[index]->type) {
 												case AST_STATEMENT_CONDITION:
-													if (!block[index]->assignment.variables.size() && block[index]->instruction.target == block[blockIndex]->instruction.id) continue;
+													if (!block[index]->assignment->variables.size() && block[index]->instruction.target == block[blockIndex]->instruction.id) continue;
 												case AST_STATEMENT_GOTO:
 												case AST_STATEMENT_BREAK:
 													if (block[index]->instruction.target == function.labels[targetLabel].target
@@ -1235,10 +1453,10 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 														|| block[index]->instruction.target >= block[blockIndex]->instruction.id) break;
 													continue;
 												case AST_STATEMENT_ASSIGNMENT:
-													if (block[index]->assignment.variables.size() == 1
-														&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT
-														&& block[index]->assignment.variables.back().slot == targetSlot) {
-														if (block[index]->assignment.isTableConstructor
+													if (block[index]->assignment->variables.size() == 1
+														&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT
+														&& block[index]->assignment->variables.back().slot == targetSlot) {
+														if (block[index]->assignment->isTableConstructor
 															&& function.is_valid_block_range(block[index]->instruction.id, block[blockIndex]->instruction.id, true))
 															isPossibleCondition = true;
 														break;
@@ -1256,10 +1474,10 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 								case AST_STATEMENT_GOTO:
 								case AST_STATEMENT_BREAK:
 									if (index--
-										&& block[index]->assignment.variables.size() == 1
-										&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT
-										&& block[index]->assignment.variables.back().slot == targetSlot
-										&& get_constant_type(block[index]->assignment.expressions.back()))
+										&& block[index]->assignment->variables.size() == 1
+										&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT
+										&& block[index]->assignment->variables.back().slot == targetSlot
+										&& get_constant_type(block[index]->assignment->expressions.back()))
 										isPossibleCondition = true;
 									break;
 								}
@@ -1272,8 +1490,8 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 							for (uint32_t j = index; j <= i; j++) {
 								switch (block[j]->type) {
 								case AST_STATEMENT_ASSIGNMENT:
-									if (block[j]->assignment.variables.size() == 1) {
-										switch (block[j]->assignment.variables.back().type) {
+									if (block[j]->assignment->variables.size() == 1) {
+										switch (block[j]->assignment->variables.back().type) {
 										case AST_VARIABLE_SLOT:
 										case AST_VARIABLE_TABLE_INDEX:
 											continue;
@@ -1341,14 +1559,7 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 
 										while (function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back() != targetSlotScope) {
 											(*targetSlotScope)->usages += (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->usages + 1;
-
-											for (uint32_t k = (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes.size(); k--;) {
-												*(*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes[k] = *targetSlotScope;
-											}
-
-											(*targetSlotScope)->mergedScopes.insert((*targetSlotScope)->mergedScopes.begin(), (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes.begin(), (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes.end());
-											(*targetSlotScope)->mergedScopes.emplace_back(&(*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->slotScope);
-											*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back() = *targetSlotScope;
+											function.slotScopeCollector.merge_scope(targetSlotScope, function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back());
 											function.slotScopeCollector.slotInfos[targetSlot].slotScopes.pop_back();
 										}
 
@@ -1373,40 +1584,40 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 		if (block[i]->function) {
 			for (uint8_t j = block[i]->function->upvalues.size(); j--;) {
 				if (!block[i]->function->upvalues[j].local) continue;
-				if (block[i]->function->upvalues[j].slot == block[i]->assignment.variables.back().slot) block[i]->function->assignmentSlotIsUpvalue = true;
+				if (block[i]->function->upvalues[j].slot == block[i]->assignment->variables.back().slot) block[i]->function->assignmentSlotIsUpvalue = true;
 				function.slotScopeCollector.add_to_scope(block[i]->function->upvalues[j].slot, block[i]->function->upvalues[j].slotScope, id);
 			}
 		}
 
-		for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-			switch (block[i]->assignment.variables[j].type) {
+		for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+			switch (block[i]->assignment->variables[j].type) {
 			case AST_VARIABLE_SLOT:
-				if (block[i]->type != AST_STATEMENT_DECLARATION || function.slotScopeCollector.slotInfos[block[i]->assignment.variables[j].slot].minScopeBegin >= id) {
-					function.slotScopeCollector.close_scope(block[i]->assignment.variables[j].slot, block[i]->assignment.variables[j].slotScope, id);
+				if (block[i]->type != AST_STATEMENT_DECLARATION || function.slotScopeCollector.slotInfos[block[i]->assignment->variables[j].slot].minScopeBegin >= id) {
+					function.slotScopeCollector.close_scope(block[i]->assignment->variables[j].slot, block[i]->assignment.create()->variables[j].slotScope, id);
 					continue;
 				}
 				
-				index = function.slotScopeCollector.slotInfos[block[i]->assignment.variables[j].slot].minScopeBegin;
-				function.slotScopeCollector.slotInfos[block[i]->assignment.variables[j].slot].minScopeBegin = INVALID_ID;
-				function.slotScopeCollector.close_scope(block[i]->assignment.variables[j].slot, block[i]->assignment.variables[j].slotScope, id);
-				function.slotScopeCollector.slotInfos[block[i]->assignment.variables[j].slot].minScopeBegin = index;
+				index = function.slotScopeCollector.slotInfos[block[i]->assignment->variables[j].slot].minScopeBegin;
+				function.slotScopeCollector.slotInfos[block[i]->assignment->variables[j].slot].minScopeBegin = INVALID_ID;
+				function.slotScopeCollector.close_scope(block[i]->assignment->variables[j].slot, block[i]->assignment.create()->variables[j].slotScope, id);
+				function.slotScopeCollector.slotInfos[block[i]->assignment->variables[j].slot].minScopeBegin = index;
 				continue;
 			case AST_VARIABLE_TABLE_INDEX:
-				function.slotScopeCollector.add_to_scope(block[i]->assignment.variables[j].table->variable->slot, block[i]->assignment.variables[j].table->variable->slotScope, id);
+				function.slotScopeCollector.add_to_scope(block[i]->assignment->variables[j].table->variable->slot, block[i]->assignment->variables[j].table->variable->slotScope, id);
 				continue;
 			}
 		}
 
-		assert(!block[i]->assignment.variables.size()
-			|| block[i]->assignment.variables.front().type != AST_VARIABLE_SLOT
-			|| !block[i]->assignment.variables.front().isMultres
-			|| ((*block[i]->assignment.variables.front().slotScope)->usages == 1
-				&& (!function.slotScopeCollector.slotInfos[block[i]->assignment.variables.front().slot].activeSlotScope
-					|| *function.slotScopeCollector.slotInfos[block[i]->assignment.variables.front().slot].activeSlotScope != *block[i]->assignment.variables.front().slotScope)),
+		assert(!block[i]->assignment->variables.size()
+			|| block[i]->assignment->variables.front().type != AST_VARIABLE_SLOT
+			|| !block[i]->assignment->variables.front().isMultres
+			|| ((*block[i]->assignment->variables.front().slotScope)->usages == 1
+				&& (!function.slotScopeCollector.slotInfos[block[i]->assignment->variables.front().slot].activeSlotScope
+					|| function.slotScopeCollector.slotInfos[block[i]->assignment->variables.front().slot].activeSlotScope->find() != block[i]->assignment->variables.front().slotScope->find())),
 			"Multres assignment has invalid number of usages", bytecode.filePath, DEBUG_INFO);
 
-		for (uint8_t j = block[i]->assignment.openSlots.size(); j--;) {
-			function.slotScopeCollector.add_to_scope((*block[i]->assignment.openSlots[j])->variable->slot, (*block[i]->assignment.openSlots[j])->variable->slotScope, id);
+		for (uint8_t j = block[i]->assignment->openSlots.size(); j--;) {
+			function.slotScopeCollector.add_to_scope((*block[i]->assignment->openSlots[j])->variable->slot, (*block[i]->assignment->openSlots[j])->variable->slotScope, id);
 		}
 
 		if (block[i]->instruction.id != INVALID_ID) {
@@ -1470,20 +1681,21 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 	bool hasBoolConstruct;
 
 	for (uint32_t i = 0; i < block.size(); i++) {
+		check_budget();
 		switch (block[i]->type) {
 		case AST_STATEMENT_CONDITION:
-			if (block[i]->condition.allowSlotSwap
+			if (block[i]->assignment->condition.allowSlotSwap
 				&& i
 				&& !function.is_valid_label(block[i]->instruction.label)
 				&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-				&& block[i - 1]->assignment.variables.size() == 1
-				&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
-				&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.expressions[0]->variable->slot) {
-				expression = block[i]->assignment.expressions[0];
-				block[i]->assignment.expressions[0] = block[i]->assignment.expressions[1];
-				block[i]->assignment.expressions[1] = expression;
-				block[i]->condition.swapped = true;
+				&& block[i - 1]->assignment->variables.size() == 1
+				&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+				&& (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1
+				&& block[i - 1]->assignment->variables.back().slot == block[i]->assignment->expressions[0]->variable->slot) {
+				expression = block[i]->assignment->expressions[0];
+				block[i]->assignment.create()->expressions[0] = block[i]->assignment->expressions[1];
+				block[i]->assignment.create()->expressions[1] = expression;
+				block[i]->assignment.create()->condition.swapped = true;
 			}
 
 			break;
@@ -1492,31 +1704,31 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 			while (i && !function.is_valid_label(block[i]->instruction.label)) {
 				switch (block[i - 1]->type) {
 				case AST_STATEMENT_ASSIGNMENT:
-					if (block[i - 1]->assignment.variables.front().slot <= block[i]->assignment.expressions[block[i]->assignment.openSlots.size() - 1]->variable->slot) break;
-					assert(block[i - 1]->assignment.variables.size() == 1 && !(*block[i - 1]->assignment.variables.back().slotScope)->usages, "Invalid expression list assignment", bytecode.filePath, DEBUG_INFO);
+					if (block[i - 1]->assignment->variables.front().slot <= block[i]->assignment->expressions[block[i]->assignment->openSlots.size() - 1]->variable->slot) break;
+					assert(block[i - 1]->assignment->variables.size() == 1 && !(*block[i - 1]->assignment->variables.back().slotScope)->usages, "Invalid expression list assignment", bytecode.filePath, DEBUG_INFO);
 				case AST_STATEMENT_FUNCTION_CALL:
-					block[i]->assignment.expressions.emplace(block[i]->assignment.expressions.begin() + block[i]->assignment.openSlots.size(), block[i - 1]->assignment.expressions.back());
+					block[i]->assignment.create()->expressions.emplace(block[i]->assignment->expressions.begin() + block[i]->assignment->openSlots.size(), block[i - 1]->assignment->expressions.back());
 					block[i]->instruction.label = block[i - 1]->instruction.label;
 					i--;
 					block.erase(block.begin() + i);
 					continue;
 				}
 
-				if (block[i - 1]->type == AST_STATEMENT_ASSIGNMENT && block[i - 1]->assignment.variables.size() != 1) {
-					assert(block[i]->assignment.expressions.size() == block[i]->assignment.openSlots.size()
-						&& block[i]->assignment.expressions.back()->variable->slot == block[i - 1]->assignment.variables.back().slot,
+				if (block[i - 1]->type == AST_STATEMENT_ASSIGNMENT && block[i - 1]->assignment->variables.size() != 1) {
+					assert(block[i]->assignment->expressions.size() == block[i]->assignment->openSlots.size()
+						&& block[i]->assignment->expressions.back()->variable->slot == block[i - 1]->assignment->variables.back().slot,
 						"Invalid multres expression list assignment", bytecode.filePath, DEBUG_INFO);
 
 					while (true) {
-						function.slotScopeCollector.remove_scope(block[i]->assignment.expressions.back()->variable->slot, block[i]->assignment.expressions.back()->variable->slotScope);
-						block[i]->assignment.openSlots.pop_back();
+						function.slotScopeCollector.remove_scope(block[i]->assignment->expressions.back()->variable->slot, block[i]->assignment->expressions.back()->variable->slotScope);
+						block[i]->assignment.create()->openSlots.pop_back();
 
-						if (block[i]->assignment.expressions.back()->variable->slot != block[i - 1]->assignment.variables.front().slot) {
-							block[i]->assignment.expressions.pop_back();
+						if (block[i]->assignment->expressions.back()->variable->slot != block[i - 1]->assignment->variables.front().slot) {
+							block[i]->assignment.create()->expressions.pop_back();
 							continue;
 						}
 
-						block[i]->assignment.expressions.back() = block[i - 1]->assignment.expressions.back();
+						block[i]->assignment.create()->expressions.back() = block[i - 1]->assignment->expressions.back();
 						block[i]->instruction.label = block[i - 1]->instruction.label;
 						i--;
 						block.erase(block.begin() + i);
@@ -1524,8 +1736,8 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					}
 				}
 
-				for (uint32_t j = block[i]->assignment.openSlots.size(); j--;) {
-					block[i]->assignment.openSlots[j] = &block[i]->assignment.expressions[j];
+				for (uint32_t j = block[i]->assignment->openSlots.size(); j--;) {
+					block[i]->assignment.create()->openSlots[j] = &block[i]->assignment.create()->expressions[j];
 				}
 
 				break;
@@ -1533,54 +1745,54 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 
 			break;
 		case AST_STATEMENT_ASSIGNMENT:
-			switch (block[i]->assignment.variables.back().type) {
+			switch (block[i]->assignment->variables.back().type) {
 			case AST_VARIABLE_SLOT:
-				if (block[i]->assignment.expressions.back()->type == AST_EXPRESSION_BINARY_OPERATION
-					&& block[i]->assignment.expressions.back()->binaryOperation->type != AST_BINARY_CONCATENATION
-					&& block[i]->assignment.openSlots.size() == 2
+				if (block[i]->assignment->expressions.back()->type == AST_EXPRESSION_BINARY_OPERATION
+					&& block[i]->assignment->expressions.back()->binaryOperation->type != AST_BINARY_CONCATENATION
+					&& block[i]->assignment->openSlots.size() == 2
 					&& i >= 2
 					&& !function.is_valid_label(block[i]->instruction.label)
 					&& !function.is_valid_label(block[i - 1]->instruction.label)
 					&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[i - 1]->assignment.variables.size() == 1
-					&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
-					&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.expressions.back()->binaryOperation->leftOperand->variable->slot
-					&& get_constant_type(block[i - 1]->assignment.expressions.back()) == NUMBER_CONSTANT
+					&& block[i - 1]->assignment->variables.size() == 1
+					&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1
+					&& block[i - 1]->assignment->variables.back().slot == block[i]->assignment->expressions.back()->binaryOperation->leftOperand->variable->slot
+					&& get_constant_type(block[i - 1]->assignment->expressions.back()) == NUMBER_CONSTANT
 					&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[i - 2]->assignment.variables.size() == 1
-					&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 2]->assignment.variables.back().slotScope)->usages == 1
-					&& block[i - 2]->assignment.variables.back().slot == block[i]->assignment.expressions.back()->binaryOperation->rightOperand->variable->slot) {
-					block[i]->assignment.openSlots[0] = &block[i]->assignment.expressions.back()->binaryOperation->rightOperand;
-					block[i]->assignment.openSlots[1] = &block[i]->assignment.expressions.back()->binaryOperation->leftOperand;
+					&& block[i - 2]->assignment->variables.size() == 1
+					&& block[i - 2]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& (*block[i - 2]->assignment->variables.back().slotScope)->usages == 1
+					&& block[i - 2]->assignment->variables.back().slot == block[i]->assignment->expressions.back()->binaryOperation->rightOperand->variable->slot) {
+					block[i]->assignment.create()->openSlots[0] = &block[i]->assignment->expressions.back()->binaryOperation->rightOperand;
+					block[i]->assignment.create()->openSlots[1] = &block[i]->assignment->expressions.back()->binaryOperation->leftOperand;
 				}
 
 				break;
 			case AST_VARIABLE_TABLE_INDEX:
-				if (!block[i]->assignment.variables.back().isMultres
+				if (!block[i]->assignment->variables.back().isMultres
 					&& i >= 3
 					&& !function.is_valid_label(block[i]->instruction.label)
 					&& !function.is_valid_label(block[i - 1]->instruction.label)
 					&& !function.is_valid_label(block[i - 2]->instruction.label)
 					&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[i - 1]->assignment.variables.size() == 1
-					&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
-					&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.variables.back().tableIndex->variable->slot
-					&& get_constant_type(block[i - 1]->assignment.expressions.back())
+					&& block[i - 1]->assignment->variables.size() == 1
+					&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1
+					&& block[i - 1]->assignment->variables.back().slot == block[i]->assignment->variables.back().tableIndex->variable->slot
+					&& get_constant_type(block[i - 1]->assignment->expressions.back())
 					&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[i - 2]->assignment.variables.size() == 1
-					&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 2]->assignment.variables.back().slotScope)->usages == 1
-					&& block[i - 2]->assignment.variables.back().slot == block[i]->assignment.expressions.back()->variable->slot
-					&& (!get_constant_type(block[i - 2]->assignment.expressions.back())
-						|| get_constant_type(block[i - 1]->assignment.expressions.back()) == NIL_CONSTANT)
-					&& block[i - 3]->assignment.isTableConstructor
-					&& block[i - 3]->assignment.variables.back().slot == block[i]->assignment.variables.back().table->variable->slot
-					&& !block[i - 3]->assignment.expressions.back()->table->multresField) {
-					block[i]->assignment.openSlots[0] = &block[i]->assignment.expressions.back();
-					block[i]->assignment.openSlots[1] = &block[i]->assignment.variables.back().tableIndex;
+					&& block[i - 2]->assignment->variables.size() == 1
+					&& block[i - 2]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& (*block[i - 2]->assignment->variables.back().slotScope)->usages == 1
+					&& block[i - 2]->assignment->variables.back().slot == block[i]->assignment->expressions.back()->variable->slot
+					&& (!get_constant_type(block[i - 2]->assignment->expressions.back())
+						|| get_constant_type(block[i - 1]->assignment->expressions.back()) == NIL_CONSTANT)
+					&& block[i - 3]->assignment->isTableConstructor
+					&& block[i - 3]->assignment->variables.back().slot == block[i]->assignment->variables.back().table->variable->slot
+					&& !block[i - 3]->assignment->expressions.back()->table->multresField) {
+					block[i]->assignment.create()->openSlots[0] = &block[i]->assignment.create()->expressions.back();
+					block[i]->assignment.create()->openSlots[1] = &block[i]->assignment.create()->variables.back().tableIndex;
 				}
 
 				break;
@@ -1590,104 +1802,104 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 		}
 
 		if (block[i]->type == AST_STATEMENT_DECLARATION
-			&& block[i]->assignment.openSlots.size() == 1
-			&& (*(*block[i]->assignment.openSlots.back())->variable->slotScope)->usages > 1
+			&& block[i]->assignment->openSlots.size() == 1
+			&& (*(*block[i]->assignment->openSlots.back())->variable->slotScope)->usages > 1
 			&& i
 			&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-			&& block[i - 1]->assignment.variables.size() == 1
-			&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
+			&& block[i - 1]->assignment->variables.size() == 1
+			&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
 			&& block[i - 1]->function
 			&& block[i - 1]->function->assignmentSlotIsUpvalue
-			&& block[i - 1]->assignment.variables.back().slot == (*block[i]->assignment.openSlots.back())->variable->slot) {
-			*block[i]->assignment.openSlots.back() = block[i - 1]->assignment.expressions.back();
-			*block[i - 1]->assignment.variables.back().slotScope = *block[i]->assignment.variables.back().slotScope;
+			&& block[i - 1]->assignment->variables.back().slot == (*block[i]->assignment->openSlots.back())->variable->slot) {
+			*block[i]->assignment->openSlots.back() = block[i - 1]->assignment->expressions.back();
+			function.slotScopeCollector.merge_scope(block[i]->assignment->variables.back().slotScope, block[i - 1]->assignment->variables.back().slotScope);
 			block[i]->instruction.label = block[i - 1]->instruction.label;
 			i--;
-			function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
+			function.slotScopeCollector.remove_scope(block[i]->assignment->variables.back().slot, block[i]->assignment->variables.back().slotScope);
 			block.erase(block.begin() + i);
 		} else {
-			for (uint8_t j = block[i]->assignment.openSlots.size();
+			for (uint8_t j = block[i]->assignment->openSlots.size();
 				j--
 				&& i
 				&& !function.is_valid_label(block[i]->instruction.label)
 				&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-				&& block[i - 1]->assignment.variables.size() == 1
-				&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1;) {
+				&& block[i - 1]->assignment->variables.size() == 1
+				&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+				&& (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1;) {
 				if (j == 1
-					&& block[i]->assignment.isPotentialMethod
+					&& block[i]->assignment->isPotentialMethod
 					&& i >= 2
 					&& !function.is_valid_label(block[i - 1]->instruction.label)
-					&& block[i - 1]->assignment.variables.back().slot == (*block[i]->assignment.openSlots.front())->variable->slot
-					&& block[i - 1]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-					&& block[i - 1]->assignment.expressions.back()->variable->type == AST_VARIABLE_TABLE_INDEX
-					&& block[i - 1]->assignment.expressions.back()->variable->table->type == AST_EXPRESSION_VARIABLE
-					&& block[i - 1]->assignment.expressions.back()->variable->table->variable->type == AST_VARIABLE_SLOT
-					&& block[i - 1]->assignment.expressions.back()->variable->tableIndex->type == AST_EXPRESSION_CONSTANT
-					&& block[i - 1]->assignment.expressions.back()->variable->tableIndex->constant->isName
+					&& block[i - 1]->assignment->variables.back().slot == (*block[i]->assignment->openSlots.front())->variable->slot
+					&& block[i - 1]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+					&& block[i - 1]->assignment->expressions.back()->variable->type == AST_VARIABLE_TABLE_INDEX
+					&& block[i - 1]->assignment->expressions.back()->variable->table->type == AST_EXPRESSION_VARIABLE
+					&& block[i - 1]->assignment->expressions.back()->variable->table->variable->type == AST_VARIABLE_SLOT
+					&& block[i - 1]->assignment->expressions.back()->variable->tableIndex->type == AST_EXPRESSION_CONSTANT
+					&& block[i - 1]->assignment->expressions.back()->variable->tableIndex->constant->isName
 					&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[i - 2]->assignment.variables.size() == 1
-					&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 2]->assignment.variables.back().slotScope)->usages == 1
-					&& block[i - 2]->assignment.variables.back().slot == (*block[i]->assignment.openSlots[j])->variable->slot
-					&& block[i - 2]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-					&& block[i - 2]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
-					&& block[i - 2]->assignment.expressions.back()->variable->slot == block[i - 1]->assignment.expressions.back()->variable->table->variable->slot) {
+					&& block[i - 2]->assignment->variables.size() == 1
+					&& block[i - 2]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& (*block[i - 2]->assignment->variables.back().slotScope)->usages == 1
+					&& block[i - 2]->assignment->variables.back().slot == (*block[i]->assignment->openSlots[j])->variable->slot
+					&& block[i - 2]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+					&& block[i - 2]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT
+					&& block[i - 2]->assignment->expressions.back()->variable->slot == block[i - 1]->assignment->expressions.back()->variable->table->variable->slot) {
 					if (block[i]->type == AST_STATEMENT_RETURN) {
-						block[i]->assignment.multresReturn->functionCall->isMethod = true;
-						block[i]->assignment.multresReturn->functionCall->arguments.erase(block[i]->assignment.multresReturn->functionCall->arguments.begin());
+						block[i]->assignment->multresReturn->functionCall->isMethod = true;
+						block[i]->assignment->multresReturn->functionCall->arguments.erase(block[i]->assignment->multresReturn->functionCall->arguments.begin());
 					} else {
-						block[i]->assignment.expressions.back()->functionCall->isMethod = true;
-						block[i]->assignment.expressions.back()->functionCall->arguments.erase(block[i]->assignment.expressions.back()->functionCall->arguments.begin());
+						block[i]->assignment->expressions.back()->functionCall->isMethod = true;
+						block[i]->assignment->expressions.back()->functionCall->arguments.erase(block[i]->assignment->expressions.back()->functionCall->arguments.begin());
 					}
 
-					block[i]->assignment.openSlots.erase(block[i]->assignment.openSlots.begin() + j);
-					block[i]->assignment.openSlots.emplace(block[i]->assignment.openSlots.begin(), &block[i - 1]->assignment.expressions.back()->variable->table);
-					function.slotScopeCollector.remove_scope(block[i - 2]->assignment.variables.back().slot, block[i - 2]->assignment.variables.back().slotScope);
+					block[i]->assignment.create()->openSlots.erase(block[i]->assignment->openSlots.begin() + j);
+					block[i]->assignment.create()->openSlots.emplace(block[i]->assignment->openSlots.begin(), &block[i - 1]->assignment->expressions.back()->variable->table);
+					function.slotScopeCollector.remove_scope(block[i - 2]->assignment->variables.back().slot, block[i - 2]->assignment->variables.back().slotScope);
 					block[i - 1]->instruction.label = block[i - 2]->instruction.label;
-					(*block[i - 2]->assignment.expressions.back()->variable->slotScope)->usages--;
+					(*block[i - 2]->assignment->expressions.back()->variable->slotScope)->usages--;
 					i--;
 					block.erase(block.begin() + i - 1);
 				}
 
-				if (block[i - 1]->assignment.variables.back().slot != (*block[i]->assignment.openSlots[j])->variable->slot) continue;
-				assert(block[i - 1]->assignment.variables.back().isMultres == (*block[i]->assignment.openSlots[j])->variable->isMultres,
+				if (block[i - 1]->assignment->variables.back().slot != (*block[i]->assignment->openSlots[j])->variable->slot) continue;
+				assert(block[i - 1]->assignment->variables.back().isMultres == (*block[i]->assignment->openSlots[j])->variable->isMultres,
 					"Multres type mismatch when trying to eliminate slot", bytecode.filePath, DEBUG_INFO);
-				expression = *block[i]->assignment.openSlots[j];
-				*block[i]->assignment.openSlots[j] = block[i - 1]->assignment.expressions.back();
+				expression = *block[i]->assignment->openSlots[j];
+				*block[i]->assignment->openSlots[j] = block[i - 1]->assignment->expressions.back();
 
 				if (!j
-					&& block[i]->assignment.allowedConstantType != NUMBER_CONSTANT
-					&& get_constant_type(block[i]->assignment.expressions.back()) > block[i]->assignment.allowedConstantType) {
-					*block[i]->assignment.openSlots[j] = expression;
+					&& block[i]->assignment->allowedConstantType != NUMBER_CONSTANT
+					&& get_constant_type(block[i]->assignment->expressions.back()) > block[i]->assignment->allowedConstantType) {
+					*block[i]->assignment->openSlots[j] = expression;
 					break;
 				}
 
-				function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
+				function.slotScopeCollector.remove_scope(block[i - 1]->assignment->variables.back().slot, block[i - 1]->assignment->variables.back().slotScope);
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
 				block.erase(block.begin() + i);
 			}
 		}
 
-		assert(!block[i]->assignment.openSlots.size()
-			|| (*block[i]->assignment.openSlots.back())->type != AST_EXPRESSION_VARIABLE
-			|| !(*block[i]->assignment.openSlots.back())->variable->isMultres,
+		assert(!block[i]->assignment->openSlots.size()
+			|| (*block[i]->assignment->openSlots.back())->type != AST_EXPRESSION_VARIABLE
+			|| !(*block[i]->assignment->openSlots.back())->variable->isMultres,
 			"Unable to eliminate multres slot", bytecode.filePath, DEBUG_INFO);
 
 		switch (block[i]->type) {
 		case AST_STATEMENT_NUMERIC_FOR:
 		case AST_STATEMENT_GENERIC_FOR:
-			eliminate_slots(function, block[i]->block, nullptr);
+			eliminate_slots(function, *block[i]->block.create(), nullptr);
 			break;
 		case AST_STATEMENT_LOOP:
 		case AST_STATEMENT_DECLARATION:
 			blockInfo.index = i;
-			eliminate_slots(function, block[i]->block, &blockInfo);
+			eliminate_slots(function, *block[i]->block.create(), &blockInfo);
 			break;
 		case AST_STATEMENT_ASSIGNMENT:
-			if (block[i]->assignment.variables.size() == 1) {
-				switch (block[i]->assignment.variables.back().type) {
+			if (block[i]->assignment->variables.size() == 1) {
+				switch (block[i]->assignment->variables.back().type) {
 				case AST_VARIABLE_SLOT:
 					if (block[i]->instruction.id == INVALID_ID) break;
 					blockInfo.index = i;
@@ -1695,43 +1907,43 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					extendedTargetLabel = get_label_from_next_statement(function, blockInfo, true, true);
 					if (!function.is_valid_label(targetLabel) || function.labels[targetLabel].jumpIds.front() > block[i]->instruction.id) break;
 
-					if ((*block[i]->assignment.variables.back().slotScope)->usages >= 2) {
-						if ((*block[i]->assignment.variables.back().slotScope)->scopeBegin >= function.labels[targetLabel].jumpIds.front()
+					if ((*block[i]->assignment->variables.back().slotScope)->usages >= 2) {
+						if ((*block[i]->assignment->variables.back().slotScope)->scopeBegin >= function.labels[targetLabel].jumpIds.front()
 							|| (extendedTargetLabel != targetLabel
 								&& (function.labels[extendedTargetLabel].target <= block[i]->instruction.id
 									|| function.labels[extendedTargetLabel].target >= function.labels[targetLabel].jumpIds.front()))
-							|| has_self_reference(block[i]->assignment.variables.back().slot, block[i]->assignment.expressions.back()))
+							|| has_self_reference(block[i]->assignment->variables.back().slot, block[i]->assignment->expressions.back()))
 							break;
 						index = get_block_index_from_id(block, function.labels[targetLabel].jumpIds.front() - 1);
 						if (index == INVALID_ID) break;
 
 						switch (block[index]->type) {
 						case AST_STATEMENT_CONDITION:
-							if (block[index]->assignment.variables.size()) {
-								if ((*block[index]->assignment.variables.back().slotScope)->scopeBegin == block[index]->instruction.id
-									&& *block[index]->assignment.variables.back().slotScope == *block[i]->assignment.variables.back().slotScope)
+							if (block[index]->assignment->variables.size()) {
+								if ((*block[index]->assignment->variables.back().slotScope)->scopeBegin == block[index]->instruction.id
+									&& block[index]->assignment->variables.back().slotScope->find() == block[i]->assignment->variables.back().slotScope->find())
 									break;
 							} else if (index
-									&& block[index]->assignment.expressions.size() == 1
+									&& block[index]->assignment->expressions.size() == 1
 									&& !function.is_valid_label(block[index]->instruction.label)
 									&& block[index - 1]->type == AST_STATEMENT_ASSIGNMENT
-									&& block[index - 1]->assignment.variables.size() == 1
-									&& block[index - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-									&& (*block[index - 1]->assignment.variables.back().slotScope)->scopeBegin == block[index - 1]->instruction.id
-									&& *block[index - 1]->assignment.variables.back().slotScope == *block[i]->assignment.variables.back().slotScope) {
+									&& block[index - 1]->assignment->variables.size() == 1
+									&& block[index - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+									&& (*block[index - 1]->assignment->variables.back().slotScope)->scopeBegin == block[index - 1]->instruction.id
+									&& block[index - 1]->assignment->variables.back().slotScope->find() == block[i]->assignment->variables.back().slotScope->find()) {
 								break;
 							}
 
 							index = INVALID_ID;
 							break;
 						case AST_STATEMENT_ASSIGNMENT:
-							if (block[index]->assignment.variables.size() != 1
-								|| block[index]->assignment.variables.back().type != AST_VARIABLE_SLOT
-								|| (*block[index]->assignment.variables.back().slotScope)->scopeBegin != block[index]->instruction.id
-								|| *block[index]->assignment.variables.back().slotScope != *block[i]->assignment.variables.back().slotScope
+							if (block[index]->assignment->variables.size() != 1
+								|| block[index]->assignment->variables.back().type != AST_VARIABLE_SLOT
+								|| (*block[index]->assignment->variables.back().slotScope)->scopeBegin != block[index]->instruction.id
+								|| block[index]->assignment->variables.back().slotScope->find() != block[i]->assignment->variables.back().slotScope->find()
 								|| (index != i - 4
-									&& (block[index]->assignment.expressions.back()->type != AST_EXPRESSION_CONSTANT
-										|| !get_constant_type(block[index]->assignment.expressions.back()))))
+									&& (block[index]->assignment->expressions.back()->type != AST_EXPRESSION_CONSTANT
+										|| !get_constant_type(block[index]->assignment->expressions.back()))))
 								index = INVALID_ID;
 							break;
 						}
@@ -1741,22 +1953,22 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 
 						if (i >= 3
 							&& block[i]->type == AST_STATEMENT_ASSIGNMENT
-							&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-							&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_TRUE
+							&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+							&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_TRUE
 							&& (block[i - 1]->type == AST_STATEMENT_GOTO
 								|| block[i - 1]->type == AST_STATEMENT_BREAK)
 							&& !function.is_valid_label(block[i - 1]->instruction.label)
 							&& block[i - 1]->instruction.type == Bytecode::BC_OP_JMP
 							&& block[i - 1]->instruction.target == function.labels[targetLabel].target
 							&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
-							&& block[i - 2]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-							&& block[i - 2]->assignment.expressions.back()->constant->type == AST_CONSTANT_FALSE
-							&& block[i - 2]->assignment.variables.size() == 1
-							&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-							&& *block[i - 2]->assignment.variables.back().slotScope == *block[i]->assignment.variables.back().slotScope) {
+							&& block[i - 2]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+							&& block[i - 2]->assignment->expressions.back()->constant->type == AST_CONSTANT_FALSE
+							&& block[i - 2]->assignment->variables.size() == 1
+							&& block[i - 2]->assignment->variables.back().type == AST_VARIABLE_SLOT
+							&& block[i - 2]->assignment->variables.back().slotScope->find() == block[i]->assignment->variables.back().slotScope->find()) {
 							switch (block[i - 3]->type) {
 							case AST_STATEMENT_CONDITION:
-								if (block[i - 3]->assignment.expressions.size() == 2 && block[i - 3]->instruction.target == block[i]->instruction.id) hasBoolConstruct = true;
+								if (block[i - 3]->assignment->expressions.size() == 2 && block[i - 3]->instruction.target == block[i]->instruction.id) hasBoolConstruct = true;
 								break;
 							case AST_STATEMENT_GOTO:
 							case AST_STATEMENT_BREAK:
@@ -1767,9 +1979,9 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 									|| (!function.is_valid_label(block[i]->instruction.label)
 										&& !function.is_valid_label(block[i - 2]->instruction.label))
 									|| block[i - 4]->type != AST_STATEMENT_ASSIGNMENT
-									|| block[i - 4]->assignment.variables.size() != 1
-									|| block[i - 4]->assignment.variables.back().type != AST_VARIABLE_SLOT
-									|| block[i - 4]->assignment.variables.back().slot != block[i]->assignment.variables.back().slot)
+									|| block[i - 4]->assignment->variables.size() != 1
+									|| block[i - 4]->assignment->variables.back().type != AST_VARIABLE_SLOT
+									|| block[i - 4]->assignment->variables.back().slot != block[i]->assignment->variables.back().slot)
 									break;
 
 								if (index == i - 2 && !function.is_valid_label(block[i]->instruction.label)) {
@@ -1799,12 +2011,12 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 
 										if (targetIndex == INVALID_ID
 											|| block[targetIndex]->type != AST_STATEMENT_CONDITION
-											|| block[targetIndex]->assignment.variables.size()) {
+											|| block[targetIndex]->assignment->variables.size()) {
 											index = INVALID_ID;
 											break;
 										}
 
-										if (!block[targetIndex]->assignment.expressions.size()) {
+										if (!block[targetIndex]->assignment->expressions.size()) {
 											hasBoolConstruct = false;
 											break;
 										}
@@ -1820,7 +2032,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 											break;
 										}
 
-										if (!block[targetIndex]->assignment.expressions.size() || block[targetIndex]->assignment.variables.size()) {
+										if (!block[targetIndex]->assignment->expressions.size() || block[targetIndex]->assignment->variables.size()) {
 											hasBoolConstruct = false;
 											break;
 										}
@@ -1852,7 +2064,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 						if (index != INVALID_ID) {
 							switch (block[index]->type) {
 							case AST_STATEMENT_CONDITION:
-								if (block[index]->assignment.variables.size()) break;
+								if (block[index]->assignment->variables.size()) break;
 							case AST_STATEMENT_GOTO:
 							case AST_STATEMENT_BREAK:
 								if (block[index]->instruction.target == function.labels[targetLabel].target && index) index--;
@@ -1868,19 +2080,19 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 									if (block[j]->instruction.target <= block[j]->instruction.id
 										|| block[j]->instruction.target > function.labels[targetLabel].target
 										|| (block[j]->instruction.target == function.labels[targetLabel].target
-											? !block[j]->assignment.variables.size()
-												|| *block[j]->assignment.variables.back().slotScope != *block[i]->assignment.variables.back().slotScope
-												|| has_self_reference(block[i]->assignment.variables.back().slot, block[j]->assignment.expressions.back())
-											: block[j]->assignment.variables.size()))
+											? !block[j]->assignment->variables.size()
+												|| block[j]->assignment->variables.back().slotScope->find() != block[i]->assignment->variables.back().slotScope->find()
+												|| has_self_reference(block[i]->assignment->variables.back().slot, block[j]->assignment->expressions.back())
+											: block[j]->assignment->variables.size()))
 										break;
-									conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->condition.swapped), block[j]->instruction.label,
-										function.get_label_from_id(block[j]->instruction.target), &block[j]->assignment.expressions);
+									conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->assignment->condition.swapped), block[j]->instruction.label,
+										function.get_label_from_id(block[j]->instruction.target), &block[j]->assignment->expressions);
 									continue;
 								case AST_STATEMENT_ASSIGNMENT:
-									if (block[j]->assignment.variables.size() != 1
-										|| block[j]->assignment.variables.back().type != AST_VARIABLE_SLOT
-										|| *block[j]->assignment.variables.back().slotScope != *block[i]->assignment.variables.back().slotScope
-										|| has_self_reference(block[i]->assignment.variables.back().slot, block[j]->assignment.expressions.back())
+									if (block[j]->assignment->variables.size() != 1
+										|| block[j]->assignment->variables.back().type != AST_VARIABLE_SLOT
+										|| block[j]->assignment->variables.back().slotScope->find() != block[i]->assignment->variables.back().slotScope->find()
+										|| has_self_reference(block[i]->assignment->variables.back().slot, block[j]->assignment->expressions.back())
 										|| j + 1 == targetIndex
 										|| function.is_valid_label(block[j + 1]->instruction.label))
 										break;
@@ -1889,35 +2101,35 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 									switch (block[j]->type) {
 									case AST_STATEMENT_CONDITION:
 										if (block[j]->instruction.target != function.labels[targetLabel].target
-											|| block[j]->assignment.variables.size()
-											|| block[j]->assignment.expressions.size() != 1
-											|| block[j]->assignment.expressions.back()->type != AST_EXPRESSION_VARIABLE
-											|| block[j]->assignment.expressions.back()->variable->type != AST_VARIABLE_SLOT
-											|| *block[j]->assignment.expressions.back()->variable->slotScope != *block[i]->assignment.variables.back().slotScope)
+											|| block[j]->assignment->variables.size()
+											|| block[j]->assignment->expressions.size() != 1
+											|| block[j]->assignment->expressions.back()->type != AST_EXPRESSION_VARIABLE
+											|| block[j]->assignment->expressions.back()->variable->type != AST_VARIABLE_SLOT
+											|| block[j]->assignment->expressions.back()->variable->slotScope->find() != block[i]->assignment->variables.back().slotScope->find())
 											break;
-										conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->condition.swapped), block[j - 1]->instruction.label,
-											function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment.expressions);
+										conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->assignment->condition.swapped), block[j - 1]->instruction.label,
+											function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment->expressions);
 										continue;
 									case AST_STATEMENT_GOTO:
 									case AST_STATEMENT_BREAK:
 										if (function.is_valid_label(block[j]->instruction.label)
 											|| block[j]->instruction.type != Bytecode::BC_OP_JMP
 											|| block[j]->instruction.target != function.labels[targetLabel].target
-											|| block[j - 1]->assignment.expressions.back()->type != AST_EXPRESSION_CONSTANT
-											|| !get_constant_type(block[j - 1]->assignment.expressions.back()))
+											|| block[j - 1]->assignment->expressions.back()->type != AST_EXPRESSION_CONSTANT
+											|| !get_constant_type(block[j - 1]->assignment->expressions.back()))
 											break;
 
-										switch (block[j - 1]->assignment.expressions.back()->constant->type) {
+										switch (block[j - 1]->assignment->expressions.back()->constant->type) {
 										case AST_CONSTANT_NIL:
 										case AST_CONSTANT_FALSE:
 											conditionBuilder.add_node(ConditionBuilder::Node::FALSY_TEST, block[j - 1]->instruction.label,
-												function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment.expressions);
+												function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment->expressions);
 											break;
 										case AST_CONSTANT_TRUE:
 										case AST_CONSTANT_STRING:
 										case AST_CONSTANT_NUMBER:
 											conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[j - 1]->instruction.label,
-												function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment.expressions);
+												function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment->expressions);
 											break;
 										}
 
@@ -1932,41 +2144,41 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 							}
 
 							if (!hasBoolConstruct) {
-								conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i]->instruction.label, targetLabel, &block[i]->assignment.expressions);
+								conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i]->instruction.label, targetLabel, &block[i]->assignment->expressions);
 							} else if (block[i - 3]->type == AST_STATEMENT_GOTO) {
-								conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i - 4]->instruction.label, targetLabel, &block[i - 4]->assignment.expressions);
+								conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i - 4]->instruction.label, targetLabel, &block[i - 4]->assignment->expressions);
 							}
 
 							if (index != INVALID_ID) {
 								expression = conditionBuilder.build_condition();
 								if (!expression) break;
-								block[i]->assignment.expressions.back() = expression;
+								block[i]->assignment.create()->expressions.back() = expression;
 
 								for (uint32_t j = index; j < i; j++) {
 									switch (block[j]->type) {
 									case AST_STATEMENT_CONDITION:
-										if (block[j]->instruction.target == function.labels[targetLabel].target) (*block[i]->assignment.variables.back().slotScope)->usages--;
+										if (block[j]->instruction.target == function.labels[targetLabel].target) (*block[i]->assignment->variables.back().slotScope)->usages--;
 										function.remove_jump(block[j]->instruction.id + 1, block[j]->instruction.target);
-										if (block[j]->assignment.variables.size()) function.remove_jump(block[j]->instruction.id, block[j]->instruction.id + 2);
+										if (block[j]->assignment->variables.size()) function.remove_jump(block[j]->instruction.id, block[j]->instruction.id + 2);
 										continue;
 									case AST_STATEMENT_GOTO:
 									case AST_STATEMENT_BREAK:
 										function.remove_jump(block[j]->instruction.id, block[j]->instruction.target);
 										continue;
 									case AST_STATEMENT_ASSIGNMENT:
-										(*block[i]->assignment.variables.back().slotScope)->usages--;
+										(*block[i]->assignment->variables.back().slotScope)->usages--;
 										continue;
 									}
 								}
 
 								block[i]->instruction.label = block[index]->instruction.label;
-								block[i]->assignment.isTableConstructor = false;
+								block[i]->assignment.create()->isTableConstructor = false;
 								block.erase(block.begin() + index, block.begin() + i);
 								i = index;
 							}
 						}
 					} else {
-						if ((*block[i]->assignment.variables.back().slotScope)->usages == 1
+						if ((*block[i]->assignment->variables.back().slotScope)->usages == 1
 							&& (i == block.size() - 1
 								|| block[i + 1]->type != AST_STATEMENT_DECLARATION))
 							break;
@@ -1978,46 +2190,61 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					if (i
 						&& !function.is_valid_label(block[i]->instruction.label)
 						&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-						&& block[i - 1]->assignment.variables.size() == 1
-						&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-						&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.variables.back().table->variable->slot) {
-						if (block[i - 1]->assignment.isTableConstructor
-							&& !block[i - 1]->assignment.expressions.back()->table->multresField
-							&& (block[i]->assignment.variables.back().isMultres
-								|| get_constant_type(block[i]->assignment.variables.back().tableIndex) <= NIL_CONSTANT
-								|| !get_constant_type(block[i]->assignment.expressions.back()))
-							&& (block[i]->assignment.variables.back().isMultres
-								|| !has_self_reference(block[i - 1]->assignment.variables.back().slot, block[i]->assignment.variables.back().tableIndex))
-							&& !has_self_reference(block[i - 1]->assignment.variables.back().slot, block[i]->assignment.expressions.back())) {
-							if (block[i]->assignment.variables.back().isMultres) {
-								block[i - 1]->assignment.expressions.back()->table->multresIndex = block[i]->assignment.variables.back().multresIndex;
-								block[i - 1]->assignment.expressions.back()->table->multresField = block[i]->assignment.expressions.back();
+						&& block[i - 1]->assignment->variables.size() == 1
+						&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+						&& block[i - 1]->assignment->variables.back().slot == block[i]->assignment->variables.back().table->variable->slot) {
+						if (block[i - 1]->assignment->isTableConstructor
+							&& !block[i - 1]->assignment->expressions.back()->table->multresField
+							&& (block[i]->assignment->variables.back().isMultres
+								|| get_constant_type(block[i]->assignment->variables.back().tableIndex) <= NIL_CONSTANT
+								|| !get_constant_type(block[i]->assignment->expressions.back()))
+							&& (block[i]->assignment->variables.back().isMultres
+								|| !has_self_reference(block[i - 1]->assignment->variables.back().slot, block[i]->assignment->variables.back().tableIndex))
+							&& !has_self_reference(block[i - 1]->assignment->variables.back().slot, block[i]->assignment->expressions.back())) {
+							if (block[i]->assignment->variables.back().isMultres) {
+								block[i - 1]->assignment->expressions.back()->table->multresIndex = block[i]->assignment->variables.back().multresIndex;
+								block[i - 1]->assignment->expressions.back()->table->multresField = block[i]->assignment->expressions.back();
 							} else {
-								if (block[i]->assignment.variables.back().tableIndex->type == AST_EXPRESSION_CONSTANT && block[i]->assignment.variables.back().tableIndex->constant->type == AST_CONSTANT_STRING) {
-									for (uint32_t j = block[i - 1]->assignment.expressions.back()->table->constants.fields.size(); j--;) {
-										if (block[i - 1]->assignment.expressions.back()->table->constants.fields[j].key->constant->type != AST_CONSTANT_STRING
-											|| block[i - 1]->assignment.expressions.back()->table->constants.fields[j].key->constant->string != block[i]->assignment.variables.back().tableIndex->constant->string)
+								if (block[i]->assignment->variables.back().tableIndex->type == AST_EXPRESSION_CONSTANT && block[i]->assignment->variables.back().tableIndex->constant->type == AST_CONSTANT_STRING) {
+									for (uint32_t j = block[i - 1]->assignment->expressions.back()->table->constants.fields.size(); j--;) {
+										if (block[i - 1]->assignment->expressions.back()->table->constants.fields[j].key->constant->type != AST_CONSTANT_STRING
+											|| block[i - 1]->assignment->expressions.back()->table->constants.fields[j].key->constant->string != block[i]->assignment->variables.back().tableIndex->constant->string)
+											continue;
+										if (block[i - 1]->assignment->expressions.back()->table->constants.fields[j].value->constant->type == AST_CONSTANT_NIL)
+											block[i - 1]->assignment->expressions.back()->table->constants.fields.erase(block[i - 1]->assignment->expressions.back()->table->constants.fields.begin() + j);
+										break;
+									}
+
+									for (uint32_t j = block[i - 1]->assignment->expressions.back()->table->constants.nodes.size(); j--;) {
+										if (block[i - 1]->assignment->expressions.back()->table->constants.nodes[j].key.type != Bytecode::BC_KTAB_STR
+											|| (block[i - 1]->assignment->expressions.back()->table->constants.excludedNodes.size() && block[i - 1]->assignment->expressions.back()->table->constants.excludedNodes[j])
+											|| block[i - 1]->assignment->expressions.back()->table->constants.prototype->get_string(block[i - 1]->assignment->expressions.back()->table->constants.nodes[j].key.string) != block[i]->assignment->variables.back().tableIndex->constant->string)
 											continue;
-										if (block[i - 1]->assignment.expressions.back()->table->constants.fields[j].value->constant->type == AST_CONSTANT_NIL)
-											block[i - 1]->assignment.expressions.back()->table->constants.fields.erase(block[i - 1]->assignment.expressions.back()->table->constants.fields.begin() + j);
+
+										if (block[i - 1]->assignment->expressions.back()->table->constants.nodes[j].value.type == Bytecode::BC_KTAB_NIL) {
+											block[i - 1]->assignment->expressions.back()->table->constants.excludedNodes.resize(block[i - 1]->assignment->expressions.back()->table->constants.nodes.size(), false);
+											block[i - 1]->assignment->expressions.back()->table->constants.excludedNodes[j] = true;
+											block[i - 1]->assignment->expressions.back()->table->constants.nodeCount--;
+										}
+
 										break;
 									}
 								}
 
-								block[i - 1]->assignment.expressions.back()->table->fields.emplace_back();
-								block[i - 1]->assignment.expressions.back()->table->fields.back().key = block[i]->assignment.variables.back().tableIndex;
-								block[i - 1]->assignment.expressions.back()->table->fields.back().value = block[i]->assignment.expressions.back();
+								block[i - 1]->assignment->expressions.back()->table->fields.emplace_back();
+								block[i - 1]->assignment->expressions.back()->table->fields.back().key = block[i]->assignment->variables.back().tableIndex;
+								block[i - 1]->assignment->expressions.back()->table->fields.back().value = block[i]->assignment->expressions.back();
 							}
 
-							(*block[i - 1]->assignment.variables.back().slotScope)->usages--;
+							(*block[i - 1]->assignment->variables.back().slotScope)->usages--;
 							block.erase(block.begin() + i);
 							i -= 2;
 							break;
 						}
 
-						if (!block[i]->assignment.variables.back().isMultres && (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1) {
-							block[i]->assignment.variables.back().table = block[i - 1]->assignment.expressions.back();
-							function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
+						if (!block[i]->assignment->variables.back().isMultres && (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1) {
+							block[i]->assignment.create()->variables.back().table = block[i - 1]->assignment->expressions.back();
+							function.slotScopeCollector.remove_scope(block[i - 1]->assignment->variables.back().slot, block[i - 1]->assignment->variables.back().slotScope);
 							block[i]->instruction.label = block[i - 1]->instruction.label;
 							i--;
 							block.erase(block.begin() + i);
@@ -2025,7 +2252,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 						}
 					}
 
-					assert(!block[i]->assignment.variables.back().isMultres, "Unable to eliminate multres table index", bytecode.filePath, DEBUG_INFO);
+					assert(!block[i]->assignment->variables.back().isMultres, "Unable to eliminate multres table index", bytecode.filePath, DEBUG_INFO);
 					break;
 				}
 			}
@@ -2042,6 +2269,7 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 	bool hasBoolConstruct, hasEndAssignment;
 
 	for (uint32_t i = block.size(); i--;) {
+		check_budget();
 		if (block[i]->instruction.id == INVALID_ID) continue;
 		blockInfo.index = i;
 		targetLabel = get_label_from_next_statement(function, blockInfo, false, false);
@@ -2059,12 +2287,12 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 
 				switch (block[index]->type) {
 				case AST_STATEMENT_CONDITION:
-					if (!block[index]->assignment.variables.size()) {
+					if (!block[index]->assignment->variables.size()) {
 						index = INVALID_ID;
 						if (targetLabel == extendedTargetLabel
-							|| (block[index]->assignment.expressions.size() == 1
-								&& block[index]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-								&& block[index]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT))
+							|| (block[index]->assignment->expressions.size() == 1
+								&& block[index]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+								&& block[index]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT))
 							continue;
 					}
 						
@@ -2073,10 +2301,10 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 					if ((block[index + 1]->type == AST_STATEMENT_GOTO
 							|| block[index + 1]->type == AST_STATEMENT_BREAK)
 						&& block[index + 1]->instruction.type == Bytecode::BC_OP_JMP
-						&& block[index]->assignment.variables.size() == 1
-						&& block[index]->assignment.variables.back().type == AST_VARIABLE_SLOT
-						&& block[index]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-						&& get_constant_type(block[index]->assignment.expressions.back()))
+						&& block[index]->assignment->variables.size() == 1
+						&& block[index]->assignment->variables.back().type == AST_VARIABLE_SLOT
+						&& block[index]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+						&& get_constant_type(block[index]->assignment->expressions.back()))
 						break;
 				default:
 					index = INVALID_ID;
@@ -2095,15 +2323,15 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 				|| block[i]->instruction.type != Bytecode::BC_OP_JMP
 				|| block[i]->instruction.target != function.labels[targetLabel].target
 				|| block[i - 1]->type != AST_STATEMENT_ASSIGNMENT
-				|| block[i - 1]->assignment.variables.size() != 1
-				|| block[i - 1]->assignment.variables.back().type != AST_VARIABLE_SLOT
-				|| block[i - 1]->assignment.expressions.back()->type != AST_EXPRESSION_CONSTANT
-				|| !get_constant_type(block[i - 1]->assignment.expressions.back()))
+				|| block[i - 1]->assignment->variables.size() != 1
+				|| block[i - 1]->assignment->variables.back().type != AST_VARIABLE_SLOT
+				|| block[i - 1]->assignment->expressions.back()->type != AST_EXPRESSION_CONSTANT
+				|| !get_constant_type(block[i - 1]->assignment->expressions.back()))
 				continue;
 			assignmentIndex = i - 1;
 			break;
 		case AST_STATEMENT_ASSIGNMENT:
-			if (block[i]->assignment.variables.size() != 1 || block[i]->assignment.variables.back().type != AST_VARIABLE_SLOT) continue;
+			if (block[i]->assignment->variables.size() != 1 || block[i]->assignment->variables.back().type != AST_VARIABLE_SLOT) continue;
 			assignmentIndex = i;
 			break;
 		default:
@@ -2115,22 +2343,22 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 
 		if (i >= 3
 			&& block[i]->type == AST_STATEMENT_ASSIGNMENT
-			&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-			&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_TRUE
+			&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+			&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_TRUE
 			&& (block[i - 1]->type == AST_STATEMENT_GOTO
 				|| block[i - 1]->type == AST_STATEMENT_BREAK)
 			&& !function.is_valid_label(block[i - 1]->instruction.label)
 			&& block[i - 1]->instruction.type == Bytecode::BC_OP_JMP
 			&& block[i - 1]->instruction.target == function.labels[targetLabel].target
 			&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
-			&& block[i - 2]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-			&& block[i - 2]->assignment.expressions.back()->constant->type == AST_CONSTANT_FALSE
-			&& block[i - 2]->assignment.variables.size() == 1
-			&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-			&& block[i - 2]->assignment.variables.back().slot == block[assignmentIndex]->assignment.variables.back().slot) {
+			&& block[i - 2]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+			&& block[i - 2]->assignment->expressions.back()->constant->type == AST_CONSTANT_FALSE
+			&& block[i - 2]->assignment->variables.size() == 1
+			&& block[i - 2]->assignment->variables.back().type == AST_VARIABLE_SLOT
+			&& block[i - 2]->assignment->variables.back().slot == block[assignmentIndex]->assignment->variables.back().slot) {
 			switch (block[i - 3]->type) {
 			case AST_STATEMENT_CONDITION:
-				if (block[i - 3]->assignment.expressions.size() == 2 && block[i - 3]->instruction.target == block[i]->instruction.id) hasBoolConstruct = true;
+				if (block[i - 3]->assignment->expressions.size() == 2 && block[i - 3]->instruction.target == block[i]->instruction.id) hasBoolConstruct = true;
 				break;
 			case AST_STATEMENT_GOTO:
 			case AST_STATEMENT_BREAK:
@@ -2138,7 +2366,7 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 					&& (!function.is_valid_label(block[i - 3]->instruction.label)
 						|| (function.labels[block[i - 3]->instruction.label].jumpIds.size() == 1
 							&& block[i - 4]->type == AST_STATEMENT_CONDITION
-							&& block[i - 4]->assignment.variables.size()))
+							&& block[i - 4]->assignment->variables.size()))
 					&& block[i - 3]->instruction.type == Bytecode::BC_OP_JMP
 					&& block[i - 3]->instruction.target == function.labels[extendedTargetLabel].target
 					&& (function.is_valid_label(block[i]->instruction.label)
@@ -2160,12 +2388,12 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 
 						if (targetIndex == INVALID_ID
 							|| block[targetIndex]->type != AST_STATEMENT_CONDITION
-							|| block[targetIndex]->assignment.variables.size()) {
+							|| block[targetIndex]->assignment->variables.size()) {
 							index = INVALID_ID;
 							break;
 						}
 
-						if (!block[targetIndex]->assignment.expressions.size()) {
+						if (!block[targetIndex]->assignment->expressions.size()) {
 							hasBoolConstruct = false;
 							break;
 						}
@@ -2181,7 +2409,7 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 							break;
 						}
 
-						if (!block[targetIndex]->assignment.expressions.size() || block[targetIndex]->assignment.variables.size()) {
+						if (!block[targetIndex]->assignment->expressions.size() || block[targetIndex]->assignment->variables.size()) {
 							hasBoolConstruct = false;
 							break;
 						}
@@ -2239,15 +2467,15 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 			for (uint32_t k = index; k < targetIndex; k++) {
 				switch (block[k]->type) {
 				case AST_STATEMENT_CONDITION:
-					if (block[k]->assignment.variables.size()) {
+					if (block[k]->assignment->variables.size()) {
 						if (block[k]->instruction.target == function.labels[targetLabel].target
-							&& block[k]->assignment.variables.back().slot == block[assignmentIndex]->assignment.variables.back().slot)
+							&& block[k]->assignment->variables.back().slot == block[assignmentIndex]->assignment->variables.back().slot)
 							continue;
 					} else if (block[k]->instruction.target == function.labels[targetLabel].target
-						&& block[k]->assignment.expressions.size() == 1
-						&& block[k]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-						&& block[k]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
-						&& block[k]->assignment.expressions.back()->variable->slot == block[assignmentIndex]->assignment.variables.back().slot) {
+						&& block[k]->assignment->expressions.size() == 1
+						&& block[k]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+						&& block[k]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT
+						&& block[k]->assignment->expressions.back()->variable->slot == block[assignmentIndex]->assignment->variables.back().slot) {
 						continue;
 					} else if ((block[k]->instruction.target == function.labels[extendedTargetLabel].target
 							&& !hasEndAssignment)
@@ -2258,11 +2486,11 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 
 					break;
 				case AST_STATEMENT_ASSIGNMENT:
-					if (block[k]->assignment.variables.size() == 1
-						&& block[k]->assignment.variables.back().type == AST_VARIABLE_SLOT
-						&& block[k]->assignment.variables.back().slot == block[assignmentIndex]->assignment.variables.back().slot
-						&& block[k]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-						&& get_constant_type(block[k]->assignment.expressions.back())
+					if (block[k]->assignment->variables.size() == 1
+						&& block[k]->assignment->variables.back().type == AST_VARIABLE_SLOT
+						&& block[k]->assignment->variables.back().slot == block[assignmentIndex]->assignment->variables.back().slot
+						&& block[k]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+						&& get_constant_type(block[k]->assignment->expressions.back())
 						&& ++k != targetIndex
 						&& (block[k]->type == AST_STATEMENT_GOTO
 							|| block[k]->type == AST_STATEMENT_BREAK)
@@ -2290,31 +2518,31 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 		for (uint32_t j = index; j < targetIndex; j++) {
 			switch (block[j]->type) {
 			case AST_STATEMENT_CONDITION:
-				conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->condition.swapped), block[j]->instruction.label,
+				conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->assignment->condition.swapped), block[j]->instruction.label,
 					hasEndAssignment
-					|| block[j]->assignment.variables.size()
+					|| block[j]->assignment->variables.size()
 					|| (block[j]->instruction.target == function.labels[targetLabel].target
 						? targetLabel != extendedTargetLabel
 						//TODO
-						|| (block[j]->assignment.expressions.size() == 1
-							&& block[j]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-							&& block[j]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
-							&& block[j]->assignment.expressions.back()->variable->slot == block[assignmentIndex]->assignment.variables.back().slot)
+						|| (block[j]->assignment->expressions.size() == 1
+							&& block[j]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+							&& block[j]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT
+							&& block[j]->assignment->expressions.back()->variable->slot == block[assignmentIndex]->assignment->variables.back().slot)
 						: block[j]->instruction.target != function.labels[extendedTargetLabel].target)
-					? function.get_label_from_id(block[j]->instruction.target) : function.labels.size(), &block[j]->assignment.expressions);
+					? function.get_label_from_id(block[j]->instruction.target) : function.labels.size(), &block[j]->assignment->expressions);
 				continue;
 			case AST_STATEMENT_ASSIGNMENT:
-				switch (block[j]->assignment.expressions.back()->constant->type) {
+				switch (block[j]->assignment->expressions.back()->constant->type) {
 				case AST_CONSTANT_NIL:
 				case AST_CONSTANT_FALSE:
 					conditionBuilder.add_node(ConditionBuilder::Node::FALSY_TEST, block[j]->instruction.label,
-						function.get_label_from_id(block[j + 1]->instruction.target), &block[j]->assignment.expressions);
+						function.get_label_from_id(block[j + 1]->instruction.target), &block[j]->assignment->expressions);
 					break;
 				case AST_CONSTANT_TRUE:
 				case AST_CONSTANT_STRING:
 				case AST_CONSTANT_NUMBER:
 					conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[j]->instruction.label,
-						function.get_label_from_id(block[j + 1]->instruction.target), &block[j]->assignment.expressions);
+						function.get_label_from_id(block[j + 1]->instruction.target), &block[j]->assignment->expressions);
 					break;
 				}
 
@@ -2325,36 +2553,36 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 
 		if (hasEndAssignment) {
 			if (!hasBoolConstruct) {
-				conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i]->instruction.label, targetLabel, &block[i]->assignment.expressions);
+				conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i]->instruction.label, targetLabel, &block[i]->assignment->expressions);
 			} else if (block[i - 3]->type == AST_STATEMENT_GOTO) {
-				conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i - 4]->instruction.label, targetLabel, &block[i - 4]->assignment.expressions);
+				conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, block[i - 4]->instruction.label, targetLabel, &block[i - 4]->assignment->expressions);
 			}
 		} else {
-			expressions.back() = new_slot(block[assignmentIndex]->assignment.variables.back().slot);
-			expressions.back()->variable->slotScope = block[assignmentIndex]->assignment.variables.back().slotScope;
+			expressions.back() = new_slot(block[assignmentIndex]->assignment->variables.back().slot);
+			expressions.back()->variable->slotScope = block[assignmentIndex]->assignment->variables.back().slotScope;
 			conditionBuilder.add_node(ConditionBuilder::Node::TRUTHY_TEST, function.labels.size(), targetLabel, &expressions);
 		}
 		
 		expressions.back() = conditionBuilder.build_condition();
 		if (!expressions.back()) continue;
-		block[assignmentIndex]->assignment.expressions.back() = expressions.back();
+		block[assignmentIndex]->assignment.create()->expressions.back() = expressions.back();
 
 		for (uint32_t j = index; j <= i; j++) {
 			switch (block[j]->type) {
 			case AST_STATEMENT_CONDITION:
 				function.remove_jump(block[j]->instruction.id + 1, block[j]->instruction.target);
-				if (!block[j]->assignment.variables.size()) continue;
+				if (!block[j]->assignment->variables.size()) continue;
 				function.remove_jump(block[j]->instruction.id, block[j]->instruction.id + 2);
 			case AST_STATEMENT_ASSIGNMENT:
-				if (*block[j]->assignment.variables.back().slotScope != *block[assignmentIndex]->assignment.variables.back().slotScope) {
-					(*block[assignmentIndex]->assignment.variables.back().slotScope)->usages += (*block[j]->assignment.variables.back().slotScope)->usages;
-					if ((*block[j]->assignment.variables.back().slotScope)->scopeBegin < (*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeBegin)
-						(*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeBegin = (*block[j]->assignment.variables.back().slotScope)->scopeBegin;
-					if ((*block[j]->assignment.variables.back().slotScope)->scopeEnd > (*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeEnd)
-						(*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeEnd = (*block[j]->assignment.variables.back().slotScope)->scopeEnd;
-					*block[j]->assignment.variables.back().slotScope = *block[assignmentIndex]->assignment.variables.back().slotScope;
-					if (block[j]->assignment.variables.back().slotScope != block[assignmentIndex]->assignment.variables.back().slotScope)
-						function.slotScopeCollector.remove_scope(block[j]->assignment.variables.back().slot, block[j]->assignment.variables.back().slotScope);
+				if (block[j]->assignment->variables.back().slotScope->find() != block[assignmentIndex]->assignment->variables.back().slotScope->find()) {
+					(*block[assignmentIndex]->assignment->variables.back().slotScope)->usages += (*block[j]->assignment->variables.back().slotScope)->usages;
+					if ((*block[j]->assignment->variables.back().slotScope)->scopeBegin < (*block[assignmentIndex]->assignment->variables.back().slotScope)->scopeBegin)
+						(*block[assignmentIndex]->assignment->variables.back().slotScope)->scopeBegin = (*block[j]->assignment->variables.back().slotScope)->scopeBegin;
+					if ((*block[j]->assignment->variables.back().slotScope)->scopeEnd > (*block[assignmentIndex]->assignment->variables.back().slotScope)->scopeEnd)
+						(*block[assignmentIndex]->assignment->variables.back().slotScope)->scopeEnd = (*block[j]->assignment->variables.back().slotScope)->scopeEnd;
+					function.slotScopeCollector.merge_scope(block[assignmentIndex]->assignment->variables.back().slotScope, block[j]->assignment->variables.back().slotScope);
+					if (block[j]->assignment->variables.back().slotScope != block[assignmentIndex]->assignment->variables.back().slotScope)
+						function.slotScopeCollector.remove_scope(block[j]->assignment->variables.back().slot, block[j]->assignment->variables.back().slotScope);
 				}
 
 				continue;
@@ -2368,12 +2596,13 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 		block[i] = block[assignmentIndex];
 		block[i]->type = AST_STATEMENT_ASSIGNMENT;
 		block[i]->instruction.label = block[index]->instruction.label;
-		if ((*block[i]->assignment.variables.back().slotScope)->scopeBegin >= block[index]->instruction.id) block[i]->assignment.forwardDeclaration = true;
+		if ((*block[i]->assignment->variables.back().slotScope)->scopeBegin >= block[index]->instruction.id) block[i]->assignment.create()->forwardDeclaration = true;
 		block.erase(block.begin() + index, block.begin() + i);
 		i = index;
 	}
 
 	for (uint32_t i = block.size(); i--;) {
+		check_budget();
 		switch (block[i]->type) {
 		case AST_STATEMENT_CONDITION:
 			blockInfo.index = i;
@@ -2432,14 +2661,14 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 				ConditionBuilder conditionBuilder(ConditionBuilder::STATEMENT, *this, INVALID_ID, targetLabel, extendedTargetLabel);
 
 				for (uint32_t j = index; j <= i; j++) {
-					assert(!block[j]->assignment.variables.size(), "Failed to eliminate all test and copy conditions", bytecode.filePath, DEBUG_INFO);
-					conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->condition.swapped),
-						block[j]->instruction.label, function.get_label_from_id(block[j]->instruction.target), &block[j]->assignment.expressions);
+					assert(!block[j]->assignment->variables.size(), "Failed to eliminate all test and copy conditions", bytecode.filePath, DEBUG_INFO);
+					conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->assignment->condition.swapped),
+						block[j]->instruction.label, function.get_label_from_id(block[j]->instruction.target), &block[j]->assignment->expressions);
 				}
 
 				expressions.back() = conditionBuilder.build_condition();
 				assert(expressions.back(), "Failed to build condition", bytecode.filePath, DEBUG_INFO);
-				block[i]->assignment.expressions = expressions;
+				block[i]->assignment.create()->expressions = expressions;
 
 				for (uint32_t j = index; j <= i; j++) {
 					function.remove_jump(block[j]->instruction.id + 1, block[j]->instruction.target);
@@ -2454,17 +2683,17 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 
 			if (i
 				&& block[i]->instruction.type == Bytecode::BC_OP_JMP
-				&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-				&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_FALSE
+				&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+				&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_FALSE
 				&& !function.is_valid_label(block[i]->instruction.label)
 				&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-				&& block[i - 1]->assignment.variables.size() == 1
-				&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& block[i - 1]->assignment.expressions.size() == 1
-				&& get_constant_type(block[i - 1]->assignment.expressions.back())) {
+				&& block[i - 1]->assignment->variables.size() == 1
+				&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+				&& block[i - 1]->assignment->expressions.size() == 1
+				&& get_constant_type(block[i - 1]->assignment->expressions.back())) {
 				//TODO
 				function.remove_jump(block[i]->instruction.id, block[i]->instruction.target);
-				block[i]->assignment.expressions.clear();
+				block[i]->assignment.create()->expressions.clear();
 				block[i]->type = AST_STATEMENT_GOTO;
 				block.emplace(block.begin() + i, new_statement(AST_STATEMENT_GOTO));
 				block[i]->instruction.type = Bytecode::BC_OP_JMP;
@@ -2479,12 +2708,12 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 			continue;
 		case AST_STATEMENT_NUMERIC_FOR:
 		case AST_STATEMENT_GENERIC_FOR:
-			eliminate_conditions(function, block[i]->block, nullptr);
+			eliminate_conditions(function, *block[i]->block.create(), nullptr);
 			continue;
 		case AST_STATEMENT_LOOP:
 		case AST_STATEMENT_DECLARATION:
 			blockInfo.index = i;
-			eliminate_conditions(function, block[i]->block, &blockInfo);
+			eliminate_conditions(function, *block[i]->block.create(), &blockInfo);
 			continue;
 		}
 	}
@@ -2499,25 +2728,25 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 	for (uint32_t i = block.size(); i--;) {
 		switch (block[i]->type) {
 		case AST_STATEMENT_ASSIGNMENT:
-			if (block[i]->assignment.variables.size() >= 2) {
-				if (i + block[i]->assignment.variables.size() >= block.size()) continue;
+			if (block[i]->assignment->variables.size() >= 2) {
+				if (i + block[i]->assignment->variables.size() >= block.size()) continue;
 				isMultiAssignment = true;
 
-				for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-					if ((*block[i]->assignment.variables[j].slotScope)->usages == 1
-						&& !function.is_valid_label(block[i + block[i]->assignment.variables.size() - j]->instruction.label)
-						&& block[i + block[i]->assignment.variables.size() - j]->type == AST_STATEMENT_ASSIGNMENT
-						&& block[i + block[i]->assignment.variables.size() - j]->assignment.variables.size() == 1
-						&& (block[i + block[i]->assignment.variables.size() - j]->assignment.variables.back().type != AST_VARIABLE_TABLE_INDEX
-							|| (block[i + block[i]->assignment.variables.size() - j]->assignment.variables.back().table->type == AST_EXPRESSION_VARIABLE
-								&& block[i + block[i]->assignment.variables.size() - j]->assignment.variables.back().table->variable->type == AST_VARIABLE_SLOT
-								&& (get_constant_type(block[i + block[i]->assignment.variables.size() - j]->assignment.variables.back().tableIndex)
-									|| (block[i + block[i]->assignment.variables.size() - j]->assignment.variables.back().tableIndex->type == AST_EXPRESSION_VARIABLE
-										&& block[i + block[i]->assignment.variables.size() - j]->assignment.variables.back().tableIndex->variable->type == AST_VARIABLE_SLOT))))
-						&& block[i + block[i]->assignment.variables.size() - j]->assignment.expressions.size() == 1
-						&& block[i + block[i]->assignment.variables.size() - j]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-						&& block[i + block[i]->assignment.variables.size() - j]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
-						&& block[i + block[i]->assignment.variables.size() - j]->assignment.expressions.back()->variable->slotScope == block[i]->assignment.variables[j].slotScope)
+				for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+					if ((*block[i]->assignment->variables[j].slotScope)->usages == 1
+						&& !function.is_valid_label(block[i + block[i]->assignment->variables.size() - j]->instruction.label)
+						&& block[i + block[i]->assignment->variables.size() - j]->type == AST_STATEMENT_ASSIGNMENT
+						&& block[i + block[i]->assignment->variables.size() - j]->assignment->variables.size() == 1
+						&& (block[i + block[i]->assignment->variables.size() - j]->assignment->variables.back().type != AST_VARIABLE_TABLE_INDEX
+							|| (block[i + block[i]->assignment->variables.size() - j]->assignment->variables.back().table->type == AST_EXPRESSION_VARIABLE
+								&& block[i + block[i]->assignment->variables.size() - j]->assignment->variables.back().table->variable->type == AST_VARIABLE_SLOT
+								&& (get_constant_type(block[i + block[i]->assignment->variables.size() - j]->assignment->variables.back().tableIndex)
+									|| (block[i + block[i]->assignment->variables.size() - j]->assignment->variables.back().tableIndex->type == AST_EXPRESSION_VARIABLE
+										&& block[i + block[i]->assignment->variables.size() - j]->assignment->variables.back().tableIndex->variable->type == AST_VARIABLE_SLOT))))
+						&& block[i + block[i]->assignment->variables.size() - j]->assignment->expressions.size() == 1
+						&& block[i + block[i]->assignment->variables.size() - j]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+						&& block[i + block[i]->assignment->variables.size() - j]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT
+						&& block[i + block[i]->assignment->variables.size() - j]->assignment->expressions.back()->variable->slotScope == block[i]->assignment->variables[j].slotScope)
 						continue;
 					isMultiAssignment = false;
 					break;
@@ -2525,9 +2754,9 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 
 				if (!isMultiAssignment) continue;
 
-				for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-					function.slotScopeCollector.remove_scope(block[i]->assignment.variables[j].slot, block[i]->assignment.variables[j].slotScope);
-					block[i]->assignment.variables[j] = block[i + 1]->assignment.variables.back();
+				for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+					function.slotScopeCollector.remove_scope(block[i]->assignment->variables[j].slot, block[i]->assignment->variables[j].slotScope);
+					block[i]->assignment.create()->variables[j] = block[i + 1]->assignment->variables.back();
 					block.erase(block.begin() + i + 1);
 				}
 
@@ -2537,16 +2766,16 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 			index = i;
 
 			if (block[i]->type == AST_STATEMENT_FUNCTION_CALL
-				|| (block[i]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& !(*block[i]->assignment.variables.back().slotScope)->usages
-					&& !block[i]->assignment.forwardDeclaration)) {
+				|| (block[i]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& !(*block[i]->assignment->variables.back().slotScope)->usages
+					&& !block[i]->assignment->forwardDeclaration)) {
 				while (index
 					&& !function.is_valid_label(block[index]->instruction.label)
 					&& block[index - 1]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[index - 1]->assignment.variables.size() == 1
-					&& block[index - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& !(*block[index - 1]->assignment.variables.back().slotScope)->usages
-					&& !block[index - 1]->assignment.forwardDeclaration) {
+					&& block[index - 1]->assignment->variables.size() == 1
+					&& block[index - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+					&& !(*block[index - 1]->assignment->variables.back().slotScope)->usages
+					&& !block[index - 1]->assignment->forwardDeclaration) {
 					index--;
 				}
 			}
@@ -2556,37 +2785,37 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				&& !function.is_valid_label(block[index]->instruction.label)
 				&& !function.is_valid_label(block[i + 1]->instruction.label)
 				&& block[index - 1]->type == AST_STATEMENT_ASSIGNMENT
-				&& block[index - 1]->assignment.variables.size() == 1
-				&& block[index - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& (*block[index - 1]->assignment.variables.back().slotScope)->usages == 1
+				&& block[index - 1]->assignment->variables.size() == 1
+				&& block[index - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+				&& (*block[index - 1]->assignment->variables.back().slotScope)->usages == 1
 				&& block[i + 1]->type == AST_STATEMENT_ASSIGNMENT
-				&& block[i + 1]->assignment.variables.size() == 1
-				&& (block[i + 1]->assignment.variables.back().type != AST_VARIABLE_TABLE_INDEX
-					|| (block[i + 1]->assignment.variables.back().table->type == AST_EXPRESSION_VARIABLE
-						&& block[i + 1]->assignment.variables.back().table->variable->type == AST_VARIABLE_SLOT
-						&& (get_constant_type(block[i + 1]->assignment.variables.back().tableIndex)
-							|| (block[i + 1]->assignment.variables.back().tableIndex->type == AST_EXPRESSION_VARIABLE
-								&& block[i + 1]->assignment.variables.back().tableIndex->variable->type == AST_VARIABLE_SLOT))))
-				&& block[i + 1]->assignment.expressions.size() == 1
-				&& block[i + 1]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-				&& block[i + 1]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
-				&& block[i + 1]->assignment.expressions.back()->variable->slotScope == block[index - 1]->assignment.variables.back().slotScope) {
+				&& block[i + 1]->assignment->variables.size() == 1
+				&& (block[i + 1]->assignment->variables.back().type != AST_VARIABLE_TABLE_INDEX
+					|| (block[i + 1]->assignment->variables.back().table->type == AST_EXPRESSION_VARIABLE
+						&& block[i + 1]->assignment->variables.back().table->variable->type == AST_VARIABLE_SLOT
+						&& (get_constant_type(block[i + 1]->assignment->variables.back().tableIndex)
+							|| (block[i + 1]->assignment->variables.back().tableIndex->type == AST_EXPRESSION_VARIABLE
+								&& block[i + 1]->assignment->variables.back().tableIndex->variable->type == AST_VARIABLE_SLOT))))
+				&& block[i + 1]->assignment->expressions.size() == 1
+				&& block[i + 1]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+				&& block[i + 1]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT
+				&& block[i + 1]->assignment->expressions.back()->variable->slotScope == block[index - 1]->assignment->variables.back().slotScope) {
 				if (block[i]->type == AST_STATEMENT_ASSIGNMENT) {
-					switch (block[i]->assignment.variables.back().type) {
+					switch (block[i]->assignment->variables.back().type) {
 					case AST_VARIABLE_SLOT:
-						if (!(*block[i]->assignment.variables.back().slotScope)->usages && !block[i]->assignment.forwardDeclaration) {
-							function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
-							block[i]->assignment.variables.clear();
+						if (!(*block[i]->assignment->variables.back().slotScope)->usages && !block[i]->assignment->forwardDeclaration) {
+							function.slotScopeCollector.remove_scope(block[i]->assignment->variables.back().slot, block[i]->assignment->variables.back().slotScope);
+							block[i]->assignment.create()->variables.clear();
 						}
 
 						break;
 					case AST_VARIABLE_TABLE_INDEX:
 						if (index == i
-							&& (block[i]->assignment.variables.back().table->type != AST_EXPRESSION_VARIABLE
-								|| block[i]->assignment.variables.back().table->variable->type != AST_VARIABLE_SLOT
-								|| (!get_constant_type(block[i]->assignment.variables.back().tableIndex)
-									&& (block[i]->assignment.variables.back().tableIndex->type != AST_EXPRESSION_VARIABLE
-										|| block[i]->assignment.variables.back().tableIndex->variable->type != AST_VARIABLE_SLOT))))
+							&& (block[i]->assignment->variables.back().table->type != AST_EXPRESSION_VARIABLE
+								|| block[i]->assignment->variables.back().table->variable->type != AST_VARIABLE_SLOT
+								|| (!get_constant_type(block[i]->assignment->variables.back().tableIndex)
+									&& (block[i]->assignment->variables.back().tableIndex->type != AST_EXPRESSION_VARIABLE
+										|| block[i]->assignment->variables.back().tableIndex->variable->type != AST_VARIABLE_SLOT))))
 							continue;
 						break;
 					}
@@ -2596,21 +2825,21 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 
 				while (i != index) {
 					i--;
-					function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
-					block[i + 1]->assignment.expressions.emplace(block[i + 1]->assignment.expressions.begin(), block[i]->assignment.expressions.back());
+					function.slotScopeCollector.remove_scope(block[i]->assignment->variables.back().slot, block[i]->assignment->variables.back().slotScope);
+					block[i + 1]->assignment.create()->expressions.emplace(block[i + 1]->assignment->expressions.begin(), block[i]->assignment->expressions.back());
 					block.erase(block.begin() + i);
 				}
 
 				break;
 			}
 
-			if (block[i]->type == AST_STATEMENT_FUNCTION_CALL && block[i]->assignment.expressions.back()->type == AST_EXPRESSION_VARARG) {
+			if (block[i]->type == AST_STATEMENT_FUNCTION_CALL && block[i]->assignment->expressions.back()->type == AST_EXPRESSION_VARARG) {
 				assert(i
 					&& !function.is_valid_label(block[i]->instruction.label)
 					&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-					&& block[i - 1]->assignment.variables.size() == 1,
+					&& block[i - 1]->assignment->variables.size() == 1,
 					"Unable to eliminate vararg with zero returns", bytecode.filePath, DEBUG_INFO);
-				block[i - 1]->assignment.expressions.emplace_back(block[i]->assignment.expressions.back());
+				block[i - 1]->assignment.create()->expressions.emplace_back(block[i]->assignment->expressions.back());
 				block.erase(block.begin() + i);
 				i--;
 			}
@@ -2623,44 +2852,44 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 			&& !function.is_valid_label(block[i]->instruction.label)
 			&& !function.is_valid_label(block[i + 1]->instruction.label)
 			&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-			&& block[i - 1]->assignment.variables.size() == 1
-			&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-			&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
+			&& block[i - 1]->assignment->variables.size() == 1
+			&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+			&& (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1
 			&& block[i + 1]->type == AST_STATEMENT_ASSIGNMENT
-			&& block[i + 1]->assignment.variables.size() == 1
-			&& (block[i + 1]->assignment.variables.back().type != AST_VARIABLE_TABLE_INDEX
-				|| (block[i + 1]->assignment.variables.back().table->type == AST_EXPRESSION_VARIABLE
-					&& block[i + 1]->assignment.variables.back().table->variable->type == AST_VARIABLE_SLOT
-					&& (get_constant_type(block[i + 1]->assignment.variables.back().tableIndex)
-						|| (block[i + 1]->assignment.variables.back().tableIndex->type == AST_EXPRESSION_VARIABLE
-							&& block[i + 1]->assignment.variables.back().tableIndex->variable->type == AST_VARIABLE_SLOT))))
-			&& block[i + 1]->assignment.expressions.size() == 1
-			&& block[i + 1]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
-			&& block[i + 1]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
-			&& block[i + 1]->assignment.expressions.back()->variable->slotScope == block[i - 1]->assignment.variables.back().slotScope) {
-			function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
-			block[i]->assignment.expressions.emplace(block[i]->assignment.expressions.begin(), block[i - 1]->assignment.expressions.back());
-			block[i]->assignment.variables.emplace(block[i]->assignment.variables.begin(), block[i + 1]->assignment.variables.back());
+			&& block[i + 1]->assignment->variables.size() == 1
+			&& (block[i + 1]->assignment->variables.back().type != AST_VARIABLE_TABLE_INDEX
+				|| (block[i + 1]->assignment->variables.back().table->type == AST_EXPRESSION_VARIABLE
+					&& block[i + 1]->assignment->variables.back().table->variable->type == AST_VARIABLE_SLOT
+					&& (get_constant_type(block[i + 1]->assignment->variables.back().tableIndex)
+						|| (block[i + 1]->assignment->variables.back().tableIndex->type == AST_EXPRESSION_VARIABLE
+							&& block[i + 1]->assignment->variables.back().tableIndex->variable->type == AST_VARIABLE_SLOT))))
+			&& block[i + 1]->assignment->expressions.size() == 1
+			&& block[i + 1]->assignment->expressions.back()->type == AST_EXPRESSION_VARIABLE
+			&& block[i + 1]->assignment->expressions.back()->variable->type == AST_VARIABLE_SLOT
+			&& block[i + 1]->assignment->expressions.back()->variable->slotScope == block[i - 1]->assignment->variables.back().slotScope) {
+			function.slotScopeCollector.remove_scope(block[i - 1]->assignment->variables.back().slot, block[i - 1]->assignment->variables.back().slotScope);
+			block[i]->assignment.create()->expressions.emplace(block[i]->assignment->expressions.begin(), block[i - 1]->assignment->expressions.back());
+			block[i]->assignment.create()->variables.emplace(block[i]->assignment->variables.begin(), block[i + 1]->assignment->variables.back());
 			block[i]->instruction.label = block[i - 1]->instruction.label;
 			block.erase(block.begin() + i - 1);
 			block.erase(block.begin() + i);
 			i--;
 		}
 
-		for (uint8_t j = block[i]->assignment.variables.size(); j--
+		for (uint8_t j = block[i]->assignment->variables.size(); j--
 			&& i
 			&& !function.is_valid_label(block[i]->instruction.label)
 			&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
-			&& block[i - 1]->assignment.variables.size() == 1
-			&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-			&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1;) {
-			if (block[i]->assignment.variables[j].type != AST_VARIABLE_TABLE_INDEX) continue;
-
-			if (block[i]->assignment.variables[j].tableIndex->type == AST_EXPRESSION_VARIABLE
-				&& block[i]->assignment.variables[j].tableIndex->variable->type == AST_VARIABLE_SLOT
-				&& block[i]->assignment.variables[j].tableIndex->variable->slotScope == block[i - 1]->assignment.variables.back().slotScope) {
-				function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
-				block[i]->assignment.variables[j].tableIndex = block[i - 1]->assignment.expressions.back();
+			&& block[i - 1]->assignment->variables.size() == 1
+			&& block[i - 1]->assignment->variables.back().type == AST_VARIABLE_SLOT
+			&& (*block[i - 1]->assignment->variables.back().slotScope)->usages == 1;) {
+			if (block[i]->assignment->variables[j].type != AST_VARIABLE_TABLE_INDEX) continue;
+
+			if (block[i]->assignment->variables[j].tableIndex->type == AST_EXPRESSION_VARIABLE
+				&& block[i]->assignment->variables[j].tableIndex->variable->type == AST_VARIABLE_SLOT
+				&& block[i]->assignment->variables[j].tableIndex->variable->slotScope == block[i - 1]->assignment->variables.back().slotScope) {
+				function.slotScopeCollector.remove_scope(block[i - 1]->assignment->variables.back().slot, block[i - 1]->assignment->variables.back().slotScope);
+				block[i]->assignment.create()->variables[j].tableIndex = block[i - 1]->assignment->expressions.back();
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
 				block.erase(block.begin() + i);
@@ -2668,9 +2897,9 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				continue;
 			}
 
-			if (block[i]->assignment.variables[j].table->type == AST_EXPRESSION_VARIABLE && block[i]->assignment.variables[j].table->variable->slotScope == block[i - 1]->assignment.variables.back().slotScope) {
-				function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
-				block[i]->assignment.variables[j].table = block[i - 1]->assignment.expressions.back();
+			if (block[i]->assignment->variables[j].table->type == AST_EXPRESSION_VARIABLE && block[i]->assignment->variables[j].table->variable->slotScope == block[i - 1]->assignment->variables.back().slotScope) {
+				function.slotScopeCollector.remove_scope(block[i - 1]->assignment->variables.back().slot, block[i - 1]->assignment->variables.back().slotScope);
+				block[i]->assignment.create()->variables[j].table = block[i - 1]->assignment->expressions.back();
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
 				block.erase(block.begin() + i);
@@ -2679,17 +2908,18 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 	}
 }
 
-void Ast::build_if_statements_from_map(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock, std::unordered_map<Statement*, uint32_t>& offsetMap) {
+void Ast::build_if_statements_from_offsets(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock) {
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 	uint32_t index;
 
 	for (uint32_t i = 0; i < block.size(); i++) {
+		check_budget();
 		switch (block[i]->type) {
 		case AST_STATEMENT_GOTO:
-			if (!offsetMap.contains(block[i])) continue;
+			if (!function.has_block_offset(block[i])) continue;
 		case AST_STATEMENT_CONDITION:
 			function.remove_jump(block[i]->instruction.id, block[i]->instruction.target);
-			index = offsetMap[block[i]] + i;
+			index = function.get_block_offset(block[i]) + i;
 
 			if (block[i]->type == AST_STATEMENT_GOTO && block[i]->instruction.type == Bytecode::BC_OP_JMP) {
 				block[i]->type = AST_STATEMENT_EMPTY;
@@ -2700,38 +2930,38 @@ void Ast::build_if_statements_from_map(Function& function, std::vector<Statement
 				block[i - 1]->instruction.id = INVALID_ID;
 			}
 
-			block[i]->block.reserve(index - i);
-			block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + index + 1);
+			reserve_block(*block[i], index - i);
+			block[i]->block.create()->insert(block[i]->block->begin(), block.begin() + i + 1, block.begin() + index + 1);
 			block.erase(block.begin() + i + 1, block.begin() + index + 1);
 
 			if (block[i]->type == AST_STATEMENT_CONDITION
-				&& block[i]->block.size()
-				&& block[i]->block.back()->type == AST_STATEMENT_GOTO
-				&& block[i]->block.back()->instruction.type != Bytecode::BC_OP_LOOP) {
-				index = offsetMap[block[i]->block.back()] + i;
+				&& block[i]->block->size()
+				&& block[i]->block->back()->type == AST_STATEMENT_GOTO
+				&& block[i]->block->back()->instruction.type != Bytecode::BC_OP_LOOP) {
+				index = function.get_block_offset(block[i]->block->back()) + i;
 				block.emplace(block.begin() + i + 1, new_statement(AST_STATEMENT_ELSE));
-				block[i + 1]->block.reserve(index - i);
-				block[i + 1]->block.insert(block[i + 1]->block.begin(), block.begin() + i + 2, block.begin() + index + 2);
+				reserve_block(*block[i + 1], index - i);
+				block[i + 1]->block.create()->insert(block[i + 1]->block->begin(), block.begin() + i + 2, block.begin() + index + 2);
 				block.erase(block.begin() + i + 2, block.begin() + index + 2);
-				function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
-				block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+				function.remove_jump(block[i]->block->back()->instruction.id, block[i]->block->back()->instruction.target);
+				block[i]->block->back()->type = AST_STATEMENT_EMPTY;
 				blockInfo.index = i + 1;
-				build_if_statements_from_map(function, block[i + 1]->block, &blockInfo, offsetMap);
+				build_if_statements_from_offsets(function, *block[i + 1]->block.create(), &blockInfo);
 			}
 
-			if (block[i]->type == AST_STATEMENT_GOTO) block[i]->assignment.expressions.emplace_back(new_primitive(1));
+			if (block[i]->type == AST_STATEMENT_GOTO) block[i]->assignment.create()->expressions.emplace_back(new_primitive(1));
 			block[i]->type = AST_STATEMENT_IF;
 			blockInfo.index = i;
-			build_if_statements_from_map(function, block[i]->block, &blockInfo, offsetMap);
+			build_if_statements_from_offsets(function, *block[i]->block.create(), &blockInfo);
 			continue;
 		case AST_STATEMENT_NUMERIC_FOR:
 		case AST_STATEMENT_GENERIC_FOR:
-			build_if_statements(function, block[i]->block, nullptr);
+			build_if_statements(function, *block[i]->block.create(), nullptr);
 			continue;
 		case AST_STATEMENT_LOOP:
 		case AST_STATEMENT_DECLARATION:
 			blockInfo.index = i;
-			build_if_statements(function, block[i]->block, &blockInfo);
+			build_if_statements(function, *block[i]->block.create(), &blockInfo);
 			continue;
 		}
 	}
@@ -2769,9 +2999,9 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 				block[i]->type = AST_STATEMENT_IF;
 			}
 
-			block[i]->assignment.expressions.emplace_back(new_primitive(1));
-			block[i]->block.reserve(index - i);
-			block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + index + 1);
+			block[i]->assignment.create()->expressions.emplace_back(new_primitive(1));
+			reserve_block(*block[i], index - i);
+			block[i]->block.create()->insert(block[i]->block->begin(), block.begin() + i + 1, block.begin() + index + 1);
 			block.erase(block.begin() + i + 1, block.begin() + index + 1);
 		}
 	};
@@ -2783,43 +3013,43 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 		for (uint32_t i = block.size(); i--;) {
 			if (block[i]->type != AST_STATEMENT_IF) continue;
 
-			if (block[i]->block.size()
-				&& block[i]->block.back()->type == AST_STATEMENT_GOTO
-				&& block[i]->block.back()->instruction.type != Bytecode::BC_OP_LOOP) {
+			if (block[i]->block->size()
+				&& block[i]->block->back()->type == AST_STATEMENT_GOTO
+				&& block[i]->block->back()->instruction.type != Bytecode::BC_OP_LOOP) {
 				targetLabel = INVALID_ID;
 
 				for (index = i; index < block.size(); index++) {
 					blockInfo.index = index;
 					targetLabel = get_label_from_next_statement(function, blockInfo, false, false);
-					if (targetLabel == INVALID_ID || function.labels[targetLabel].target != block[i]->block.back()->instruction.target) targetLabel = get_label_from_next_statement(function, blockInfo, true, false);
+					if (targetLabel == INVALID_ID || function.labels[targetLabel].target != block[i]->block->back()->instruction.target) targetLabel = get_label_from_next_statement(function, blockInfo, true, false);
 					if (targetLabel == INVALID_ID) continue;
-					if (function.labels[targetLabel].target == block[i]->block.back()->instruction.target && is_valid_block(function, blockInfo, block[i]->block.back()->instruction.id + 1)) break;
+					if (function.labels[targetLabel].target == block[i]->block->back()->instruction.target && is_valid_block(function, blockInfo, block[i]->block->back()->instruction.id + 1)) break;
 					targetLabel = INVALID_ID;
 				}
 
 				if (targetLabel != INVALID_ID) {
 					block.emplace(block.begin() + i + 1, new_statement(AST_STATEMENT_ELSE));
-					block[i + 1]->block.reserve(index - i);
-					block[i + 1]->block.insert(block[i + 1]->block.begin(), block.begin() + i + 2, block.begin() + index + 2);
+					reserve_block(*block[i + 1], index - i);
+					block[i + 1]->block.create()->insert(block[i + 1]->block->begin(), block.begin() + i + 2, block.begin() + index + 2);
 					block.erase(block.begin() + i + 2, block.begin() + index + 2);
-					function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
-					block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+					function.remove_jump(block[i]->block->back()->instruction.id, block[i]->block->back()->instruction.target);
+					block[i]->block->back()->type = AST_STATEMENT_EMPTY;
 					blockInfo.index = i + 1;
-					build_if_false_statements(block[i + 1]->block, &blockInfo);
-					build_if_false_statements(block[i]->block, nullptr);
+					build_if_false_statements(*block[i + 1]->block.create(), &blockInfo);
+					build_if_false_statements(*block[i]->block.create(), nullptr);
 					continue;
 				}
 			}
 
 			blockInfo.index = i;
-			build_if_false_statements(block[i]->block, &blockInfo);
+			build_if_false_statements(*block[i]->block.create(), &blockInfo);
 		}
 	};
 
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 	uint32_t index, targetLabel;
 	std::vector<uint32_t> indexes;
-	std::unordered_map<Statement*, uint32_t> offsetMap;
+	const uint32_t offsetBase = function.blockOffsets.size();
 
 	for (uint32_t i = 0; i < block.size(); i++) {
 		if (indexes.size()
@@ -2832,7 +3062,7 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 			if (targetLabel != INVALID_ID
 				&& function.labels[targetLabel].target == block[indexes.back()]->instruction.target
 				&& is_valid_block(function, blockInfo, block[indexes.back()]->instruction.id + (block[indexes.back()]->type == AST_STATEMENT_CONDITION ? 2 : 1))) {
-				offsetMap.emplace(block[indexes.back()], i - indexes.back());
+				function.add_block_offset(block[indexes.back()], i - indexes.back());
 
 				if (i - indexes.back()
 					&& block[indexes.back()]->type == AST_STATEMENT_CONDITION
@@ -2844,7 +3074,7 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 					continue;
 				}
 
-				if (indexes.size() >= 2 && offsetMap.contains(block[indexes[indexes.size() - 2]])) {
+				if (indexes.size() >= 2 && function.has_block_offset(block[indexes[indexes.size() - 2]])) {
 					indexes.pop_back();
 					function.add_jump(block[indexes.back()]->instruction.id, block[indexes.back()]->instruction.target);
 				}
@@ -2861,7 +3091,7 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 		case AST_STATEMENT_GOTO:
 			if (block[i]->instruction.type == Bytecode::BC_OP_LOOP) continue;
 		case AST_STATEMENT_CONDITION:
-			if (offsetMap.contains(block[i])) continue;
+			if (function.has_block_offset(block[i])) continue;
 			indexes.emplace_back(i);
 			i--;
 		}
@@ -2873,12 +3103,18 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 		&& previousBlock
 		&& previousBlock->block[previousBlock->index]->type == AST_STATEMENT_LOOP)
 		indexes.pop_back();
-	if (!indexes.size()) return build_if_statements_from_map(function, block, previousBlock, offsetMap);
+	if (!indexes.size()) {
+		build_if_statements_from_offsets(function, block, previousBlock);
+		function.clear_block_offsets(offsetBase);
+		return;
+	}
 
 	for (uint32_t i = indexes.size(); i--;) {
-		if (offsetMap.contains(block[indexes[i]])) function.add_jump(block[indexes[i]]->instruction.id, block[indexes[i]]->instruction.target);
+		if (function.has_block_offset(block[indexes[i]])) function.add_jump(block[indexes[i]]->instruction.id, block[indexes[i]]->instruction.target);
 	}
 
+	function.clear_block_offsets(offsetBase);
+
 	for (uint32_t i = block.size(); i--;) {
 		switch (block[i]->type) {
 		case AST_STATEMENT_CONDITION:
@@ -2895,21 +3131,21 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 			}
 
 			assert(targetLabel != INVALID_ID, "Failed to build if statement", bytecode.filePath, DEBUG_INFO);
-			block[i]->block.reserve(index - i);
-			block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + index + 1);
+			reserve_block(*block[i], index - i);
+			block[i]->block.create()->insert(block[i]->block->begin(), block.begin() + i + 1, block.begin() + index + 1);
 			block.erase(block.begin() + i + 1, block.begin() + index + 1);
 			function.remove_jump(block[i]->instruction.id, block[i]->instruction.target);
 			blockInfo.index = i;
-			build_else_statements(block[i]->block, &blockInfo);
+			build_else_statements(*block[i]->block.create(), &blockInfo);
 			continue;
 		case AST_STATEMENT_NUMERIC_FOR:
 		case AST_STATEMENT_GENERIC_FOR:
-			build_if_statements(function, block[i]->block, nullptr);
+			build_if_statements(function, *block[i]->block.create(), nullptr);
 			continue;
 		case AST_STATEMENT_LOOP:
 		case AST_STATEMENT_DECLARATION:
 			blockInfo.index = i;
-			build_if_statements(function, block[i]->block, &blockInfo);
+			build_if_statements(function, *block[i]->block.create(), &blockInfo);
 			continue;
 		}
 	}
@@ -2927,7 +3163,7 @@ void Ast::clean_up(Function& function) {
 		function.parameterNames.resize(function.prototype.header.parameters);
 
 		for (uint32_t i = function.parameterNames.size(); i--;) {
-			function.parameterNames[i] = "arg_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(i);
+			function.parameterNames[i] = Symbol(AST_SYMBOL_ARGUMENT, minimizeDiffs ? function.level : function.id, i);
 			(*function.slotScopeCollector.slotInfos[i].activeSlotScope)->name = function.parameterNames[i];
 		}
 	}
@@ -2937,7 +3173,7 @@ void Ast::clean_up(Function& function) {
 
 	for (uint32_t i = 0, labelCounter = 0; i < function.labels.size(); i++) {
 		if (!function.labels[i].jumpIds.size()) continue;
-		function.labels[i].name = "label_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(labelCounter);
+		function.labels[i].name = Symbol(AST_SYMBOL_LABEL, minimizeDiffs ? function.level : function.id, labelCounter);
 		labelCounter++;
 	}
 }
@@ -2945,40 +3181,40 @@ void Ast::clean_up(Function& function) {
 void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uint32_t& variableCounter, uint32_t& iteratorCounter, BlockInfo* const& previousBlock) {
 	//TODO
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
-	std::vector<Variable*> declarations;
+	std::vector<const Variable*> declarations;
 	Statement** declarationTarget;
 
 	for (uint32_t i = 0; i < block.size(); i++) {
 		switch (block[i]->type) {
 		case AST_STATEMENT_NUMERIC_FOR:
-			if (block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-				&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_NUMBER
-				&& block[i]->assignment.expressions.back()->constant->number == 1)
-				block[i]->assignment.expressions.pop_back();
+			if (block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+				&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_NUMBER
+				&& block[i]->assignment->expressions.back()->constant->number == 1)
+				block[i]->assignment.create()->expressions.pop_back();
 		case AST_STATEMENT_GENERIC_FOR:
 			if (block[i]->type == AST_STATEMENT_GENERIC_FOR) {
-				while (block[i]->assignment.expressions.size() > 1
-					&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-					&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_NIL) {
-					block[i]->assignment.expressions.pop_back();
+				while (block[i]->assignment->expressions.size() > 1
+					&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+					&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_NIL) {
+					block[i]->assignment.create()->expressions.pop_back();
 				}
 			}
 
 			if (function.hasDebugInfo) {
-				for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-					(*block[i]->assignment.variables[j].slotScope)->name = block[i]->locals->names[j];
+				for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+					(*block[i]->assignment->variables[j].slotScope)->name = block[i]->locals->names[j];
 				}
 			} else {
-				for (uint8_t j = 0; j < block[i]->assignment.variables.size(); j++) {
-					(*block[i]->assignment.variables[j].slotScope)->name = "iter_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(iteratorCounter);
+				for (uint8_t j = 0; j < block[i]->assignment->variables.size(); j++) {
+					(*block[i]->assignment->variables[j].slotScope)->name = Symbol(AST_SYMBOL_ITERATOR, minimizeDiffs ? function.level : function.id, iteratorCounter);
 					iteratorCounter++;
 				}
 			}
 
-			clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, nullptr);
+			clean_up_block(function, *block[i]->block.create(), variableCounter, iteratorCounter, nullptr);
 			continue;
 		case AST_STATEMENT_LOOP:
-			for (std::vector<Statement*>* currentBlock = &block[i]->block; currentBlock->size(); currentBlock = &currentBlock->back()->block) {
+			for (std::vector<Statement*>* currentBlock = block[i]->block.create(); currentBlock->size(); currentBlock = currentBlock->back()->block.create()) {
 				if (currentBlock->back()->type == AST_STATEMENT_DECLARATION) continue;
 				if (currentBlock->back()->type != AST_STATEMENT_GOTO
 					|| currentBlock->back()->instruction.target != block[i]->instruction.id
@@ -2991,16 +3227,16 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 					function.remove_jump(currentBlock->back()->instruction.id, currentBlock->back()->instruction.target);
 					function.remove_jump((*currentBlock)[currentBlock->size() - 2]->instruction.id, (*currentBlock)[currentBlock->size() - 2]->instruction.target);
 					block[i]->type = AST_STATEMENT_REPEAT;
-					block[i]->assignment.expressions.emplace_back(new_primitive(2));
+					block[i]->assignment.create()->expressions.emplace_back(new_primitive(2));
 					(*currentBlock)[currentBlock->size() - 2]->type = AST_STATEMENT_EMPTY;
 					currentBlock->erase(currentBlock->begin() + currentBlock->size() - 1);
 					break;
 				case AST_STATEMENT_IF:
-					if ((*currentBlock)[currentBlock->size() - 2]->block.size() != 1 || (*currentBlock)[currentBlock->size() - 2]->block.back()->type != AST_STATEMENT_BREAK) break;
+					if ((*currentBlock)[currentBlock->size() - 2]->block->size() != 1 || (*currentBlock)[currentBlock->size() - 2]->block->back()->type != AST_STATEMENT_BREAK) break;
 					function.remove_jump(currentBlock->back()->instruction.id, currentBlock->back()->instruction.target);
-					function.remove_jump((*currentBlock)[currentBlock->size() - 2]->block.back()->instruction.id, (*currentBlock)[currentBlock->size() - 2]->block.back()->instruction.target);
+					function.remove_jump((*currentBlock)[currentBlock->size() - 2]->block->back()->instruction.id, (*currentBlock)[currentBlock->size() - 2]->block->back()->instruction.target);
 					block[i]->type = AST_STATEMENT_REPEAT;
-					block[i]->assignment.expressions.emplace_back((*currentBlock)[currentBlock->size() - 2]->assignment.expressions.back());
+					block[i]->assignment.create()->expressions.emplace_back((*currentBlock)[currentBlock->size() - 2]->assignment->expressions.back());
 					(*currentBlock)[currentBlock->size() - 2]->type = AST_STATEMENT_EMPTY;
 					currentBlock->erase(currentBlock->begin() + currentBlock->size() - 1);
 					break;
@@ -3010,19 +3246,19 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 			}
 
 			if (block[i]->type == AST_STATEMENT_LOOP) {
-				if (block[i]->block.size() && block[i]->block.back()->type == AST_STATEMENT_GOTO) {
-					if (block[i]->instruction.id == block[i]->block.back()->instruction.target) {
-						function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
+				if (block[i]->block->size() && block[i]->block->back()->type == AST_STATEMENT_GOTO) {
+					if (block[i]->instruction.id == block[i]->block->back()->instruction.target) {
+						function.remove_jump(block[i]->block->back()->instruction.id, block[i]->block->back()->instruction.target);
 						block[i]->type = AST_STATEMENT_WHILE;
-						block[i]->assignment.expressions.emplace_back(new_primitive(2));
-						block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+						block[i]->assignment.create()->expressions.emplace_back(new_primitive(2));
+						block[i]->block->back()->type = AST_STATEMENT_EMPTY;
 					} else if (block.size() != 1) {
 						for (uint32_t j = i; j--
 							&& block[j]->type == AST_STATEMENT_IF
-							&& !block[j]->block.size();) {
+							&& !block[j]->block->size();) {
 							if (!function.is_valid_label(block[j]->instruction.label)) continue;
-							if (function.is_valid_label(block[i]->instruction.label) || function.labels[block[j]->instruction.label].target != block[i]->block.back()->instruction.target) break;
-							function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
+							if (function.is_valid_label(block[i]->instruction.label) || function.labels[block[j]->instruction.label].target != block[i]->block->back()->instruction.target) break;
+							function.remove_jump(block[i]->block->back()->instruction.id, block[i]->block->back()->instruction.target);
 							block[i]->type = AST_STATEMENT_WHILE;
 							block[i]->instruction.label = block[j]->instruction.label;
 
@@ -3030,47 +3266,47 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 								expression = new_expression(AST_EXPRESSION_BINARY_OPERATION);
 								expression->binaryOperation->type = AST_BINARY_OR;
 								expression->binaryOperation->rightOperand = new_primitive(2);
-								expression->binaryOperation->leftOperand = block[i - 1]->assignment.expressions.back();
-
-								if (block[i]->assignment.expressions.size()) {
-									block[i - 1]->assignment.expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
-									block[i - 1]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_AND;
-									block[i - 1]->assignment.expressions.back()->binaryOperation->rightOperand = block[i]->assignment.expressions.back();
-									block[i - 1]->assignment.expressions.back()->binaryOperation->leftOperand = expression;
-									block[i]->assignment.expressions.back() = block[i - 1]->assignment.expressions.back();
+								expression->binaryOperation->leftOperand = block[i - 1]->assignment->expressions.back();
+
+								if (block[i]->assignment->expressions.size()) {
+									block[i - 1]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
+									block[i - 1]->assignment->expressions.back()->binaryOperation->type = AST_BINARY_AND;
+									block[i - 1]->assignment->expressions.back()->binaryOperation->rightOperand = block[i]->assignment->expressions.back();
+									block[i - 1]->assignment->expressions.back()->binaryOperation->leftOperand = expression;
+									block[i]->assignment.create()->expressions.back() = block[i - 1]->assignment->expressions.back();
 								} else {
-									block[i]->assignment.expressions.resize(1, expression);
+									block[i]->assignment.create()->expressions.resize(1, expression);
 								}
 
 								block.erase(block.begin() + i - 1);
 							}
 
-							block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+							block[i]->block->back()->type = AST_STATEMENT_EMPTY;
 							break;
 						}
 					} else if (previousBlock
 						&& previousBlock->block[previousBlock->index]->type == AST_STATEMENT_IF
 						&& !function.is_valid_label(block[i]->instruction.label)) {
 						if (function.is_valid_label(previousBlock->block[previousBlock->index]->instruction.label)) {
-							if (function.labels[previousBlock->block[previousBlock->index]->instruction.label].target == block[i]->block.back()->instruction.target) {
-								function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
+							if (function.labels[previousBlock->block[previousBlock->index]->instruction.label].target == block[i]->block->back()->instruction.target) {
+								function.remove_jump(block[i]->block->back()->instruction.id, block[i]->block->back()->instruction.target);
 								block[i]->type = AST_STATEMENT_WHILE;
-								block[i]->assignment.expressions.emplace_back(previousBlock->block[previousBlock->index]->assignment.expressions.back());
+								block[i]->assignment.create()->expressions.emplace_back(previousBlock->block[previousBlock->index]->assignment->expressions.back());
 								block[i]->instruction.label = previousBlock->block[previousBlock->index]->instruction.label;
-								block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+								block[i]->block->back()->type = AST_STATEMENT_EMPTY;
 								previousBlock->block[previousBlock->index] = block[i];
 							}
 						} else {
 							for (uint32_t j = previousBlock->index - 1; j--
 								&& previousBlock->block[j]->type == AST_STATEMENT_IF
-								&& !previousBlock->block[j]->block.size();) {
+								&& !previousBlock->block[j]->block->size();) {
 								if (!function.is_valid_label(previousBlock->block[j]->instruction.label)) continue;
-								if (function.labels[previousBlock->block[j]->instruction.label].target != block[i]->block.back()->instruction.target) break;
-								function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
+								if (function.labels[previousBlock->block[j]->instruction.label].target != block[i]->block->back()->instruction.target) break;
+								function.remove_jump(block[i]->block->back()->instruction.id, block[i]->block->back()->instruction.target);
 								block[i]->type = AST_STATEMENT_WHILE;
-								block[i]->assignment.expressions.resize(1, new_expression(AST_EXPRESSION_BINARY_OPERATION));
-								block[i]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_AND;
-								block[i]->assignment.expressions.back()->binaryOperation->rightOperand = previousBlock->block[previousBlock->index]->assignment.expressions.back();
+								block[i]->assignment.create()->expressions.resize(1, new_expression(AST_EXPRESSION_BINARY_OPERATION));
+								block[i]->assignment->expressions.back()->binaryOperation->type = AST_BINARY_AND;
+								block[i]->assignment->expressions.back()->binaryOperation->rightOperand = previousBlock->block[previousBlock->index]->assignment->expressions.back();
 								block[i]->instruction.label = previousBlock->block[j]->instruction.label;
 								previousBlock->block[j]->instruction.label = INVALID_ID;
 
@@ -3078,22 +3314,22 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 									expression = new_expression(AST_EXPRESSION_BINARY_OPERATION);
 									expression->binaryOperation->type = AST_BINARY_OR;
 									expression->binaryOperation->rightOperand = new_primitive(2);
-									expression->binaryOperation->leftOperand = previousBlock->block[j]->assignment.expressions.back();
-
-									if (block[i]->assignment.expressions.back()->binaryOperation->leftOperand) {
-										previousBlock->block[j]->assignment.expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
-										previousBlock->block[j]->assignment.expressions.back()->binaryOperation->type = AST_BINARY_AND;
-										previousBlock->block[j]->assignment.expressions.back()->binaryOperation->rightOperand = expression;
-										previousBlock->block[j]->assignment.expressions.back()->binaryOperation->leftOperand = block[i]->assignment.expressions.back()->binaryOperation->leftOperand;
-										block[i]->assignment.expressions.back()->binaryOperation->leftOperand = previousBlock->block[j]->assignment.expressions.back();
+									expression->binaryOperation->leftOperand = previousBlock->block[j]->assignment->expressions.back();
+
+									if (block[i]->assignment->expressions.back()->binaryOperation->leftOperand) {
+										previousBlock->block[j]->assignment.create()->expressions.back() = new_expression(AST_EXPRESSION_BINARY_OPERATION);
+										previousBlock->block[j]->assignment->expressions.back()->binaryOperation->type = AST_BINARY_AND;
+										previousBlock->block[j]->assignment->expressions.back()->binaryOperation->rightOperand = expression;
+										previousBlock->block[j]->assignment->expressions.back()->binaryOperation->leftOperand = block[i]->assignment->expressions.back()->binaryOperation->leftOperand;
+										block[i]->assignment->expressions.back()->binaryOperation->leftOperand = previousBlock->block[j]->assignment->expressions.back();
 									} else {
-										block[i]->assignment.expressions.back()->binaryOperation->leftOperand = expression;
+										block[i]->assignment->expressions.back()->binaryOperation->leftOperand = expression;
 									}
 
 									previousBlock->block[j]->type = AST_STATEMENT_EMPTY;
 								}
 
-								block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+								block[i]->block->back()->type = AST_STATEMENT_EMPTY;
 								previousBlock->block[previousBlock->index] = block[i];
 								break;
 							}
@@ -3103,55 +3339,57 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 				if (block[i]->type == AST_STATEMENT_LOOP) {
 					block[i]->type = AST_STATEMENT_REPEAT;
-					block[i]->assignment.expressions.emplace_back(new_primitive(2));
+					block[i]->assignment.create()->expressions.emplace_back(new_primitive(2));
 				}
 			}
 
-			clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, nullptr);
+			clean_up_block(function, *block[i]->block.create(), variableCounter, iteratorCounter, nullptr);
 			continue;
 		case AST_STATEMENT_BREAK:
 			function.remove_jump(block[i]->instruction.id, block[i]->instruction.target);
 			continue;
 		case AST_STATEMENT_DECLARATION:
-			while (block[i]->assignment.expressions.size()
-				&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-				&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_NIL) {
-				block[i]->assignment.expressions.pop_back();
+			while (block[i]->assignment->expressions.size()
+				&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+				&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_NIL) {
+				block[i]->assignment.create()->expressions.pop_back();
 			}
 
-			for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-				(*block[i]->assignment.variables[j].slotScope)->name = block[i]->locals->names[j];
+			for (uint8_t j = block[i]->assignment->variables.size(); j--;) {
+				(*block[i]->assignment->variables[j].slotScope)->name = block[i]->locals->names[j];
 			}
 
-			clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, nullptr);
+			clean_up_block(function, *block[i]->block.create(), variableCounter, iteratorCounter, nullptr);
 			continue;
 		case AST_STATEMENT_ASSIGNMENT:
-			if (block[i]->assignment.variables.size() == 1
-				&& block[i]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& !(*block[i]->assignment.variables.back().slotScope)->usages
-				&& block[i]->assignment.expressions.size() == 1
-				&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_TABLE
-				&& block[i]->assignment.expressions.back()->table->fields.size() == 1
-				&& !block[i]->assignment.expressions.back()->table->constants.list.size()
-				&& !block[i]->assignment.expressions.back()->table->constants.fields.size()
-				&& !block[i]->assignment.expressions.back()->table->multresField) {
-				function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
-				block[i]->assignment.variables.back().type = AST_VARIABLE_TABLE_INDEX;
-				block[i]->assignment.variables.back().table = block[i]->assignment.expressions.back();
-				block[i]->assignment.variables.back().tableIndex = block[i]->assignment.expressions.back()->table->fields.back().key;
-				block[i]->assignment.expressions.back() = block[i]->assignment.expressions.back()->table->fields.back().value;
-				block[i]->assignment.variables.back().table->table->fields.pop_back();
+			if (block[i]->assignment->variables.size() == 1
+				&& block[i]->assignment->variables.back().type == AST_VARIABLE_SLOT
+				&& !(*block[i]->assignment->variables.back().slotScope)->usages
+				&& block[i]->assignment->expressions.size() == 1
+				&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_TABLE
+				&& block[i]->assignment->expressions.back()->table->fields.size() == 1
+				&& !block[i]->assignment->expressions.back()->table->constants.list.size()
+				&& !block[i]->assignment->expressions.back()->table->constants.fields.size()
+				&& !block[i]->assignment->expressions.back()->table->constants.array.size()
+				&& !block[i]->assignment->expressions.back()->table->constants.nodeCount
+				&& !block[i]->assignment->expressions.back()->table->multresField) {
+				function.slotScopeCollector.remove_scope(block[i]->assignment->variables.back().slot, block[i]->assignment->variables.back().slotScope);
+				block[i]->assignment.create()->variables.back().type = AST_VARIABLE_TABLE_INDEX;
+				block[i]->assignment.create()->variables.back().table = block[i]->assignment->expressions.back();
+				block[i]->assignment.create()->variables.back().tableIndex = block[i]->assignment->expressions.back()->table->fields.back().key;
+				block[i]->assignment.create()->expressions.back() = block[i]->assignment->expressions.back()->table->fields.back().value;
+				block[i]->assignment->variables.back().table->table->fields.pop_back();
 				continue;
 			}
 
-			for (uint32_t j = 0; j < block[i]->assignment.variables.size(); j++) {
-				if (block[i]->assignment.variables[j].type != AST_VARIABLE_SLOT || (*block[i]->assignment.variables[j].slotScope)->name.size()) {
-					block[i]->assignment.forwardDeclaration = true;
+			for (uint32_t j = 0; j < block[i]->assignment->variables.size(); j++) {
+				if (block[i]->assignment->variables[j].type != AST_VARIABLE_SLOT || (*block[i]->assignment->variables[j].slotScope)->name.type != AST_SYMBOL_NONE) {
+					block[i]->assignment.create()->forwardDeclaration = true;
 					continue;
 				}
 
-				declarations.emplace_back(&block[i]->assignment.variables[j]);
-				(*block[i]->assignment.variables[j].slotScope)->name = "var_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(variableCounter);
+				declarations.emplace_back(&block[i]->assignment->variables[j]);
+				(*block[i]->assignment->variables[j].slotScope)->name = Symbol(AST_SYMBOL_VARIABLE, minimizeDiffs ? function.level : function.id, variableCounter);
 				variableCounter++;
 			}
 
@@ -3169,9 +3407,9 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 						switch (currentBlockInfo->block[currentBlockInfo->index]->type) {
 						case AST_STATEMENT_IF:
 							if (currentBlockInfo->block[currentBlockInfo->index + 1]->type == AST_STATEMENT_ELSE) {
-								if ((*declarations[j]->slotScope)->scopeEnd <= currentBlockInfo->block[currentBlockInfo->index]->block.back()->instruction.id) break;
+								if ((*declarations[j]->slotScope)->scopeEnd <= currentBlockInfo->block[currentBlockInfo->index]->block->back()->instruction.id) break;
 								declarationTarget = &currentBlockInfo->block[currentBlockInfo->index - 1];
-								block[i]->assignment.forwardDeclaration = true;
+								block[i]->assignment.create()->forwardDeclaration = true;
 								continue;
 							}
 						case AST_STATEMENT_ELSE:
@@ -3182,13 +3420,13 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 								if (currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.type == Bytecode::BC_OP_JMP) {
 									if ((*declarations[j]->slotScope)->scopeEnd < currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.id) break;
 									declarationTarget = &currentBlockInfo->block[currentBlockInfo->index - (currentBlockInfo->block[currentBlockInfo->index]->type == AST_STATEMENT_ELSE ? 2 : 1)];
-									block[i]->assignment.forwardDeclaration = true;
+									block[i]->assignment.create()->forwardDeclaration = true;
 									continue;
 								}
 							default:
 								if ((*declarations[j]->slotScope)->scopeEnd < function.labels[currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.label].target) break;
 								declarationTarget = &currentBlockInfo->block[currentBlockInfo->index - (currentBlockInfo->block[currentBlockInfo->index]->type == AST_STATEMENT_ELSE ? 2 : 1)];
-								block[i]->assignment.forwardDeclaration = true;
+								block[i]->assignment.create()->forwardDeclaration = true;
 								continue;
 							}
 
@@ -3200,23 +3438,23 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 					if (!*declarationTarget) {
 						*declarationTarget = new_statement(AST_STATEMENT_DECLARATION);
-						(*declarationTarget)->assignment.forwardDeclaration = true;
+						(*declarationTarget)->assignment.create()->forwardDeclaration = true;
 						(*declarationTarget)->instruction.target = (*declarations[j]->slotScope)->scopeBegin;
 					}
 
-					(*declarationTarget)->assignment.variables.emplace_back(*declarations[j]);
+					(*declarationTarget)->assignment.create()->variables.emplace_back(*declarations[j]);
 				}
 
-				if (!block[i]->assignment.forwardDeclaration) {
+				if (!block[i]->assignment->forwardDeclaration) {
 					block[i]->type = AST_STATEMENT_DECLARATION;
-					block[i]->assignment.forwardDeclaration = true;
+					block[i]->assignment.create()->forwardDeclaration = true;
 					block[i]->instruction.target = block[i - 1]->instruction.target;
 					block[i - 1] = nullptr;
 
-					while (block[i]->assignment.expressions.size()
-						&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-						&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_NIL) {
-						block[i]->assignment.expressions.pop_back();
+					while (block[i]->assignment->expressions.size()
+						&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+						&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_NIL) {
+						block[i]->assignment.create()->expressions.pop_back();
 					}
 				}
 
@@ -3229,10 +3467,10 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 			}
 
 			if (block[i]->type == AST_STATEMENT_ASSIGNMENT) {
-				while (block[i]->assignment.expressions.size() > 1
-					&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-					&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_NIL) {
-					block[i]->assignment.expressions.pop_back();
+				while (block[i]->assignment->expressions.size() > 1
+					&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+					&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_NIL) {
+					block[i]->assignment.create()->expressions.pop_back();
 				}
 			}
 			
@@ -3241,10 +3479,10 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 			block.emplace(block.begin() + i, nullptr);
 			i++;
 			blockInfo.index = i;
-			clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, &blockInfo);
-			if (!block[i]->block.size()
-				&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_CONSTANT
-				&& block[i]->assignment.expressions.back()->constant->type == AST_CONSTANT_FALSE)
+			clean_up_block(function, *block[i]->block.create(), variableCounter, iteratorCounter, &blockInfo);
+			if (!block[i]->block->size()
+				&& block[i]->assignment->expressions.back()->type == AST_EXPRESSION_CONSTANT
+				&& block[i]->assignment->expressions.back()->constant->type == AST_CONSTANT_FALSE)
 				block[i]->type = AST_STATEMENT_EMPTY;
 			
 			if (i != block.size() - 1 && block[i + 1]->type == AST_STATEMENT_ELSE) {
@@ -3252,16 +3490,16 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 				if (block[i - 1]->type == AST_STATEMENT_EMPTY) {
 					block[i]->type = AST_STATEMENT_EMPTY;
-					block.reserve(block.size() + block[i]->block.size());
-					block.insert(block.begin() + i + 1, block[i]->block.begin(), block[i]->block.begin() + block[i]->block.size());
-					block[i]->block.clear();
-					block[i]->block.shrink_to_fit();
+					block.reserve(block.size() + block[i]->block->size());
+					block.insert(block.begin() + i + 1, block[i]->block->begin(), block[i]->block->begin() + block[i]->block->size());
+					block[i]->block.create()->clear();
+					block[i]->block.create()->shrink_to_fit();
 				} else {
 					blockInfo.index++;
-					clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, &blockInfo);
+					clean_up_block(function, *block[i]->block.create(), variableCounter, iteratorCounter, &blockInfo);
 					blockInfo.index--;
 
-					if (!block[i]->block.size()) block[i]->type = AST_STATEMENT_EMPTY;
+					if (!block[i]->block->size()) block[i]->type = AST_STATEMENT_EMPTY;
 				}
 			}
 
@@ -3299,7 +3537,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 	for (uint32_t i = block.size(); i--;) {
 		if (block[i]->type != AST_STATEMENT_DECLARATION) continue;
 
-		if (block[i]->assignment.forwardDeclaration) {
+		if (block[i]->assignment->forwardDeclaration) {
 			for (uint32_t j = i; j < block.size(); j++) {
 				if (block[j]->type != AST_STATEMENT_LABEL) continue;
 
@@ -3310,16 +3548,16 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 					block.emplace(block.begin() + i, new_statement(AST_STATEMENT_DO));
 					j++;
-					block[i]->block.reserve(j - 1 - i);
-					block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + j);
+					reserve_block(*block[i], j - 1 - i);
+					block[i]->block.create()->insert(block[i]->block->begin(), block.begin() + i + 1, block.begin() + j);
 					block.erase(block.begin() + i + 1, block.begin() + j);
 
-					if (block[i]->block.size() && block[i]->block.back()->type == AST_STATEMENT_DO) {
-						block[i]->block.reserve(block[i]->block.size() + block[i]->block.back()->block.size());
-						block[i]->block.insert(block[i]->block.begin() + block[i]->block.size() - 1, block[i]->block.back()->block.begin(), block[i]->block.back()->block.begin() + block[i]->block.back()->block.size());
-						block[i]->block.back()->block.clear();
-						block[i]->block.back()->block.shrink_to_fit();
-						block[i]->block.pop_back();
+					if (block[i]->block->size() && block[i]->block->back()->type == AST_STATEMENT_DO) {
+						block[i]->block.create()->reserve(block[i]->block->size() + block[i]->block->back()->block->size());
+						block[i]->block.create()->insert(block[i]->block->begin() + block[i]->block->size() - 1, block[i]->block->back()->block->begin(), block[i]->block->back()->block->begin() + block[i]->block->back()->block->size());
+						block[i]->block->back()->block.create()->clear();
+						block[i]->block->back()->block.create()->shrink_to_fit();
+						block[i]->block.create()->pop_back();
 					}
 
 					break;
@@ -3333,26 +3571,41 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 		}
 
 		if (i == block.size() - 1) {
-			block.reserve(block.size() + block[i]->block.size());
-			block.insert(block.begin() + block.size(), block[i]->block.begin(), block[i]->block.begin() + block[i]->block.size());
-			block[i]->block.clear();
-			block[i]->block.shrink_to_fit();
+			block.reserve(block.size() + block[i]->block->size());
+			block.insert(block.begin() + block.size(), block[i]->block->begin(), block[i]->block->begin() + block[i]->block->size());
+			block[i]->block.create()->clear();
+			block[i]->block.create()->shrink_to_fit();
 			continue;
 		}
 
-		block[i]->block.emplace(block[i]->block.begin(), new_statement(AST_STATEMENT_DECLARATION));
-		block[i]->block.front()->assignment.variables = block[i]->assignment.variables;
-		block[i]->block.front()->assignment.expressions = block[i]->assignment.expressions;
+		block[i]->block.create()->emplace(block[i]->block->begin(), new_statement(AST_STATEMENT_DECLARATION));
+		block[i]->block->front()->assignment.create()->variables = block[i]->assignment->variables;
+		block[i]->block->front()->assignment.create()->expressions = block[i]->assignment->expressions;
 		block[i]->type = AST_STATEMENT_DO;
 	}
 }
 
 uint32_t Ast::get_block_index_from_id(const std::vector<Statement*>& block, const uint32_t& id) {
-	for (uint32_t i = block.size(); i-- && (block[i]->instruction.id == INVALID_ID || block[i]->instruction.id >= id);) {
-		if (block[i]->instruction.id == id) return i;
+	uint32_t index = INVALID_ID;
+
+	for (uint32_t begin = 0, end = block.size(), middle, i; begin < end;) {
+		middle = begin + (end - begin) / 2;
+		i = middle;
+
+		while (i < end && block[i]->instruction.id == INVALID_ID) {
+			i++;
+		}
+
+		if (i == end || block[i]->instruction.id > id) {
+			end = middle;
+			continue;
+		}
+
+		if (block[i]->instruction.id == id) index = i;
+		begin = i + 1;
 	}
 
-	return INVALID_ID;
+	return index;
 }
 
 uint32_t Ast::get_extended_id_from_statement(Statement* const& statement) {
@@ -3370,8 +3623,8 @@ uint32_t Ast::get_label_from_next_statement(Function& function, const BlockInfo&
 	Statement* statement = blockInfo.block[blockInfo.index + 1];
 
 	if (excludeDeclaration && statement->type == AST_STATEMENT_DECLARATION) {
-		if (statement->block.size()) {
-			statement = statement->block.front();
+		if (statement->block->size()) {
+			statement = statement->block->front();
 		} else if (blockInfo.index + 2 != blockInfo.block.size()) {
 			statement = blockInfo.block[blockInfo.index + 2];
 		} else {
@@ -3396,19 +3649,19 @@ bool Ast::is_valid_block(Function& function, const BlockInfo& blockInfo, const u
 	return blockEnd == INVALID_ID ? true : (blockEnd > blockBegin ? function.is_valid_block_range(blockBegin, blockEnd - 1, false) : true);
 }
 
-void Ast::check_valid_name(Constant* const& constant) {
+bool Ast::is_valid_name(const std::string_view& string) {
 	static const std::string KEYWORDS[] = {
 		"and", "break", "do", "else", "elseif", "end", "false",
 		"for", "function", "if", "in", "local", "nil", "not",
 		"or", "repeat", "return", "then", "true", "until", "while"
 	};
 
-	if (!constant->string.size() || constant->string.front() < 'A') return;
+	if (!string.size() || string.front() < 'A') return false;
 
-	for (uint32_t i = constant->string.size(); i--;) {
-		if (constant->string[i] < '0') return;
+	for (uint32_t i = string.size(); i--;) {
+		if (string[i] < '0') return false;
 
-		switch (constant->string[i]) {
+		switch (string[i]) {
 		case ':':
 		case ';':
 		case '<':
@@ -3426,22 +3679,36 @@ void Ast::check_valid_name(Constant* const& constant) {
 		case '}':
 		case '~':
 		case '\x7F':
-			return;
+			return false;
 		}
 	}
 
 	for (uint8_t i = sizeof(KEYWORDS) / sizeof(std::string); i--;) {
-		if (constant->string == KEYWORDS[i]) return;
+		if (string == KEYWORDS[i]) return false;
 	}
 
-	constant->isName = true;
+	return true;
+}
+
+void Ast::check_valid_name(Constant* const& constant) {
+	if (is_valid_name(constant->string)) constant->isName = true;
+}
+
+bool Ast::is_infinite_number(const double& number, const bool& isCdata) {
+	const uint64_t rawDouble = std::bit_cast<uint64_t>(number);
+
+	if ((rawDouble & DOUBLE_EXPONENT) != DOUBLE_SPECIAL) {
+		assert(rawDouble != DOUBLE_NEGATIVE_ZERO || isCdata, "Number constant is negative zero", bytecode.filePath, DEBUG_INFO);
+		return false;
+	}
+
+	assert(!(rawDouble & DOUBLE_FRACTION), "Number constant is NaN", bytecode.filePath, DEBUG_INFO);
+	return true;
 }
 
 void Ast::check_special_number(Expression* const& expression, const bool& isCdata) {
+	if (!is_infinite_number(expression->constant->number, isCdata) || isCdata) return;
 	const uint64_t rawDouble = std::bit_cast<uint64_t>(expression->constant->number);
-	if ((rawDouble & DOUBLE_EXPONENT) != DOUBLE_SPECIAL) return assert(rawDouble != DOUBLE_NEGATIVE_ZERO || isCdata, "Number constant is negative zero", bytecode.filePath, DEBUG_INFO);
-	assert(!(rawDouble & DOUBLE_FRACTION), "Number constant is NaN", bytecode.filePath, DEBUG_INFO);
-	if (isCdata) return;
 	expression->set_type(AST_EXPRESSION_BINARY_OPERATION);
 	expression->binaryOperation->type = AST_BINARY_DIVISION;
 	expression->binaryOperation->leftOperand = new_expression(AST_EXPRESSION_CONSTANT);
@@ -3534,6 +3801,35 @@ Ast::CONSTANT_TYPE Ast::get_constant_type(Expression* const& expression) {
 	return INVALID_CONSTANT;
 }
 
+void Ast::build_operand(Function& function, Statement& statement, Expression*& expression, const Bytecode::BC_OPERAND& operand, const uint16_t& value) {
+	switch (operand) {
+	case Bytecode::BC_OPERAND_VAR:
+		expression = new_slot(value);
+		statement.assignment.create()->register_slots(expression);
+		return;
+	case Bytecode::BC_OPERAND_LIT:
+		expression = new_literal(value);
+		return;
+	case Bytecode::BC_OPERAND_LITS:
+		expression = new_signed_literal(value);
+		return;
+	case Bytecode::BC_OPERAND_PRI:
+		expression = new_primitive(value);
+		return;
+	case Bytecode::BC_OPERAND_NUM:
+		expression = new_number(function, value);
+		return;
+	case Bytecode::BC_OPERAND_STR:
+		expression = new_string(function, value);
+		return;
+	case Bytecode::BC_OPERAND_CDATA:
+		expression = new_cdata(function, value);
+		return;
+	}
+
+	throw nullptr;
+}
+
 Ast::Expression* Ast::new_slot(const uint8_t& slot) {
 	Expression* const expression = new_expression(AST_EXPRESSION_VARIABLE);
 	expression->variable->type = AST_VARIABLE_SLOT;
@@ -3592,15 +3888,16 @@ Ast::Expression* Ast::new_number(const Function& function, const uint16_t& index
 	return expression;
 }
 
-Ast::Expression* Ast::new_string(const Function& function, const uint16_t& index) {
+Ast::Expression* Ast::new_string(Function& function, const uint16_t& index) {
 	Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
 	expression->constant->type = AST_CONSTANT_STRING;
-	expression->constant->string = function.get_constant(index).string;
+	expression->constant->string = function.get_string_constant(index);
+	expression->constant->isName = function.is_name_constant(index);
 	return expression;
 }
 
 Ast::Expression* Ast::new_table(const Function& function, const uint16_t& index) {
-	const auto new_table_constant = [this](const Bytecode::TableConstant& constant)->Expression* {
+	const auto new_table_constant = [this, &function](const Bytecode::TableConstant& constant)->Expression* {
 		Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
 
 		switch (constant.type) {
@@ -3624,82 +3921,96 @@ Ast::Expression* Ast::new_table(const Function& function, const uint16_t& index)
 			break;
 		case Bytecode::BC_KTAB_STR:
 			expression->constant->type = AST_CONSTANT_STRING;
-			expression->constant->string = constant.string;
+			expression->constant->string = function.prototype.get_string(constant.string);
 			break;
 		}
 
 		return expression;
 	};
 
+	const auto check_table_constant = [this](const Bytecode::TableConstant& constant) {
+		if (constant.type == Bytecode::BC_KTAB_NUM) is_infinite_number(std::bit_cast<double>(constant.number));
+	};
+
+	const std::span<const Bytecode::TableConstant> array = function.prototype.get_array(function.get_constant(index));
+	const std::span<const Bytecode::TableNode> table = function.prototype.get_table(function.get_constant(index));
 	Expression* const expression = new_expression(AST_EXPRESSION_TABLE);
-	expression->table->constants.list.resize(function.get_constant(index).array.size(), nullptr);
 
-	for (uint32_t i = expression->table->constants.list.size(); i--;) {
-		expression->table->constants.list[i] = new_table_constant(function.get_constant(index).array[i]);
-	}
+	if (!minimizeDiffs) {
+		expression->table->constants.prototype = &function.prototype;
+		expression->table->constants.array = array;
+		expression->table->constants.nodes = table;
+		expression->table->constants.nodeCount = table.size();
 
-	if (minimizeDiffs) {
-		uint32_t position;
-		Expression* key;
-		Expression** value;
-		Table::Field falseField, trueField;
-		std::vector<Table::Field> numberFields, stringFields;
+		for (uint32_t i = array.size(); i--;) {
+			check_table_constant(array[i]);
+		}
 
-		for (uint32_t i = function.get_constant(index).table.size(); i--;) {
-			key = new_table_constant(function.get_constant(index).table[i].key);
+		for (uint32_t i = table.size(); i--;) {
+			check_table_constant(table[i].key);
+			check_table_constant(table[i].value);
+		}
 
-			switch (key->constant->type) {
-			case AST_CONSTANT_FALSE:
-				falseField.key = key;
-				value = &falseField.value;
-				break;
-			case AST_CONSTANT_TRUE:
-				trueField.key = key;
-				value = &trueField.value;
-				break;
-			case AST_CONSTANT_NUMBER:
-				position = numberFields.size();
+		return expression;
+	}
 
-				while (position && numberFields[position - 1].key->constant->number > key->constant->number) {
-					position--;
-				}
+	uint32_t position;
+	Expression* key;
+	Expression** value;
+	Table::Field falseField, trueField;
+	std::vector<Table::Field> numberFields, stringFields;
+	expression->table->constants.list.resize(array.size(), nullptr);
 
-				numberFields.emplace(numberFields.begin() + position, Table::Field{ .key = key });
-				value = &numberFields[position].value;
-				break;
-			case AST_CONSTANT_STRING:
-				check_valid_name(key->constant);
-				position = stringFields.size();
+	for (uint32_t i = expression->table->constants.list.size(); i--;) {
+		expression->table->constants.list[i] = new_table_constant(array[i]);
+	}
 
-				while (position && stringFields[position - 1].key->constant->string.compare(key->constant->string) > 0) {
-					position--;
-				}
+	for (uint32_t i = table.size(); i--;) {
+		key = new_table_constant(table[i].key);
 
-				stringFields.emplace(stringFields.begin() + position, Table::Field{ .key = key });
-				value = &stringFields[position].value;
-				break;
-			default:
-				throw nullptr;
+		switch (key->constant->type) {
+		case AST_CONSTANT_FALSE:
+			falseField.key = key;
+			value = &falseField.value;
+			break;
+		case AST_CONSTANT_TRUE:
+			trueField.key = key;
+			value = &trueField.value;
+			break;
+		case AST_CONSTANT_NUMBER:
+			position = numberFields.size();
+
+			while (position && numberFields[position - 1].key->constant->number > key->constant->number) {
+				position--;
 			}
 
-			*value = new_table_constant(function.get_constant(index).table[i].value);
-		}
+			numberFields.emplace(numberFields.begin() + position, Table::Field{ .key = key });
+			value = &numberFields[position].value;
+			break;
+		case AST_CONSTANT_STRING:
+			check_valid_name(key->constant);
+			position = stringFields.size();
 
-		if (falseField.key) expression->table->constants.fields.emplace_back(falseField);
-		if (trueField.key) expression->table->constants.fields.emplace_back(trueField);
-		expression->table->constants.fields.reserve(expression->table->constants.fields.size() + numberFields.size() + stringFields.size());
-		expression->table->constants.fields.insert(expression->table->constants.fields.begin() + expression->table->constants.fields.size(), numberFields.begin(), numberFields.begin() + numberFields.size());
-		expression->table->constants.fields.insert(expression->table->constants.fields.begin() + expression->table->constants.fields.size(), stringFields.begin(), stringFields.begin() + stringFields.size());
-	} else {
-		expression->table->constants.fields.resize(function.get_constant(index).table.size());
+			while (position && stringFields[position - 1].key->constant->string.compare(key->constant->string) > 0) {
+				position--;
+			}
 
-		for (uint32_t i = expression->table->constants.fields.size(); i--;) {
-			expression->table->constants.fields[i].key = new_table_constant(function.get_constant(index).table[i].key);
-			if (expression->table->constants.fields[i].key->constant->type == AST_CONSTANT_STRING) check_valid_name(expression->table->constants.fields[i].key->constant);
-			expression->table->constants.fields[i].value = new_table_constant(function.get_constant(index).table[i].value);
+			stringFields.emplace(stringFields.begin() + position, Table::Field{ .key = key });
+			value = &stringFields[position].value;
+			break;
+		default:
+			throw nullptr;
 		}
+
+		*value = new_table_constant(table[i].value);
 	}
 
+	if (falseField.key) expression->table->constants.fields.emplace_back(falseField);
+	if (trueField.key) expression->table->constants.fields.emplace_back(trueField);
+	expression->table->constants.fields.reserve(expression->table->constants.fields.size() + numberFields.size() + stringFields.size());
+	expression->table->constants.fields.insert(expression->table->constants.fields.begin() + expression->table->constants.fields.size(), numberFields.begin(), numberFields.begin() + numberFields.size());
+	expression->table->constants.fields.insert(expression->table->constants.fields.begin() + expression->table->constants.fields.size(), stringFields.begin(), stringFields.begin() + stringFields.size());
+
 	return expression;
 }
 
@@ -3,18 +3,36 @@ private:
 
 	static constexpr uint32_t INVALID_ID = -1;
 
-	enum CONSTANT_TYPE {
+	enum CONSTANT_TYPE : uint8_t {
 		INVALID_CONSTANT,
 		NIL_CONSTANT,
 		BOOL_CONSTANT,
 		NUMBER_CONSTANT
 	};
 
+	enum LOWERING {
+		LOWERING_NONE,
+		LOWERING_OPERAND,
+		LOWERING_UNARY,
+		LOWERING_BINARY,
+		LOWERING_TABLE_GET,
+		LOWERING_TABLE_SET,
+		LOWERING_UPVALUE_SET,
+		LOWERING_COMPARISON
+	};
+
 	struct Local;
 	struct SlotScope;
 	struct ConditionBuilder;
 
 public:
+	struct Budget {
+		uint64_t timeLimit = 0;
+		uint64_t nodeLimit = 0;
+		uint64_t memoryLimit = 0;
+	};
+
+	struct Symbol;
 	struct Expression;
 	struct Constant;
 	struct Variable;
@@ -27,17 +45,54 @@ public:
 	#include "building_blocks.h"
 	#include "function.h"
 
-	Ast(const Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs);
+	Ast(Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs, const bool& isStreaming, const Budget& budget);
 	~Ast();
 
 	void operator()();
+	void operator()(const Bytecode::Prototype& prototype);
+	void build_functions(const std::vector<Function*>& functions);
+	void release_functions(const std::vector<Function*>& functions);
+	void check_budget();
 
+	const bool isStreaming;
 	Function* chunk = nullptr;
 
+	static bool is_valid_name(const std::string_view& string);
+
 private:
 
 	#include "conditionBuilder.h";
 
+	struct NodePool {
+		void add_memory_usage(const uint64_t& size) {
+			if (!memoryUsage) return;
+			memoryCharged += size;
+			memoryUsage->fetch_add(size, std::memory_order_relaxed);
+		}
+
+		void remove_memory_usage(const uint64_t& size) {
+			if (!memoryUsage) return;
+			memoryCharged -= size;
+			memoryUsage->fetch_sub(size, std::memory_order_relaxed);
+		}
+
+		std::vector<Statement*> statements;
+		std::vector<Function*> functions;
+		std::vector<Expression*> expressions;
+		ConditionBuilder::NodePool conditionNodePool;
+		std::atomic<uint64_t>* memoryUsage = nullptr;
+		uint64_t memoryCharged = 0;
+	};
+
+	struct Lowering {
+		LOWERING type = LOWERING_NONE;
+		uint8_t operation = 0;
+		CONSTANT_TYPE allowedConstantType = NUMBER_CONSTANT;
+		bool isSwapped = false;
+		bool allowSlotSwap = false;
+		Bytecode::OpFormat format;
+	};
+
 	struct BlockInfo {
 		uint32_t index = INVALID_ID;
 		std::vector<Statement*>& block;
@@ -47,27 +102,36 @@ private:
 	Function*& new_function(const Bytecode::Prototype& prototype, const uint32_t& level);
 	Statement*& new_statement(const AST_STATEMENT& type);
 	Expression*& new_expression(const AST_EXPRESSION& type);
-	void build_functions(Function& function, uint32_t& functionCounter);
+	void reserve_block(Statement& statement, const uint32_t& size);
+	static void delete_nodes(NodePool& nodePool);
+	void delete_unused_nodes(Function& function, const uint32_t& statementBase, const uint32_t& expressionBase);
+	void build_function_trees(std::vector<NodePool>& pools, const std::vector<Function*>& functions);
+	void declare_function(Function& function);
+	void build_function(Function& function);
 	void build_instructions(Function& function);
 	void assign_debug_info(Function& function);
 	void group_jumps(Function& function);
+	template <bool isFR2>
 	void build_loops(Function& function);
+	template <bool isFR2>
 	void build_local_scopes(Function& function, std::vector<Statement*>& block);
+	template <bool isFR2>
 	void build_expressions(Function& function, std::vector<Statement*>& block);
 	void build_slot_scopes(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
 	void eliminate_slots(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
 	void eliminate_conditions(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
 	void build_multi_assignment(Function& function, std::vector<Statement*>& block);
-	void build_if_statements_from_map(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock, std::unordered_map<Statement*, uint32_t>& offsetMap);
+	void build_if_statements_from_offsets(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
 	void build_if_statements(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
 	void clean_up(Function& function);
 	void clean_up_block(Function& function, std::vector<Statement*>& block, uint32_t& variableCounter, uint32_t& iteratorCounter, BlockInfo* const& previousBlock);
+	void build_operand(Function& function, Statement& statement, Expression*& expression, const Bytecode::BC_OPERAND& operand, const uint16_t& value);
 	Expression* new_slot(const uint8_t& slot);
 	Expression* new_literal(const uint8_t& literal);
 	Expression* new_signed_literal(const uint16_t& signedLiteral);
 	Expression* new_primitive(const uint8_t& primitive);
 	Expression* new_number(const Function& function, const uint16_t& index);
-	Expression* new_string(const Function& function, const uint16_t& index);
+	Expression* new_string(Function& function, const uint16_t& index);
 	Expression* new_table(const Function& function, const uint16_t& index);
 	Expression* new_cdata(const Function& function, const uint16_t& index);
 
@@ -76,15 +140,21 @@ private:
 	static uint32_t get_label_from_next_statement(Function& function, const BlockInfo& blockInfo, const bool& returnExtendedLabel, const bool& excludeDeclaration);
 	static bool is_valid_block(Function& function, const BlockInfo& blockInfo, const uint32_t& blockBegin);
 	static void check_valid_name(Constant* const& constant);
+	bool is_infinite_number(const double& number, const bool& isCdata = false);
 	void check_special_number(Expression* const& expression, const bool& isCdata = false);
 	static CONSTANT_TYPE get_constant_type(Expression* const& expression);
 
-	const Bytecode& bytecode;
+	Bytecode& bytecode;
 	const bool ignoreDebugInfo;
 	const bool minimizeDiffs;
+	const Budget budget;
+	const uint64_t deadline;
+	std::atomic<uint64_t> nodeCount = 0;
+	std::atomic<uint64_t> memoryUsage = 0;
 	bool isFR2Enabled = false;
-	std::vector<Statement*> statements;
-	std::vector<Function*> functions;
-	std::vector<Expression*> expressions;
-	uint64_t prototypeDataLeft = 0;
+	std::vector<NodePool> nodePools;
+	std::vector<NodePool> streamNodePools;
+	std::atomic<uint64_t> prototypeDataLeft = 0;
+
+	static thread_local NodePool* nodePool;
 };
@@ -9,6 +9,54 @@ enum AST_EXPRESSION {
 	AST_EXPRESSION_UNARY_OPERATION
 };
 
+enum AST_SYMBOL {
+	AST_SYMBOL_NONE,
+	AST_SYMBOL_STRING,
+	AST_SYMBOL_ARGUMENT,
+	AST_SYMBOL_UPVALUE,
+	AST_SYMBOL_VARIABLE,
+	AST_SYMBOL_ITERATOR,
+	AST_SYMBOL_LABEL
+};
+
+struct Ast::Symbol {
+	static constexpr uint8_t MAX_SIZE = 32;
+
+	Symbol() = default;
+	Symbol(const std::string_view& string) : type(AST_SYMBOL_STRING), string(string) {}
+	Symbol(const AST_SYMBOL& type, const uint32_t& scope, const uint32_t& index) : type(type), scope(scope), index(index) {}
+
+	std::string_view format(char(&buffer)[MAX_SIZE]) const {
+		static constexpr std::string_view PREFIXES[] = { "", "", "arg_", "upvalue_", "var_", "iter_", "label_" };
+		if (type <= AST_SYMBOL_STRING) return string;
+		char* end = std::copy(PREFIXES[type].begin(), PREFIXES[type].end(), buffer);
+
+		if (type != AST_SYMBOL_UPVALUE) {
+			end = std::to_chars(end, buffer + MAX_SIZE, scope).ptr;
+			*end++ = '_';
+		}
+
+		end = std::to_chars(end, buffer + MAX_SIZE, index).ptr;
+		return std::string_view(buffer, end - buffer);
+	}
+
+	bool operator==(const std::string_view& string) const {
+		char buffer[MAX_SIZE];
+		return format(buffer) == string;
+	}
+
+	bool operator==(const Symbol& symbol) const {
+		if (type == symbol.type && type > AST_SYMBOL_STRING) return scope == symbol.scope && index == symbol.index;
+		char buffer[MAX_SIZE];
+		return symbol == format(buffer);
+	}
+
+	AST_SYMBOL type = AST_SYMBOL_NONE;
+	uint32_t scope = 0;
+	uint32_t index = 0;
+	std::string_view string;
+};
+
 struct Ast::Expression {
 	Expression(const AST_EXPRESSION& type) {
 		set_type(type);
@@ -45,6 +93,27 @@ struct Ast::Expression {
 			unaryOperation = new UnaryOperation;
 			break;
 		}
+
+		nodePool->add_memory_usage(get_payload_size());
+	}
+
+	uint64_t get_payload_size() const {
+		switch (type) {
+		case AST_EXPRESSION_CONSTANT:
+			return sizeof(Constant);
+		case AST_EXPRESSION_VARIABLE:
+			return sizeof(Variable);
+		case AST_EXPRESSION_FUNCTION_CALL:
+			return sizeof(FunctionCall);
+		case AST_EXPRESSION_TABLE:
+			return sizeof(Table);
+		case AST_EXPRESSION_BINARY_OPERATION:
+			return sizeof(BinaryOperation);
+		case AST_EXPRESSION_UNARY_OPERATION:
+			return sizeof(UnaryOperation);
+		}
+
+		return 0;
 	}
 
 	void delete_type() {
@@ -113,7 +182,7 @@ struct Ast::Constant {
 		uint64_t unsigned_integer = 0;
 	};
 
-	std::string string;
+	std::string_view string;
 	bool isName = false;
 };
 
@@ -127,8 +196,8 @@ enum AST_VARIABLE {
 struct Ast::Variable {
 	AST_VARIABLE type;
 	uint8_t slot = 0;
-	SlotScope** slotScope = nullptr;
-	std::string name;
+	SlotScope* slotScope = nullptr;
+	Symbol name;
 	Expression* table = nullptr;
 	Expression* tableIndex = nullptr;
 	bool isMultres = false;
@@ -152,6 +221,11 @@ struct Ast::Table {
 	struct {
 		std::vector<Expression*> list;
 		std::vector<Field> fields;
+		const Bytecode::Prototype* prototype = nullptr;
+		std::span<const Bytecode::TableConstant> array;
+		std::span<const Bytecode::TableNode> nodes;
+		std::vector<bool> excludedNodes;
+		uint32_t nodeCount = 0;
 	} constants;
 
 	std::vector<Field> fields;
@@ -194,7 +268,7 @@ struct Ast::UnaryOperation {
 	Expression* operand = nullptr;
 };
 
-enum AST_STATEMENT {
+enum AST_STATEMENT : uint8_t {
 	AST_STATEMENT_EMPTY,
 	AST_STATEMENT_INSTRUCTION,
 	AST_STATEMENT_RETURN,
@@ -216,31 +290,36 @@ enum AST_STATEMENT {
 };
 
 struct Ast::Statement {
-	Statement(const AST_STATEMENT& type) : type(type) {}
+	template <typename Payload>
+	struct ColdData {
+		ColdData() = default;
+		ColdData(const ColdData&) = delete;
+		ColdData& operator=(const ColdData&) = delete;
 
-	AST_STATEMENT type;
+		~ColdData() {
+			delete payload;
+		}
 
-	struct {
-		Bytecode::BC_OP type = Bytecode::BC_OP_INVALID;
-		uint8_t a = 0;
-		uint8_t b = 0;
-		uint8_t c = 0;
-		uint16_t d = 0;
-		uint32_t id = INVALID_ID;
-		uint32_t target = INVALID_ID;
-		uint32_t label = INVALID_ID;
-	} instruction;
+		Payload* create() {
+			if (payload) return payload;
+			payload = new Payload;
+			nodePool->add_memory_usage(sizeof(Payload));
+			return payload;
+		}
 
-	Function* function = nullptr;
-	std::vector<Statement*> block;
-	Local* locals = nullptr;
+		const Payload* operator->() const {
+			static const Payload EMPTY;
+			return payload ? payload : &EMPTY;
+		}
 
-	struct {
-		bool allowSlotSwap = false;
-		bool swapped = false;
-	} condition;
+		const Payload& operator*() const {
+			return *operator->();
+		}
 
-	struct {
+		Payload* payload = nullptr;
+	};
+
+	struct Assignment {
 		void register_slots(Expression*& expression) {
 			openSlots.emplace_back(&expression);
 		}
@@ -254,10 +333,36 @@ struct Ast::Statement {
 		bool isPotentialMethod = false;
 		bool isTableConstructor = false;
 		bool forwardDeclaration = false;
+
+		struct {
+			bool allowSlotSwap = false;
+			bool swapped = false;
+		} condition;
+
 		CONSTANT_TYPE allowedConstantType = NUMBER_CONSTANT;
 		std::vector<Variable> variables;
 		std::vector<Expression*> expressions;
 		std::vector<Expression**> openSlots;
 		Expression* multresReturn = nullptr;
-	} assignment;
+	};
+
+	Statement(const AST_STATEMENT& type) : type(type) {}
+
+	AST_STATEMENT type;
+
+	struct {
+		Bytecode::BC_OP type = Bytecode::BC_OP_INVALID;
+		uint8_t a = 0;
+		uint8_t b = 0;
+		uint8_t c = 0;
+		uint16_t d = 0;
+		uint32_t id = INVALID_ID;
+		uint32_t target = INVALID_ID;
+		uint32_t label = INVALID_ID;
+	} instruction;
+
+	Function* function = nullptr;
+	Local* locals = nullptr;
+	ColdData<Assignment> assignment;
+	ColdData<std::vector<Statement*>> block;
 };
@@ -56,34 +56,43 @@ struct Ast::ConditionBuilder {
 
 		uint32_t nodeLabel = INVALID_ID;
 		uint32_t targetLabel = INVALID_ID;
-		Node* targetNode = nullptr;
+		uint32_t targetNode = INVALID_ID;
 		uint32_t incomingNodes = 0;
 		bool inverted = false;
-		std::vector<Expression*>* expressions = nullptr;
-		Node* leftNode = nullptr;
-		Node* rightNode = nullptr;
+		const std::vector<Expression*>* expressions = nullptr;
+		uint32_t leftNode = INVALID_ID;
+		uint32_t rightNode = INVALID_ID;
+		uint32_t conditionIndex = INVALID_ID;
 	};
 
-	ConditionBuilder(const TYPE& type, Ast& ast, const uint32_t& endTargetLabel, const uint32_t& trueTargetLabel, const uint32_t& falseTargetLabel) : ast(ast), type(type) {
+	struct NodePool {
+		std::vector<Node> nodes;
+		std::vector<uint32_t> conditionNodes;
+		std::vector<uint32_t> labelIndices;
+		std::vector<uint32_t> previousIndices;
+		std::vector<uint32_t> nextIndices;
+		std::vector<uint32_t> mergeIndices;
+	};
+
+	ConditionBuilder(const TYPE& type, Ast& ast, const uint32_t& endTargetLabel, const uint32_t& trueTargetLabel, const uint32_t& falseTargetLabel)
+		: ast(ast), type(type), nodePool(ast.nodePool->conditionNodePool), nodes(nodePool.nodes), conditionNodes(nodePool.conditionNodes) {
+		nodes.clear();
+		conditionNodes.clear();
+
 		if (type == ASSIGNMENT) {
 			endTarget = new_node(Node::END_TARGET);
-			endTarget->nodeLabel = endTargetLabel;
+			nodes[endTarget].nodeLabel = endTargetLabel;
 		}
 
 		trueTarget = new_node(Node::TRUE_TARGET);
-		trueTarget->nodeLabel = trueTargetLabel;
+		nodes[trueTarget].nodeLabel = trueTargetLabel;
 		falseTarget = new_node(Node::FALSE_TARGET);
-		falseTarget->nodeLabel = falseTargetLabel;
+		nodes[falseTarget].nodeLabel = falseTargetLabel;
 	}
 
-	~ConditionBuilder() {
-		for (uint32_t i = nodes.size(); i--;) {
-			delete nodes[i];
-		}
-	}
-
-	Node*& new_node(const Node::TYPE& type) {
-		return nodes.emplace_back(new Node(type));
+	uint32_t new_node(const Node::TYPE& type) {
+		nodes.emplace_back(type);
+		return nodes.size() - 1;
 	}
 
 	static Node::TYPE get_node_type(const Bytecode::BC_OP& instruction, const bool& swapped) {
@@ -119,11 +128,11 @@ struct Ast::ConditionBuilder {
 		}
 	}
 
-	void add_node(const Node::TYPE& type, const uint32_t& nodeLabel, const uint32_t& targetLabel, std::vector<Expression*>* const& expressions) {
+	void add_node(const Node::TYPE& type, const uint32_t& nodeLabel, const uint32_t& targetLabel, const std::vector<Expression*>* const& expressions) {
 		conditionNodes.emplace_back(new_node(type));
-		conditionNodes.back()->nodeLabel = nodeLabel;
-		conditionNodes.back()->targetLabel = targetLabel;
-		conditionNodes.back()->expressions = expressions;
+		nodes[conditionNodes.back()].nodeLabel = nodeLabel;
+		nodes[conditionNodes.back()].targetLabel = targetLabel;
+		nodes[conditionNodes.back()].expressions = expressions;
 	}
 
 	bool link_nodes() {
@@ -139,19 +148,33 @@ struct Ast::ConditionBuilder {
 			break;
 		}
 
+		std::vector<uint32_t>& labelIndices = nodePool.labelIndices;
+		bool isLinked = true;
+
+		for (uint32_t i = 0; i < conditionNodes.size(); i++) {
+			if (nodes[conditionNodes[i]].nodeLabel == INVALID_ID) continue;
+			if (nodes[conditionNodes[i]].nodeLabel >= labelIndices.size()) labelIndices.resize(nodes[conditionNodes[i]].nodeLabel + 1, INVALID_ID);
+			labelIndices[nodes[conditionNodes[i]].nodeLabel] = i;
+		}
+
 		for (uint32_t i = conditionNodes.size(); i--;) {
-			if (conditionNodes[i]->targetLabel == INVALID_ID) continue;
+			Node& node = nodes[conditionNodes[i]];
+			if (node.targetLabel == INVALID_ID) continue;
 
-			for (uint32_t j = conditionNodes.size(); j--;) {
-				if (conditionNodes[i]->targetLabel != conditionNodes[j]->nodeLabel) continue;
-				conditionNodes[i]->targetNode = conditionNodes[j];
-				conditionNodes[j]->incomingNodes++;
+			if (node.targetLabel >= labelIndices.size() || labelIndices[node.targetLabel] == INVALID_ID) {
+				isLinked = false;
 				break;
 			}
 
-			if (!conditionNodes[i]->targetNode) return false;
+			node.targetNode = conditionNodes[labelIndices[node.targetLabel]];
+			nodes[node.targetNode].incomingNodes++;
+		}
+
+		for (uint32_t i = conditionNodes.size(); i--;) {
+			if (nodes[conditionNodes[i]].nodeLabel != INVALID_ID) labelIndices[nodes[conditionNodes[i]].nodeLabel] = INVALID_ID;
 		}
 
+		if (!isLinked) return false;
 		conditionNodes.pop_back();
 		if (type == ASSIGNMENT) conditionNodes.pop_back();
 		return true;
@@ -161,18 +184,20 @@ struct Ast::ConditionBuilder {
 		switch (type) {
 		case ASSIGNMENT:
 			for (uint32_t i = conditionNodes.size() - 1; i--;) {
-				switch (conditionNodes[i]->targetNode->type) {
+				Node& node = nodes[conditionNodes[i]];
+
+				switch (nodes[node.targetNode].type) {
 				case Node::END_TARGET:
-					conditionNodes[i]->targetNode = conditionNodes[i]->type == Node::TRUTHY_TEST ? trueTarget : falseTarget;
-					conditionNodes[i]->targetNode->incomingNodes++;
-					conditionNodes[i]->inverted = conditionNodes[i]->type == Node::FALSY_TEST;
+					node.targetNode = node.type == Node::TRUTHY_TEST ? trueTarget : falseTarget;
+					nodes[node.targetNode].incomingNodes++;
+					node.inverted = node.type == Node::FALSY_TEST;
 					continue;
 				case Node::TRUE_TARGET:
-					if (conditionNodes[i]->type == Node::TRUTHY_TEST) conditionNodes[i]->type = Node::BOOL_TRUTHY_TEST;
+					if (node.type == Node::TRUTHY_TEST) node.type = Node::BOOL_TRUTHY_TEST;
 					continue;
 				case Node::FALSE_TARGET:
-					if (conditionNodes[i]->type == Node::FALSY_TEST) conditionNodes[i]->type = Node::BOOL_FALSY_TEST;
-					conditionNodes[i]->inverted = true;
+					if (node.type == Node::FALSY_TEST) node.type = Node::BOOL_FALSY_TEST;
+					node.inverted = true;
 					continue;
 				}
 			}
@@ -180,125 +205,182 @@ struct Ast::ConditionBuilder {
 			break;
 		case STATEMENT:
 			for (uint32_t i = conditionNodes.size() - 1; i--;) {
-				if (conditionNodes[i]->targetNode->type == Node::FALSE_TARGET) conditionNodes[i]->inverted = true;
+				if (nodes[nodes[conditionNodes[i]].targetNode].type == Node::FALSE_TARGET) nodes[conditionNodes[i]].inverted = true;
 			}
 
-			if (conditionNodes[conditionNodes.size() - 2]->inverted) break;
-			conditionNodes[conditionNodes.size() - 2]->leftNode = copy_node(conditionNodes[conditionNodes.size() - 2]);
-			conditionNodes[conditionNodes.size() - 2]->rightNode = new_node(Node::UNCONDITIONAL);
-			conditionNodes[conditionNodes.size() - 2]->targetNode->incomingNodes--;
-			conditionNodes[conditionNodes.size() - 2]->targetNode = falseTarget;
-			conditionNodes[conditionNodes.size() - 2]->targetNode->incomingNodes++;
-			conditionNodes[conditionNodes.size() - 2]->type = Node::NOT_OR;
-			conditionNodes[conditionNodes.size() - 2]->inverted = true;
+			if (nodes[conditionNodes[conditionNodes.size() - 2]].inverted) break;
+			const uint32_t leftNode = copy_node(conditionNodes[conditionNodes.size() - 2]);
+			const uint32_t rightNode = new_node(Node::UNCONDITIONAL);
+			Node& node = nodes[conditionNodes[conditionNodes.size() - 2]];
+			node.leftNode = leftNode;
+			node.rightNode = rightNode;
+			nodes[node.targetNode].incomingNodes--;
+			node.targetNode = falseTarget;
+			nodes[node.targetNode].incomingNodes++;
+			node.type = Node::NOT_OR;
+			node.inverted = true;
 			break;
 		}
 	}
 
 	bool build_boolean_logic() {
-		for (uint32_t i = conditionNodes.size() - 1; --i;) {
-			if (conditionNodes[i - 1]->targetNode == conditionNodes[i] && conditionNodes[i]->incomingNodes == 1) {
-				if (Node::TYPE_PREFERENCE[conditionNodes[i - 1]->type][conditionNodes[i - 1]->inverted] != 3) invert_node(conditionNodes[i - 1]);
-				conditionNodes[i - 1]->leftNode = copy_node(conditionNodes[i - 1]);
-				conditionNodes[i - 1]->rightNode = new_node(Node::UNCONDITIONAL);
-				conditionNodes[i - 1]->rightNode->inverted = conditionNodes[i - 1]->inverted;
-				conditionNodes[i - 1]->type = conditionNodes[i - 1]->inverted ? Node::AND : Node::OR;
-				merge_nodes(conditionNodes[i - 1], conditionNodes[i]);
-				conditionNodes[i - 1]->type = conditionNodes[i - 1]->leftNode->inverted ? (conditionNodes[i - 1]->inverted ? Node::NOT_OR : Node::OR) : (conditionNodes[i - 1]->inverted ? Node::NOT_AND : Node::AND);
-				conditionNodes[i - 1]->leftNode->inverted = false;
-				conditionNodes.erase(conditionNodes.begin() + i);
-				i = conditionNodes.size() - 1;
-			} else if (!conditionNodes[i]->incomingNodes) {
-				if (conditionNodes[i - 1]->targetNode == conditionNodes[i]->targetNode) {
-					if (conditionNodes[i - 1]->inverted != conditionNodes[i]->inverted && !invert_any_node(conditionNodes[i - 1], conditionNodes[i])) return false;
-					merge_nodes(conditionNodes[i - 1], conditionNodes[i]);
-					conditionNodes[i - 1]->type = conditionNodes[i - 1]->inverted ? Node::NOT_AND : Node::OR;
-					conditionNodes.erase(conditionNodes.begin() + i);
-					i = conditionNodes.size() - 1;
-				} else if (conditionNodes[i - 1]->targetNode == conditionNodes[i + 1]) {
-					if (conditionNodes[i - 1]->inverted == conditionNodes[i]->inverted && !invert_any_node(conditionNodes[i - 1], conditionNodes[i])) return false;
-					merge_nodes(conditionNodes[i - 1], conditionNodes[i]);
-					conditionNodes[i - 1]->type = conditionNodes[i - 1]->inverted ? Node::NOT_OR : Node::AND;
-					conditionNodes.erase(conditionNodes.begin() + i);
-					i = conditionNodes.size() - 1;
-				}
+		std::vector<uint32_t>& previousIndices = nodePool.previousIndices;
+		std::vector<uint32_t>& nextIndices = nodePool.nextIndices;
+		std::vector<uint32_t>& mergeIndices = nodePool.mergeIndices;
+		previousIndices.resize(conditionNodes.size());
+		nextIndices.resize(conditionNodes.size());
+		mergeIndices.clear();
+
+		for (uint32_t i = 0; i < conditionNodes.size(); i++) {
+			nodes[conditionNodes[i]].conditionIndex = i;
+			previousIndices[i] = i ? i - 1 : INVALID_ID;
+			nextIndices[i] = i + 1 < conditionNodes.size() ? i + 1 : INVALID_ID;
+			if (i && i + 1 < conditionNodes.size()) mergeIndices.emplace_back(i);
+		}
+
+		std::make_heap(mergeIndices.begin(), mergeIndices.end());
+
+		const auto is_mergeable = [&](const uint32_t& index)->bool {
+			if (previousIndices[index] == INVALID_ID || nextIndices[index] == INVALID_ID) return false;
+			const Node& previousNode = nodes[conditionNodes[previousIndices[index]]];
+			const Node& node = nodes[conditionNodes[index]];
+			if (previousNode.targetNode == conditionNodes[index]) return node.incomingNodes == 1;
+			return !node.incomingNodes && (previousNode.targetNode == node.targetNode || previousNode.targetNode == conditionNodes[nextIndices[index]]);
+		};
+
+		uint32_t index, previousIndex, node, targetNode, previousTarget;
+
+		while (mergeIndices.size()) {
+			ast.check_budget();
+			std::pop_heap(mergeIndices.begin(), mergeIndices.end());
+			index = mergeIndices.back();
+			mergeIndices.pop_back();
+			if (!is_mergeable(index)) continue;
+			previousIndex = previousIndices[index];
+			node = conditionNodes[previousIndex];
+			targetNode = conditionNodes[index];
+			previousTarget = nodes[node].targetNode;
+
+			if (nodes[node].targetNode == targetNode) {
+				if (Node::TYPE_PREFERENCE[nodes[node].type][nodes[node].inverted] != 3) invert_node(node);
+				const uint32_t leftNode = copy_node(node);
+				const uint32_t rightNode = new_node(Node::UNCONDITIONAL);
+				nodes[node].leftNode = leftNode;
+				nodes[node].rightNode = rightNode;
+				nodes[rightNode].inverted = nodes[node].inverted;
+				nodes[node].type = nodes[node].inverted ? Node::AND : Node::OR;
+				merge_nodes(node, targetNode);
+				nodes[node].type = nodes[nodes[node].leftNode].inverted ? (nodes[node].inverted ? Node::NOT_OR : Node::OR) : (nodes[node].inverted ? Node::NOT_AND : Node::AND);
+				nodes[nodes[node].leftNode].inverted = false;
+			} else if (nodes[node].targetNode == nodes[targetNode].targetNode) {
+				if (nodes[node].inverted != nodes[targetNode].inverted && !invert_any_node(node, targetNode)) return false;
+				merge_nodes(node, targetNode);
+				nodes[node].type = nodes[node].inverted ? Node::NOT_AND : Node::OR;
+			} else {
+				if (nodes[node].inverted == nodes[targetNode].inverted && !invert_any_node(node, targetNode)) return false;
+				merge_nodes(node, targetNode);
+				nodes[node].type = nodes[node].inverted ? Node::NOT_OR : Node::AND;
 			}
+
+			nextIndices[previousIndex] = nextIndices[index];
+			previousIndices[nextIndices[index]] = previousIndex;
+			previousIndices[index] = INVALID_ID;
+			nextIndices[index] = INVALID_ID;
+			mergeIndices.emplace_back(previousIndex);
+			std::push_heap(mergeIndices.begin(), mergeIndices.end());
+			mergeIndices.emplace_back(nextIndices[previousIndex]);
+			std::push_heap(mergeIndices.begin(), mergeIndices.end());
+			if (nodes[previousTarget].conditionIndex == INVALID_ID) continue;
+			mergeIndices.emplace_back(nodes[previousTarget].conditionIndex);
+			std::push_heap(mergeIndices.begin(), mergeIndices.end());
 		}
 
-		conditionNodes.pop_back();
+		uint32_t conditionCount = 1;
+
+		for (index = nextIndices.front(); index != INVALID_ID; index = nextIndices[index]) {
+			conditionNodes[conditionCount++] = conditionNodes[index];
+		}
+
+		conditionNodes.resize(conditionCount - 1);
 		return conditionNodes.size() == 1;
 	}
 
-	static bool invert_any_node(Node* const& leftNode, Node* const& rightNode) {
-		if (leftNode->targetNode->type < Node::END_TARGET) {
-			invert_node(rightNode->targetNode->type > Node::END_TARGET || Node::TYPE_PREFERENCE[leftNode->type][!leftNode->inverted] >= Node::TYPE_PREFERENCE[rightNode->type][!rightNode->inverted] ? leftNode : rightNode);
+	bool invert_any_node(const uint32_t& leftNode, const uint32_t& rightNode) {
+		if (nodes[nodes[leftNode].targetNode].type < Node::END_TARGET) {
+			invert_node(nodes[nodes[rightNode].targetNode].type > Node::END_TARGET
+				|| Node::TYPE_PREFERENCE[nodes[leftNode].type][!nodes[leftNode].inverted] >= Node::TYPE_PREFERENCE[nodes[rightNode].type][!nodes[rightNode].inverted] ? leftNode : rightNode);
 		} else {
-			if (rightNode->targetNode->type > Node::END_TARGET) return false;
+			if (nodes[nodes[rightNode].targetNode].type > Node::END_TARGET) return false;
 			invert_node(rightNode);
 		}
 
 		return true;
 	}
 
-	static void invert_node(Node* const& node) {
-		node->inverted = !node->inverted;
-		if (Node::TYPE_PREFERENCE[node->type][node->inverted]) return;
-		invert_node(node->leftNode);
-		invert_node(node->rightNode);
-		node->type = node->inverted ? (node->type == Node::AND ? Node::NOT_OR : Node::NOT_AND) : (node->type == Node::NOT_AND ? Node::OR : Node::AND);
+	void invert_node(const uint32_t& index) {
+		Node& node = nodes[index];
+		node.inverted = !node.inverted;
+		if (Node::TYPE_PREFERENCE[node.type][node.inverted]) return;
+		invert_node(node.leftNode);
+		invert_node(node.rightNode);
+		node.type = node.inverted ? (node.type == Node::AND ? Node::NOT_OR : Node::NOT_AND) : (node.type == Node::NOT_AND ? Node::OR : Node::AND);
 	}
 
-	Node* copy_node(Node* const& node) {
-		Node* const copy = new_node(node->type);
-		copy->inverted = node->inverted;
-		copy->expressions = node->expressions;
-		copy->leftNode = node->leftNode;
-		copy->rightNode = node->rightNode;
+	uint32_t copy_node(const uint32_t& index) {
+		const uint32_t copy = new_node(nodes[index].type);
+		nodes[copy].inverted = nodes[index].inverted;
+		nodes[copy].expressions = nodes[index].expressions;
+		nodes[copy].leftNode = nodes[index].leftNode;
+		nodes[copy].rightNode = nodes[index].rightNode;
 		return copy;
 	}
 
-	void merge_nodes(Node* const& node, Node* const& targetNode) {
-		node->leftNode = copy_node(node);
-		node->rightNode = targetNode;
-		node->targetNode->incomingNodes--;
-		node->targetNode = targetNode->targetNode;
-		node->inverted = targetNode->inverted;
+	void merge_nodes(const uint32_t& index, const uint32_t& targetIndex) {
+		const uint32_t copy = copy_node(index);
+		Node& node = nodes[index];
+		node.leftNode = copy;
+		node.rightNode = targetIndex;
+		nodes[node.targetNode].incomingNodes--;
+		node.targetNode = nodes[targetIndex].targetNode;
+		node.inverted = nodes[targetIndex].inverted;
 	}
 
-	Expression* build_expression(Node* const& node) {
-		switch (node->type) {
+	Expression* build_expression(const uint32_t& index) {
+		const Node& node = nodes[index];
+
+		switch (node.type) {
 		case Node::LESS_THAN:
 		case Node::LESS_EQUAL:
 		case Node::GREATER_THEN:
 		case Node::GREATER_EQUAL:
-			return node->inverted ? build_not(build_binary(node->type, (*node->expressions)[0], (*node->expressions)[1])) : build_binary(node->type, (*node->expressions)[0], (*node->expressions)[1]);
+			return node.inverted ? build_not(build_binary(node.type, (*node.expressions)[0], (*node.expressions)[1])) : build_binary(node.type, (*node.expressions)[0], (*node.expressions)[1]);
 		case Node::NOT_LESS_THAN:
 		case Node::NOT_LESS_EQUAL:
 		case Node::NOT_GREATER_THEN:
 		case Node::NOT_GREATER_EQUAL:
-			return node->inverted ? build_binary(node->type, (*node->expressions)[0], (*node->expressions)[1]) : build_not(build_binary(node->type, (*node->expressions)[0], (*node->expressions)[1]));
+			return node.inverted ? build_binary(node.type, (*node.expressions)[0], (*node.expressions)[1]) : build_not(build_binary(node.type, (*node.expressions)[0], (*node.expressions)[1]));
 		case Node::EQUAL:
-			return build_binary(node->inverted ? Node::NOT_EQUAL : Node::EQUAL, (*node->expressions)[0], (*node->expressions)[1]);
+			return build_binary(node.inverted ? Node::NOT_EQUAL : Node::EQUAL, (*node.expressions)[0], (*node.expressions)[1]);
 		case Node::NOT_EQUAL:
-			return build_binary(node->inverted ? Node::EQUAL : Node::NOT_EQUAL, (*node->expressions)[0], (*node->expressions)[1]);
+			return build_binary(node.inverted ? Node::EQUAL : Node::NOT_EQUAL, (*node.expressions)[0], (*node.expressions)[1]);
 		case Node::TRUTHY_TEST:
-			return node->inverted ? build_not((*node->expressions).back()) : (*node->expressions).back();
+			return node.inverted ? build_not((*node.expressions).back()) : (*node.expressions).back();
 		case Node::FALSY_TEST:
-			return node->inverted ? (*node->expressions).back() : build_not((*node->expressions).back());
+			return node.inverted ? (*node.expressions).back() : build_not((*node.expressions).back());
 		case Node::BOOL_TRUTHY_TEST:
-			return node->inverted ? build_not((*node->expressions).back()) : build_not(build_not((*node->expressions).back()));
+			return node.inverted ? build_not((*node.expressions).back()) : build_not(build_not((*node.expressions).back()));
 		case Node::BOOL_FALSY_TEST:
-			return node->inverted ? build_not(build_not((*node->expressions).back())) : build_not((*node->expressions).back());
+			return node.inverted ? build_not(build_not((*node.expressions).back())) : build_not((*node.expressions).back());
 		case Node::UNCONDITIONAL:
-			return ast.new_primitive(node->inverted ? 1 : 2);
+			return ast.new_primitive(node.inverted ? 1 : 2);
 		case Node::AND:
 		case Node::OR:
-			return node->inverted ? build_not(build_binary(node->type, build_expression(node->leftNode), build_expression(node->rightNode)))
-				: build_binary(node->type, build_expression(node->leftNode), build_expression(node->rightNode));
+			return node.inverted ? build_not(build_binary(node.type, build_expression(node.leftNode), build_expression(node.rightNode)))
+				: build_binary(node.type, build_expression(node.leftNode), build_expression(node.rightNode));
 		case Node::NOT_AND:
 		case Node::NOT_OR:
-			return node->inverted ? build_binary(node->type, build_expression(node->leftNode), build_expression(node->rightNode))
-				: build_not(build_binary(node->type, build_expression(node->leftNode), build_expression(node->rightNode)));
+			return node.inverted ? build_binary(node.type, build_expression(node.leftNode), build_expression(node.rightNode))
+				: build_not(build_binary(node.type, build_expression(node.leftNode), build_expression(node.rightNode)));
 		default:
 			throw nullptr;
 		}
@@ -364,9 +446,10 @@ struct Ast::ConditionBuilder {
 	}
 
 	Ast& ast;
-	std::vector<Node*> nodes;
-	std::vector<Node*> conditionNodes;
-	Node* endTarget = nullptr;
-	Node* trueTarget = nullptr;
-	Node* falseTarget = nullptr;
+	NodePool& nodePool;
+	std::vector<Node>& nodes;
+	std::vector<uint32_t>& conditionNodes;
+	uint32_t endTarget = INVALID_ID;
+	uint32_t trueTarget = INVALID_ID;
+	uint32_t falseTarget = INVALID_ID;
 };
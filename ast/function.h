@@ -1,5 +1,5 @@
 struct Ast::Local {
-	std::vector<std::string> names;
+	std::vector<Symbol> names;
 	uint8_t baseSlot = 0;
 	uint32_t scopeBegin = INVALID_ID;
 	uint32_t scopeEnd = INVALID_ID;
@@ -7,9 +7,28 @@ struct Ast::Local {
 };
 
 struct Ast::SlotScope {
-	SlotScope* slotScope = this;
-	std::vector<SlotScope**> mergedScopes;
-	std::string name;
+	SlotScope* operator->() {
+		return find();
+	}
+
+	SlotScope* find() {
+		SlotScope* root = parent;
+
+		while (root->parent != root) {
+			root = root->parent;
+		}
+
+		for (SlotScope* slotScope = this, * nextSlotScope; slotScope->parent != root; slotScope = nextSlotScope) {
+			nextSlotScope = slotScope->parent;
+			slotScope->parent = root;
+		}
+
+		return root;
+	}
+
+	SlotScope* parent = this;
+	uint8_t rank = 0;
+	Symbol name;
 	uint32_t scopeBegin = INVALID_ID;
 	uint32_t scopeEnd = INVALID_ID;
 	uint32_t usages = 0;
@@ -18,16 +37,32 @@ struct Ast::SlotScope {
 struct Ast::Function {
 	struct Upvalue {
 		uint8_t slot = 0;
-		SlotScope** slotScope = nullptr;
+		SlotScope* slotScope = nullptr;
 		bool local = false;
 	};
 
 	struct Label {
-		std::string name;
+		Symbol name;
 		uint32_t target = INVALID_ID;
 		std::vector<uint32_t> jumpIds;
 	};
 
+	static bool is_before_label(const uint32_t& id, const Label& label) {
+		return id < label.target;
+	}
+
+	static bool is_after_label(const Label& label, const uint32_t& id) {
+		return label.target < id;
+	}
+
+	static constexpr uint8_t UNCHECKED_NAME = 2;
+
+	struct BlockOffset {
+		const Statement* statement = nullptr;
+		uint32_t id = INVALID_ID;
+		uint32_t offset = 0;
+	};
+
 	Function(const Bytecode::Prototype& prototype, const uint32_t& level, const bool& ignoreDebugInfo)
 		: prototype(prototype), isVariadic(prototype.header.flags& Bytecode::BC_PROTO_VARARG), level(level), hasDebugInfo(!ignoreDebugInfo && prototype.header.hasDebugInfo) {
 		slotScopeCollector.slotInfos.resize(prototype.header.framesize);
@@ -50,57 +85,113 @@ struct Ast::Function {
 		return prototype.constants[prototype.constants.size() - 1 - index];
 	}
 
+	std::string_view get_string_constant(const uint16_t& index) const {
+		return prototype.get_string(get_constant(index).string);
+	}
+
+	bool is_name_constant(const uint16_t& index) {
+		if (!nameConstants.size()) nameConstants.resize(prototype.constants.size(), UNCHECKED_NAME);
+		uint8_t& nameConstant = nameConstants[prototype.constants.size() - 1 - index];
+		if (nameConstant == UNCHECKED_NAME) nameConstant = is_valid_name(get_string_constant(index));
+		return nameConstant;
+	}
+
 	const Bytecode::NumberConstant& get_number_constant(const uint16_t& index) const {
 		return prototype.numberConstants[index];
 	}
 
 	void add_jump(const uint32_t& id, const uint32_t& target) {
-		for (uint32_t i = 0; i < labels.size(); i++) {
-			if (target > labels[i].target) continue;
-
-			if (target != labels[i].target) {
-				labels.emplace(labels.begin() + i);
-				labels[i].target = target;
+		if (target >= labelIndices.size()) labelIndices.resize(std::max<uint32_t>(target + 1, prototype.instructions.size() + 2), INVALID_ID);
+		uint32_t label = labelIndices[target];
+
+		if (!hasSortedLabels) {
+			if (label == INVALID_ID) {
+				label = labelIndices[target] = labels.size();
+				labels.emplace_back();
+				labels.back().target = target;
 			}
 
-			for (uint32_t j = 0; j < labels[i].jumpIds.size(); j++) {
-				if (id > labels[i].jumpIds[j]) continue;
-				if (id < labels[i].jumpIds[j]) labels[i].jumpIds.emplace(labels[i].jumpIds.begin() + j, id);
-				return;
+			labels[label].jumpIds.emplace_back(id);
+			return;
+		}
+
+		if (label == INVALID_ID) {
+			label = std::lower_bound(labels.begin(), labels.end(), target, is_after_label) - labels.begin();
+			labels.emplace(labels.begin() + label);
+			labels[label].target = target;
+
+			for (uint32_t i = label; i < labels.size(); i++) {
+				labelIndices[labels[i].target] = i;
 			}
+		}
 
-			labels[i].jumpIds.emplace_back(id);
-			return;
+		const std::vector<uint32_t>::iterator jumpId = std::lower_bound(labels[label].jumpIds.begin(), labels[label].jumpIds.end(), id);
+		if (jumpId == labels[label].jumpIds.end() || *jumpId != id) labels[label].jumpIds.emplace(jumpId, id);
+	}
+
+	void sort_labels() {
+		std::sort(labels.begin(), labels.end(), [](const Label& first, const Label& second)->bool { return first.target < second.target; });
+
+		for (uint32_t i = labels.size(); i--;) {
+			std::sort(labels[i].jumpIds.begin(), labels[i].jumpIds.end());
+			labels[i].jumpIds.erase(std::unique(labels[i].jumpIds.begin(), labels[i].jumpIds.end()), labels[i].jumpIds.end());
+			labels[i].jumpIds.shrink_to_fit();
+			labelIndices[labels[i].target] = i;
 		}
 
-		labels.emplace_back();
-		labels.back().target = target;
-		labels.back().jumpIds.emplace_back(id);
+		labels.shrink_to_fit();
+		hasSortedLabels = true;
 	}
 
 	void remove_jump(const uint32_t& id, const uint32_t& target) {
-		for (uint32_t i = labels.size(); i--;) {
-			if (labels[i].target != target) continue;
+		const uint32_t label = get_label_from_id(target);
+		if (label == INVALID_ID) return;
+		const std::vector<uint32_t>::iterator jumpId = std::lower_bound(labels[label].jumpIds.begin(), labels[label].jumpIds.end(), id);
+		if (jumpId != labels[label].jumpIds.end() && *jumpId == id) labels[label].jumpIds.erase(jumpId);
+	}
 
-			for (uint32_t j = labels[i].jumpIds.size(); j--;) {
-				if (labels[i].jumpIds[j] != id) continue;
-				labels[i].jumpIds.erase(labels[i].jumpIds.begin() + j);
-				return;
-			}
-		}
+	uint32_t get_label_from_id(const uint32_t& id) const {
+		return id < labelIndices.size() ? labelIndices[id] : INVALID_ID;
+	}
+
+	bool is_valid_label(const uint32_t& label) {
+		return label != INVALID_ID && labels[label].jumpIds.size();
 	}
 
-	uint32_t get_label_from_id(const uint32_t& id) {
-		for (uint32_t i = labels.size(); i-- && labels[i].target >= id;) {
-			if (labels[i].target != id) continue;
-			return i;
+	uint32_t get_block_offset_index(const Statement* const& statement) const {
+		if (statement->instruction.id < blockOffsetIndices.size()) {
+			const uint32_t& index = blockOffsetIndices[statement->instruction.id];
+			if (index == INVALID_ID) return INVALID_ID;
+			if (blockOffsets[index].statement == statement) return index;
+		}
+
+		for (uint32_t i = blockOffsets.size(); i--;) {
+			if (blockOffsets[i].statement == statement) return i;
 		}
 
 		return INVALID_ID;
 	}
 
-	bool is_valid_label(const uint32_t& label) {
-		return label != INVALID_ID && labels[label].jumpIds.size();
+	bool has_block_offset(const Statement* const& statement) const {
+		return get_block_offset_index(statement) != INVALID_ID;
+	}
+
+	uint32_t get_block_offset(const Statement* const& statement) const {
+		return blockOffsets[get_block_offset_index(statement)].offset;
+	}
+
+	void add_block_offset(const Statement* const& statement, const uint32_t& offset) {
+		if (has_block_offset(statement)) return;
+		if (statement->instruction.id < blockOffsetIndices.size() && blockOffsetIndices[statement->instruction.id] == INVALID_ID) blockOffsetIndices[statement->instruction.id] = blockOffsets.size();
+		blockOffsets.emplace_back(BlockOffset{ .statement = statement, .id = statement->instruction.id, .offset = offset });
+	}
+
+	void clear_block_offsets(const uint32_t& offsetBase) {
+		for (uint32_t i = blockOffsets.size(); i-- > offsetBase;) {
+			if (blockOffsets[i].id < blockOffsetIndices.size() && blockOffsetIndices[blockOffsets[i].id] == i) blockOffsetIndices[blockOffsets[i].id] = INVALID_ID;
+		}
+
+		blockOffsets.resize(offsetBase);
 	}
 
 	uint32_t get_scope_begin_from_label(const uint32_t& label, const uint32_t& scopeEnd) {
@@ -124,9 +215,8 @@ struct Ast::Function {
 	}
 
 	bool is_valid_block_range(const uint32_t& blockBegin, const uint32_t& blockEnd, const bool& ignoreFrontLabel) {
-		for (uint32_t i = labels.size(); i-- && labels[i].target >= blockBegin;) {
-			if (labels[i].target <= blockEnd
-				&& labels[i].jumpIds.size()
+		for (uint32_t i = std::upper_bound(labels.begin(), labels.end(), blockEnd, is_before_label) - labels.begin(); i-- && labels[i].target >= blockBegin;) {
+			if (labels[i].jumpIds.size()
 				&& ((labels[i].jumpIds.front() < blockBegin
 						&& (labels[i].target != blockBegin
 							|| !ignoreFrontLabel))
@@ -145,10 +235,16 @@ struct Ast::Function {
 	std::vector<Local> locals;
 	std::vector<Upvalue> upvalues;
 	std::vector<Label> labels;
-	std::vector<std::string> parameterNames;
+	std::vector<uint32_t> labelIndices;
+	bool hasSortedLabels = false;
+	std::vector<Symbol> parameterNames;
 	std::vector<Statement*> block;
 	std::vector<Function*> childFunctions;
-	std::vector<const std::string*> usedGlobals;
+	std::vector<std::string_view> usedGlobals;
+	std::string declaredNames;
+	std::vector<uint8_t> nameConstants;
+	std::vector<BlockOffset> blockOffsets;
+	std::vector<uint32_t> blockOffsetIndices;
 
 	struct SlotScopeCollector {
 		struct UpvalueInfo {
@@ -162,6 +258,8 @@ struct Ast::Function {
 			uint32_t target = INVALID_ID;
 			std::vector<uint8_t> upvalues;
 			uint8_t baseSlot = 0;
+			bool isLoopEnd = false;
+			uint32_t sequence = 0;
 		};
 
 		struct UpvalueScope {
@@ -170,123 +268,191 @@ struct Ast::Function {
 			uint32_t minScopeEnd = INVALID_ID;
 		};
 
+		struct TargetRange {
+			uint32_t min = INVALID_ID;
+			uint32_t max = 0;
+		};
+
 		struct SlotInfo {
 			bool isParameter = false;
-			SlotScope** activeSlotScope = nullptr;
+			SlotScope* activeSlotScope = nullptr;
 			uint32_t minScopeBegin = INVALID_ID;
-			std::vector<SlotScope**> slotScopes;
+			std::vector<SlotScope*> slotScopes;
 		};
 
-		SlotScope** new_slot_scope() {
-			return &slotScopes.emplace_back(new SlotScope)->slotScope;
+		SlotScope* new_slot_scope() {
+			return slotScopes.emplace_back(new SlotScope);
 		}
 
-		uint32_t add_upvalue_info(const uint32_t& id, const UpvalueInfo::TYPE& type) {
-			for (uint32_t i = 0; i < upvalueInfos.size(); i++) {
-				if (id > upvalueInfos[i].id) continue;
-				upvalueInfos.emplace(upvalueInfos.begin() + i);
-				upvalueInfos[i].type = type;
-				upvalueInfos[i].id = id;
-				return i;
+		static void merge_scope(SlotScope* const& targetSlotScope, SlotScope* const& slotScope) {
+			SlotScope* const target = targetSlotScope->find();
+			SlotScope* const source = slotScope->find();
+			if (target == source) return;
+
+			if (source->rank > target->rank) {
+				source->name = std::move(target->name);
+				source->scopeBegin = target->scopeBegin;
+				source->scopeEnd = target->scopeEnd;
+				source->usages = target->usages;
+				target->parent = source;
+				return;
 			}
 
+			if (source->rank == target->rank) target->rank++;
+			source->parent = target;
+		}
+
+		void flatten_scopes() {
+			for (uint32_t i = slotScopes.size(); i--;) {
+				slotScopes[i]->find();
+			}
+		}
+
+		UpvalueInfo& add_upvalue_info(const uint32_t& id, const UpvalueInfo::TYPE& type) {
 			upvalueInfos.emplace_back();
 			upvalueInfos.back().type = type;
 			upvalueInfos.back().id = id;
-			return upvalueInfos.size() - 1;
+			upvalueInfos.back().sequence = upvalueInfos.size() - 1;
+			return upvalueInfos.back();
 		}
 
 		void add_upvalues(const uint32_t& id, std::vector<uint8_t>& upvalues) {
-			upvalueInfos[add_upvalue_info(id, UpvalueInfo::UPVALUES)].upvalues = upvalues;
+			add_upvalue_info(id, UpvalueInfo::UPVALUES).upvalues = upvalues;
 		}
 
 		void add_jump(const uint32_t& id, const uint32_t& target) {
-			upvalueInfos[add_upvalue_info(id, UpvalueInfo::JUMP)].target = target;
+			add_upvalue_info(id, UpvalueInfo::JUMP).target = target;
 		}
 
 		void add_upvalue_close(const uint32_t& id, const uint32_t& target, const uint8_t& baseSlot) {
-			const uint32_t index = add_upvalue_info(id, UpvalueInfo::UPVALUE_CLOSE);
-			upvalueInfos[index].target = target;
-			upvalueInfos[index].baseSlot = baseSlot;
+			UpvalueInfo& upvalueInfo = add_upvalue_info(id, UpvalueInfo::UPVALUE_CLOSE);
+			upvalueInfo.target = target;
+			upvalueInfo.baseSlot = baseSlot;
 		}
 
 		void add_loop(const uint32_t& id, const uint32_t& target) {
-			uint32_t index = add_upvalue_info(id, UpvalueInfo::JUMP);
-			upvalueInfos[index].target = target;
+			add_upvalue_info(id, UpvalueInfo::JUMP).target = target;
+			UpvalueInfo& loopEnd = add_upvalue_info(target - 1, UpvalueInfo::JUMP);
+			loopEnd.target = id;
+			loopEnd.isLoopEnd = true;
+		}
+
+		void sort_upvalue_infos() {
+			std::sort(upvalueInfos.begin(), upvalueInfos.end(), [](const UpvalueInfo& first, const UpvalueInfo& second)->bool {
+				if (first.id != second.id) return first.id < second.id;
+				if (first.isLoopEnd != second.isLoopEnd) return second.isLoopEnd;
+				return first.isLoopEnd ? first.sequence < second.sequence : first.sequence > second.sequence;
+			});
+
+			jumpTargets.assign(upvalueInfos.size() * 2, TargetRange{});
+			closeIndices.clear();
+
+			for (uint32_t i = upvalueInfos.size(); i--;) {
+				switch (upvalueInfos[i].type) {
+				case UpvalueInfo::JUMP:
+					jumpTargets[upvalueInfos.size() + i] = { .min = upvalueInfos[i].target, .max = upvalueInfos[i].target };
+					continue;
+				case UpvalueInfo::UPVALUE_CLOSE:
+					closeIndices.emplace_back(i);
+					continue;
+				}
+			}
+
+			std::reverse(closeIndices.begin(), closeIndices.end());
 
-			do {
-				index++;
-			} while (index < upvalueInfos.size() && upvalueInfos[index].id < target);
+			for (uint32_t i = upvalueInfos.size(); --i;) {
+				jumpTargets[i].min = std::min(jumpTargets[i * 2].min, jumpTargets[i * 2 + 1].min);
+				jumpTargets[i].max = std::max(jumpTargets[i * 2].max, jumpTargets[i * 2 + 1].max);
+			}
+		}
+
+		TargetRange get_jump_targets(uint32_t begin, uint32_t end) {
+			TargetRange targetRange;
+
+			for (begin += upvalueInfos.size(), end += upvalueInfos.size(); begin < end; begin >>= 1, end >>= 1) {
+				if (begin & 1) {
+					targetRange.min = std::min(targetRange.min, jumpTargets[begin].min);
+					targetRange.max = std::max(targetRange.max, jumpTargets[begin].max);
+					begin++;
+				}
+
+				if (end & 1) {
+					end--;
+					targetRange.min = std::min(targetRange.min, jumpTargets[end].min);
+					targetRange.max = std::max(targetRange.max, jumpTargets[end].max);
+				}
+			}
 
-			upvalueInfos.emplace(upvalueInfos.begin() + index);
-			upvalueInfos[index].id = target - 1;
-			upvalueInfos[index].target = id;
+			return targetRange;
 		}
 
-		void add_upvalue_scope(const uint8_t& slot, const uint32_t& minScopeBegin, const uint32_t& minScopeEnd) {
-			for (uint32_t i = 0; i < upvalueScopes.size(); i++) {
-				if (minScopeEnd > upvalueScopes[i].minScopeEnd) continue;
-				upvalueScopes.emplace(upvalueScopes.begin() + i);
-				upvalueScopes[i].slot = slot;
-				upvalueScopes[i].minScopeBegin = minScopeBegin;
-				upvalueScopes[i].minScopeEnd = minScopeEnd;
-				return;
+		void add_jump_targets(UpvalueScope& upvalueScope, const TargetRange& targetRange) {
+			if (targetRange.min > targetRange.max) return;
+			if (upvalueScope.minScopeEnd < targetRange.max) upvalueScope.minScopeEnd = targetRange.max;
+			if (upvalueScope.minScopeBegin >= targetRange.min) upvalueScope.minScopeBegin = targetRange.min - 1;
+		}
+
+		void extend_upvalue_scope_backwards(UpvalueScope& upvalueScope, uint32_t& index) {
+			uint32_t lowerIndex;
+
+			while (index && upvalueScope.minScopeBegin < upvalueInfos[index - 1].id) {
+				lowerIndex = std::upper_bound(upvalueInfos.begin(), upvalueInfos.begin() + index, upvalueScope.minScopeBegin,
+					[](const uint32_t& id, const UpvalueInfo& upvalueInfo)->bool { return id < upvalueInfo.id; }) - upvalueInfos.begin();
+				add_jump_targets(upvalueScope, get_jump_targets(lowerIndex, index));
+
+				for (uint32_t i = std::lower_bound(closeIndices.begin(), closeIndices.end(), lowerIndex) - closeIndices.begin(); i < closeIndices.size() && closeIndices[i] < index; i++) {
+					if (upvalueScope.slot >= upvalueInfos[closeIndices[i]].baseSlot) continue;
+					add_jump_targets(upvalueScope, { .min = upvalueInfos[closeIndices[i]].target, .max = upvalueInfos[closeIndices[i]].target });
+				}
+
+				index = lowerIndex;
 			}
+		}
+
+		UpvalueScope get_upvalue_scope(const uint32_t& index, const uint8_t& slot) {
+			UpvalueScope upvalueScope = { .slot = slot, .minScopeBegin = upvalueInfos[index].id, .minScopeEnd = upvalueInfos[index].id };
+			uint32_t backwardIndex = index;
+			uint32_t closeIndex = std::upper_bound(closeIndices.begin(), closeIndices.end(), index) - closeIndices.begin();
+
+			for (uint32_t forwardIndex = index + 1, nextIndex; true; forwardIndex = nextIndex + 1, closeIndex++) {
+				nextIndex = closeIndex < closeIndices.size() ? closeIndices[closeIndex] : upvalueInfos.size();
+				add_jump_targets(upvalueScope, get_jump_targets(forwardIndex, nextIndex));
+				extend_upvalue_scope_backwards(upvalueScope, backwardIndex);
+				if (nextIndex == upvalueInfos.size()) break;
+
+				if (slot >= upvalueInfos[nextIndex].baseSlot) {
+					if (upvalueScope.minScopeEnd > upvalueInfos[nextIndex].id) continue;
+					upvalueScope.minScopeEnd = upvalueInfos[nextIndex].id;
+					break;
+				}
 
-			upvalueScopes.emplace_back();
-			upvalueScopes.back().slot = slot;
-			upvalueScopes.back().minScopeBegin = minScopeBegin;
-			upvalueScopes.back().minScopeEnd = minScopeEnd;
+				add_jump_targets(upvalueScope, { .min = upvalueInfos[nextIndex].target, .max = upvalueInfos[nextIndex].target });
+				extend_upvalue_scope_backwards(upvalueScope, backwardIndex);
+			}
+
+			return upvalueScope;
 		}
 
 		void build_upvalue_scopes() {
-			uint32_t index, minScopeBegin, minScopeEnd;
+			if (!upvalueInfos.size()) return;
+			sort_upvalue_infos();
 
 			for (uint32_t i = upvalueInfos.size(); i--;) {
 				if (upvalueInfos[i].type != UpvalueInfo::UPVALUES) continue;
 
 				for (uint8_t j = upvalueInfos[i].upvalues.size(); j--;) {
-					index = i;
-					minScopeBegin = upvalueInfos[i].id;
-					minScopeEnd = upvalueInfos[i].id;
-
-					for (uint32_t k = i + 1; k < upvalueInfos.size(); k++) {
-						switch (upvalueInfos[k].type) {
-						case UpvalueInfo::UPVALUE_CLOSE:
-							if (upvalueInfos[i].upvalues[j] >= upvalueInfos[k].baseSlot) {
-								if (minScopeEnd > upvalueInfos[k].id) continue;
-								minScopeEnd = upvalueInfos[k].id;
-								break;
-							}
-						case UpvalueInfo::JUMP:
-							if (minScopeEnd < upvalueInfos[k].target) {
-								minScopeEnd = upvalueInfos[k].target;
-							} else if (minScopeBegin >= upvalueInfos[k].target) {
-								minScopeBegin = upvalueInfos[k].target - 1;
-
-								for (uint32_t l = index; l-- && minScopeBegin < upvalueInfos[l].id; index = l) {
-									switch (upvalueInfos[l].type) {
-									case UpvalueInfo::UPVALUE_CLOSE:
-										if (upvalueInfos[i].upvalues[j] >= upvalueInfos[l].baseSlot) continue;
-									case UpvalueInfo::JUMP:
-										if (minScopeEnd < upvalueInfos[l].target) {
-											minScopeEnd = upvalueInfos[l].target;
-										} else if (minScopeBegin >= upvalueInfos[l].target) {
-											minScopeBegin = upvalueInfos[l].target - 1;
-										}
-									}
-								}
-							}
-						default:
-							continue;
-						}
-
-						break;
-					}
-
-					add_upvalue_scope(upvalueInfos[i].upvalues[j], minScopeBegin, minScopeEnd);
+					upvalueScopes.emplace_back(get_upvalue_scope(i, upvalueInfos[i].upvalues[j]));
 				}
 			}
+
+			std::reverse(upvalueScopes.begin(), upvalueScopes.end());
+			std::stable_sort(upvalueScopes.begin(), upvalueScopes.end(), [](const UpvalueScope& first, const UpvalueScope& second)->bool {
+				return first.minScopeEnd < second.minScopeEnd;
+			});
+			jumpTargets.clear();
+			jumpTargets.shrink_to_fit();
+			closeIndices.clear();
+			closeIndices.shrink_to_fit();
 		}
 
 		void begin_scope(const uint8_t& slot, const uint32_t& id) {
@@ -307,13 +473,13 @@ struct Ast::Function {
 			}
 		}
 
-		void add_to_scope(const uint8_t& slot, SlotScope**& slotScope, const uint32_t& id) {
+		void add_to_scope(const uint8_t& slot, SlotScope*& slotScope, const uint32_t& id) {
 			begin_scope(slot, id);
 			slotScope = slotInfos[slot].activeSlotScope;
 			(*slotInfos[slot].activeSlotScope)->usages++;
 		}
 
-		void close_scope(const uint8_t& slot, SlotScope**& slotScope, const uint32_t& id) {
+		void close_scope(const uint8_t& slot, SlotScope*& slotScope, const uint32_t& id) {
 			if (slotInfos[slot].isParameter
 				|| (slotInfos[slot].minScopeBegin != INVALID_ID
 					&& slotInfos[slot].minScopeBegin < id))
@@ -346,14 +512,7 @@ struct Ast::Function {
 				for (uint32_t j = slotInfos[i].slotScopes.size() - 1; j-- && (*slotInfos[i].slotScopes[j])->scopeBegin <= id;) {
 					(*slotInfos[i].activeSlotScope)->scopeEnd = (*slotInfos[i].slotScopes[j])->scopeEnd;
 					(*slotInfos[i].activeSlotScope)->usages += (*slotInfos[i].slotScopes[j])->usages + 1;
-
-					for (uint32_t k = (*slotInfos[i].slotScopes[j])->mergedScopes.size(); k--;) {
-						*(*slotInfos[i].slotScopes[j])->mergedScopes[k] = *slotInfos[i].activeSlotScope;
-					}
-
-					(*slotInfos[i].activeSlotScope)->mergedScopes.insert((*slotInfos[i].activeSlotScope)->mergedScopes.end(), (*slotInfos[i].slotScopes[j])->mergedScopes.begin(), (*slotInfos[i].slotScopes[j])->mergedScopes.end());
-					(*slotInfos[i].activeSlotScope)->mergedScopes.emplace_back(&(*slotInfos[i].slotScopes[j])->slotScope);
-					*slotInfos[i].slotScopes[j] = *slotInfos[i].activeSlotScope;
+					merge_scope(slotInfos[i].activeSlotScope, slotInfos[i].slotScopes[j]);
 					slotInfos[i].slotScopes.erase(slotInfos[i].slotScopes.begin() + j);
 				}
 
@@ -369,7 +528,7 @@ struct Ast::Function {
 			return true;
 		}
 
-		void remove_scope(const uint8_t& slot, SlotScope** const& slotScope) {
+		void remove_scope(const uint8_t& slot, SlotScope* const& slotScope) {
 			for (uint32_t i = slotInfos[slot].slotScopes.size(); i--;) {
 				if (slotInfos[slot].slotScopes[i] != slotScope) continue;
 				slotInfos[slot].slotScopes.erase(slotInfos[slot].slotScopes.begin() + i);
@@ -379,6 +538,8 @@ struct Ast::Function {
 
 		std::vector<UpvalueInfo> upvalueInfos;
 		std::vector<UpvalueScope> upvalueScopes;
+		std::vector<TargetRange> jumpTargets;
+		std::vector<uint32_t> closeIndices;
 		std::vector<SlotInfo> slotInfos;
 		std::vector<SlotScope*> slotScopes;
 		uint32_t previousId = INVALID_ID;
@@ -0,0 +1,98 @@
+# Times the decompiler on generated and/or chains of N terms.
+#
+# Each input is a single function holding one N term condition, compiled to
+# bytecode with luajit -b. The time reported is the whole file minus process
+# start up, so it covers every pass, not only ConditionBuilder. Run it against
+# two builds with --decompiler to see what a change does to the cost per term.
+# LuaJIT jumps are limited to 32k instructions, which caps chains near 16k terms.
+#
+# usage: python bench/condition_chain.py [--decompiler EXE] [--luajit LUAJIT]
+#                                        [--sizes 1000,2500,...] [--repeat 3]
+
+import argparse
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SHAPES = ("and", "or", "mixed", "value")
+
+def get_term(index):
+	return ("a", "b", "c", "d")[index & 3]
+
+def generate_chain(shape, count):
+	if shape == "and" or shape == "or":
+		condition = (" %s " % shape).join(get_term(i) for i in range(count))
+	else:
+		# every other operator flips, so each term jumps over the next one
+		condition = get_term(0)
+
+		for i in range(1, count):
+			condition += (" and " if i & 1 else " or ") + get_term(i)
+
+	if shape == "value":
+		return "local a, b, c, d = ...\nlocal value = %s\nreturn value\n" % condition
+
+	return "local a, b, c, d = ...\nif %s then\n\treturn 1\nend\nreturn 2\n" % condition
+
+def compile_chain(luajit, source, bytecode):
+	subprocess.run([luajit, "-b", source, bytecode], check=True)
+
+def time_decompiler(decompiler, bytecode, output, repeat):
+	best = math.inf
+
+	for _ in range(repeat):
+		begin = time.perf_counter()
+		result = subprocess.run([decompiler, bytecode, "-s", "-f", "-o", output], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+		best = min(best, time.perf_counter() - begin)
+
+		if result.returncode:
+			sys.exit("Decompiler failed on " + bytecode)
+
+	return best
+
+def main():
+	root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+	parser = argparse.ArgumentParser(description="Time condition reconstruction on generated N term and/or chains.")
+	parser.add_argument("--decompiler", default=os.path.join(root, "luajit-decompiler-v2.exe"))
+	parser.add_argument("--luajit", default="luajit")
+	parser.add_argument("--sizes", default="1000,2500,5000,10000")
+	parser.add_argument("--shapes", default=",".join(SHAPES))
+	parser.add_argument("--repeat", type=int, default=3)
+	arguments = parser.parse_args()
+	sizes = [int(size) for size in arguments.sizes.split(",")]
+	shapes = arguments.shapes.split(",")
+	folder = tempfile.mkdtemp(prefix="condition_chain_")
+	output = os.path.join(folder, "output") + os.sep
+	os.mkdir(output)
+
+	try:
+		# baseline run on an empty chunk to subtract process start up
+		empty = os.path.join(folder, "empty")
+
+		with open(empty + ".lua", "w") as file:
+			file.write("return\n")
+
+		compile_chain(arguments.luajit, empty + ".lua", empty + ".luac")
+		startup = time_decompiler(arguments.decompiler, empty + ".luac", output, arguments.repeat)
+		print("startup %.1f ms" % (startup * 1000))
+		print("%-6s %8s %10s %14s %18s" % ("shape", "terms", "ms", "us per term", "us per n log2 n"))
+
+		for shape in shapes:
+			for size in sizes:
+				name = os.path.join(folder, "%s_%d" % (shape, size))
+
+				with open(name + ".lua", "w") as file:
+					file.write(generate_chain(shape, size))
+
+				compile_chain(arguments.luajit, name + ".lua", name + ".luac")
+				elapsed = max(time_decompiler(arguments.decompiler, name + ".luac", output, arguments.repeat) - startup, 0)
+				print("%-6s %8d %10.1f %14.3f %18.4f" % (shape, size, elapsed * 1000, elapsed * 1e6 / size, elapsed * 1e6 / (size * math.log2(size))))
+	finally:
+		shutil.rmtree(folder, ignore_errors=True)
+
+if __name__ == "__main__":
+	main()
@@ -1,6 +1,6 @@
 #include "..\main.h"
 
-Bytecode::Bytecode(const std::string& filePath) : filePath(filePath) {}
+Bytecode::Bytecode(const std::string& filePath, const bool& keepNativeLineMap, const bool& lazyLoading) : filePath(filePath), keepNativeLineMap(keepNativeLineMap), lazyLoading(lazyLoading) {}
 
 Bytecode::~Bytecode() {
 	close_file();
@@ -10,13 +10,19 @@ Bytecode::~Bytecode() {
 	}
 }
 
-void Bytecode::operator()() {
+void Bytecode::operator()(const std::function<void()>& check_budget) {
 	print_progress_bar();
 	open_file();
 	read_header();
 	prototypesTotalSize = bytesUnread - 1;
-	read_prototypes();
-	close_file();
+
+	if (lazyLoading) {
+		scan_prototypes(check_budget);
+	} else {
+		read_prototypes(check_budget);
+		close_file();
+	}
+
 	fileBuffer.clear();
 	fileBuffer.shrink_to_fit();
 	erase_progress_bar();
@@ -46,27 +52,116 @@ void Bytecode::read_header() {
 	header.chunkname.replace(header.chunkname.begin(), header.chunkname.end(), fileBuffer.begin(), fileBuffer.end());
 }
 
-void Bytecode::read_prototypes() {
+void Bytecode::load_prototype(const Prototype& prototype) {
+	if (prototype.isLoaded) return;
+	prototypes[prototype.index]->load();
+}
+
+void Bytecode::unload_prototypes(const Prototype& prototype) {
+	if (prototype.descendants == INVALID_COUNT) return prototypes[prototype.index]->unload();
+
+	for (uint32_t i = prototype.index - prototype.descendants; i <= prototype.index; i++) {
+		prototypes[i]->unload();
+	}
+}
+
+const Bytecode::Prototype* Bytecode::get_prototype_from_lines(const uint32_t& firstLine, const uint32_t& lastLine) const {
+	const Prototype* prototype = nullptr;
+
+	for (uint32_t i = prototypes.size(); i--;) {
+		if (!prototypes[i]->header.hasDebugInfo
+			|| prototypes[i]->header.firstLine > firstLine
+			|| prototypes[i]->header.firstLine + prototypes[i]->header.lineCount < lastLine
+			|| (prototype && prototypes[i]->header.lineCount > prototype->header.lineCount)) continue;
+		prototype = prototypes[i];
+	}
+
+	return prototype;
+}
+
+void Bytecode::read_prototypes(const std::function<void()>& check_budget) {
 	std::vector<Prototype*> unlinkedPrototypes;
 
 	while (buffer_next_block()) {
 		assert(fileBuffer.size() >= MIN_PROTO_SIZE, "Prototype is too short", filePath, DEBUG_INFO);
-		prototypes.emplace_back(new Prototype(*this));
+		prototypes.emplace_back(new Prototype(*this, prototypes.size(), fileSize - bytesUnread - fileBuffer.size()));
 		(*prototypes.back())(unlinkedPrototypes);
 		print_progress_bar(prototypesTotalSize - bytesUnread - 1, prototypesTotalSize);
+		check_budget();
 	}
 
 	assert(unlinkedPrototypes.size() == 1, "Failed to link main prototype", filePath, DEBUG_INFO);
 	main = unlinkedPrototypes.back();
 	assert((main->header.flags & BC_PROTO_VARARG)
 		&& !main->header.parameters
-		&& !main->upvalues.size(),
+		&& !main->header.upvalueCount,
+		"Main prototype has invalid header", filePath, DEBUG_INFO);
+	prototypes.shrink_to_fit();
+}
+
+void Bytecode::scan_prototypes(const std::function<void()>& check_budget) {
+	LARGE_INTEGER distance;
+
+	for (uint32_t byteCount = read_uleb128(); byteCount; byteCount = read_uleb128()) {
+		assert(byteCount >= MIN_PROTO_SIZE, "Prototype is too short", filePath, DEBUG_INFO);
+		assert(bytesUnread >= byteCount, "Read would exceed end of file", filePath, DEBUG_INFO);
+		prototypes.emplace_back(new Prototype(*this, prototypes.size(), fileSize - bytesUnread));
+		read_file(byteCount < MAX_PROTO_HEADER_SIZE ? byteCount : MAX_PROTO_HEADER_SIZE);
+		prototypes.back()->read_header_only(byteCount);
+		distance.QuadPart = byteCount - fileBuffer.size();
+		assert(SetFilePointerEx(file, distance, NULL, FILE_CURRENT), "Failed to read file", filePath, DEBUG_INFO);
+		bytesUnread -= distance.QuadPart;
+		check_budget();
+	}
+
+	assert(!bytesUnread, "Read unexpectedly reached end of file", filePath, DEBUG_INFO);
+	assert(prototypes.size(), "Failed to link main prototype", filePath, DEBUG_INFO);
+	main = prototypes.back();
+	assert((main->header.flags & BC_PROTO_VARARG)
+		&& !main->header.parameters
+		&& !main->header.upvalueCount,
 		"Main prototype has invalid header", filePath, DEBUG_INFO);
 	prototypes.shrink_to_fit();
 }
 
+void Bytecode::read_block(const Prototype& prototype, std::vector<uint8_t>& buffer) const {
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = prototype.fileOffset;
+	overlapped.OffsetHigh = prototype.fileOffset >> 32;
+	buffer.resize(prototype.prototypeSize);
+	DWORD bytesRead = 0;
+	assert(ReadFile(file, buffer.data(), buffer.size(), &bytesRead, &overlapped) && bytesRead == buffer.size(), "Failed to read file", filePath, DEBUG_INFO);
+}
+
+void Bytecode::link_children(const Prototype& prototype, std::vector<Prototype*>& unlinkedPrototypes) const {
+	uint32_t index = prototype.index;
+
+	for (uint32_t i = unlinkedPrototypes.size(); i--;) {
+		assert(index, "Failed to link child prototype", filePath, DEBUG_INFO);
+		unlinkedPrototypes[i] = prototypes[--index];
+		index -= prototypes[index]->descendants;
+	}
+
+	if (&prototype == main) assert(!index && prototype.descendants == prototypes.size() - 1, "Failed to link main prototype", filePath, DEBUG_INFO);
+}
+
+uint32_t Bytecode::get_descendant_count(const uint32_t& index) const {
+	if (prototypes[index]->descendants != INVALID_COUNT) return prototypes[index]->descendants;
+	uint32_t descendants = 0, childIndex = index, childDescendants;
+
+	for (uint32_t i = prototypes[index]->get_child_count(); i--;) {
+		assert(childIndex, "Failed to link child prototype", filePath, DEBUG_INFO);
+		childDescendants = get_descendant_count(--childIndex);
+		assert(childDescendants <= childIndex, "Failed to link child prototype", filePath, DEBUG_INFO);
+		childIndex -= childDescendants;
+		descendants += childDescendants + 1;
+	}
+
+	return prototypes[index]->descendants = descendants;
+}
+
 void Bytecode::open_file() {
-	file = CreateFileA(filePath.c_str(), GENERIC_READ, NULL, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	file = CreateFileA(filePath.c_str(), GENERIC_READ, NULL, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | (lazyLoading ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN), NULL);
 	assert(file != INVALID_HANDLE_VALUE, "Unable to open file", filePath, DEBUG_INFO);
 	fileSize |= (uint64_t)GetFileSize(file, (DWORD*)&fileSize) << 32;
 	fileSize = (fileSize >> 32) | (fileSize << 32);
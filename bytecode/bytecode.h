@@ -6,18 +6,34 @@ public:
 	struct NumberConstant;
 	struct TableConstant;
 	struct TableNode;
+	struct PoolRange;
 	struct VariableInfo;
+	struct OpFormat;
 	struct Instruction;
 	#include "prototype.h"
 	#include "constants.h"
 	#include "instructions.h"
 
-	Bytecode(const std::string& filePath);
+	Bytecode(const std::string& filePath, const bool& keepNativeLineMap, const bool& lazyLoading);
 	~Bytecode();
 
-	void operator()();
+	void operator()(const std::function<void()>& check_budget);
+	void load_prototype(const Prototype& prototype);
+	void unload_prototypes(const Prototype& prototype);
+
+	const Prototype& get_prototype(const uint32_t& index) const {
+		return *prototypes[index];
+	}
+
+	uint32_t get_prototype_count() const {
+		return prototypes.size();
+	}
+
+	const Prototype* get_prototype_from_lines(const uint32_t& firstLine, const uint32_t& lastLine) const;
 
 	const std::string filePath;
+	const bool keepNativeLineMap;
+	const bool lazyLoading;
 
 	struct {
 		uint8_t version = 0;
@@ -32,9 +48,15 @@ private:
 
 	static constexpr uint8_t MIN_PROTO_SIZE = 11;
 	static constexpr uint8_t MIN_FILE_SIZE = MIN_PROTO_SIZE + 7;
+	static constexpr uint8_t MAX_PROTO_HEADER_SIZE = 34;
+	static constexpr uint32_t INVALID_COUNT = -1;
 
 	void read_header();
-	void read_prototypes();
+	void read_prototypes(const std::function<void()>& check_budget);
+	void scan_prototypes(const std::function<void()>& check_budget);
+	void read_block(const Prototype& prototype, std::vector<uint8_t>& buffer) const;
+	void link_children(const Prototype& prototype, std::vector<Prototype*>& unlinkedPrototypes) const;
+	uint32_t get_descendant_count(const uint32_t& index) const;
 	void open_file();
 	void close_file();
 	void read_file(const uint32_t& byteCount);
@@ -58,8 +58,9 @@ private:
     bool compare_prototypes(const Bytecode::Prototype& a, const Bytecode::Prototype& b);
     bool compare_instructions(const std::vector<Bytecode::Instruction>& a, 
                               const std::vector<Bytecode::Instruction>& b);
-    bool compare_constants(const std::vector<Bytecode::Constant>& a,
-                          const std::vector<Bytecode::Constant>& b);
+    bool compare_constants(const Bytecode::Prototype& protoA, const Bytecode::Prototype& protoB);
+    bool compare_table_constants(const Bytecode::Prototype& protoA, const Bytecode::TableConstant& a,
+                                 const Bytecode::Prototype& protoB, const Bytecode::TableConstant& b);
     
     // Patch helpers
     void remap_constant_indices(Bytecode::Prototype& proto, 
@@ -210,30 +210,44 @@ bool BytecodePatcher::compare_instructions(const std::vector<Bytecode::Instructi
     return true;
 }
 
-bool BytecodePatcher::compare_constants(const std::vector<Bytecode::Constant>& a,
-                                       const std::vector<Bytecode::Constant>& b) {
+bool BytecodePatcher::compare_constants(const Bytecode::Prototype& protoA, const Bytecode::Prototype& protoB) {
+    const std::vector<Bytecode::Constant>& a = protoA.constants;
+    const std::vector<Bytecode::Constant>& b = protoB.constants;
     if (a.size() != b.size()) return false;
     
     // Compare constants semantically (by type and value, not just structure)
+    // Strings and table entries live in each prototype's pools, so ranges are resolved before comparing
     for (size_t i = 0; i < a.size(); i++) {
         if (a[i].type != b[i].type) return false;
         
         switch (a[i].type) {
         case BC_KGC_STR:
-            if (a[i].string != b[i].string) return false;
+            if (protoA.get_string(a[i].string) != protoB.get_string(b[i].string)) return false;
             break;
         case BC_KGC_I64:
         case BC_KGC_U64:
         case BC_KGC_COMPLEX:
             if (a[i].cdata != b[i].cdata) return false;
             break;
-        case BC_KGC_TAB:
-            // Compare tables (simplified)
-            if (a[i].array.size() != b[i].array.size() ||
-                a[i].table.size() != b[i].table.size()) {
-                return false;
+        case BC_KGC_TAB: {
+            const std::span<const Bytecode::TableConstant> arrayA = protoA.get_array(a[i]);
+            const std::span<const Bytecode::TableConstant> arrayB = protoB.get_array(b[i]);
+            const std::span<const Bytecode::TableNode> tableA = protoA.get_table(a[i]);
+            const std::span<const Bytecode::TableNode> tableB = protoB.get_table(b[i]);
+            if (arrayA.size() != arrayB.size() || tableA.size() != tableB.size()) return false;
+            
+            for (size_t j = 0; j < arrayA.size(); j++) {
+                if (!compare_table_constants(protoA, arrayA[j], protoB, arrayB[j])) return false;
+            }
+            
+            for (size_t j = 0; j < tableA.size(); j++) {
+                if (!compare_table_constants(protoA, tableA[j].key, protoB, tableB[j].key) ||
+                    !compare_table_constants(protoA, tableA[j].value, protoB, tableB[j].value)) {
+                    return false;
+                }
             }
             break;
+        }
         case BC_KGC_CHILD:
             // Child prototypes are compared separately
             break;
@@ -243,6 +257,22 @@ bool BytecodePatcher::compare_constants(const std::vector<Bytecode::Constant>& a
     return true;
 }
 
+bool BytecodePatcher::compare_table_constants(const Bytecode::Prototype& protoA, const Bytecode::TableConstant& a,
+                                             const Bytecode::Prototype& protoB, const Bytecode::TableConstant& b) {
+    if (a.type != b.type) return false;
+    
+    switch (a.type) {
+    case BC_KTAB_INT:
+        return a.integer == b.integer;
+    case BC_KTAB_NUM:
+        return a.number == b.number;
+    case BC_KTAB_STR:
+        return protoA.get_string(a.string) == protoB.get_string(b.string);
+    default:
+        return true;
+    }
+}
+
 void BytecodePatcher::remap_constant_indices(Bytecode::Prototype& proto,
                                              const std::map<uint32_t, uint32_t>& indexMap) {
     // Remap constant indices in instructions
@@ -36,8 +36,8 @@ private:
     void write_instruction_ad(const Bytecode::Instruction& inst);
     
     // Constant writing
-    void write_constant(const Bytecode::Constant& constant);
-    void write_table_constant(const Bytecode::TableConstant& tableConst);
+    void write_constant(const Bytecode::Prototype& proto, const Bytecode::Constant& constant);
+    void write_table_constant(const Bytecode::Prototype& proto, const Bytecode::TableConstant& tableConst);
     
     // Utility functions
     void write_uleb128(uint32_t value);
@@ -166,11 +166,11 @@ void BytecodeWriter::write_prototype_upvalues(const Bytecode::Prototype& proto)
 void BytecodeWriter::write_prototype_constants(const Bytecode::Prototype& proto) {
     // Write constants in reverse order (for linking child prototypes)
     for (auto it = proto.constants.rbegin(); it != proto.constants.rend(); ++it) {
-        write_constant(*it);
+        write_constant(proto, *it);
     }
 }
 
-void BytecodeWriter::write_constant(const Bytecode::Constant& constant) {
+void BytecodeWriter::write_constant(const Bytecode::Prototype& proto, const Bytecode::Constant& constant) {
     write_uleb128(constant.type);
     
     switch (constant.type) {
@@ -179,14 +179,14 @@ void BytecodeWriter::write_constant(const Bytecode::Constant& constant) {
         // Just need to track linking
         break;
     case BC_KGC_TAB:
-        write_uleb128(constant.array.size());
-        write_uleb128(constant.table.size());
-        for (const auto& arr : constant.array) {
-            write_table_constant(arr);
+        write_uleb128(constant.array.size);
+        write_uleb128(constant.table.size);
+        for (const auto& arr : proto.get_array(constant)) {
+            write_table_constant(proto, arr);
         }
-        for (const auto& tab : constant.table) {
-            write_table_constant(tab.key);
-            write_table_constant(tab.value);
+        for (const auto& tab : proto.get_table(constant)) {
+            write_table_constant(proto, tab.key);
+            write_table_constant(proto, tab.value);
         }
         break;
     case BC_KGC_I64:
@@ -195,13 +195,13 @@ void BytecodeWriter::write_constant(const Bytecode::Constant& constant) {
         write_qword(constant.cdata);
         break;
     case BC_KGC_STR:
-        write_uleb128(constant.string.size());
-        write_string(constant.string);
+        write_uleb128(constant.string.size);
+        write_string(std::string(proto.get_string(constant.string)));
         break;
     }
 }
 
-void BytecodeWriter::write_table_constant(const Bytecode::TableConstant& tableConst) {
+void BytecodeWriter::write_table_constant(const Bytecode::Prototype& proto, const Bytecode::TableConstant& tableConst) {
     write_byte(tableConst.type);
     
     switch (tableConst.type) {
@@ -217,8 +217,8 @@ void BytecodeWriter::write_table_constant(const Bytecode::TableConstant& tableCo
         write_qword(tableConst.number);
         break;
     case BC_KTAB_STR:
-        write_uleb128(tableConst.string.size());
-        write_string(tableConst.string);
+        write_uleb128(tableConst.string.size);
+        write_string(std::string(proto.get_string(tableConst.string)));
         break;
     }
 }
@@ -235,9 +235,9 @@ void BytecodeWriter::write_prototype_number_constants(const Bytecode::Prototype&
 }
 
 void BytecodeWriter::write_prototype_debug_info(const Bytecode::Prototype& proto) {
-    // Write line map
-    for (uint32_t line : proto.lineMap) {
-        write_uleb128(line);
+    // Write line map (lineMap is empty when the bytecode keeps its native line map)
+    for (uint32_t i = 0; i < proto.instructions.size(); i++) {
+        write_uleb128(proto.get_line(i));
     }
     
     // Write upvalue names
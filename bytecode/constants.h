@@ -13,6 +13,11 @@ static constexpr uint8_t BC_PROTO_FFI = 0x04;
 static constexpr uint16_t BC_UV_IMMUTABLE = 0x4000;
 static constexpr uint16_t BC_UV_LOCAL = 0x8000;
 
+struct Bytecode::PoolRange {
+	uint32_t offset;
+	uint32_t size;
+};
+
 enum BC_KTAB {
 	BC_KTAB_NIL, // primitive nil
 	BC_KTAB_FALSE, // primitive false
@@ -28,9 +33,8 @@ struct Bytecode::TableConstant {
 	union {
 		uint32_t integer;
 		uint64_t number = 0;
+		PoolRange string;
 	};
-
-	std::string string;
 };
 
 struct Bytecode::TableNode {
@@ -49,11 +53,17 @@ enum BC_KGC {
 
 struct Bytecode::Constant {
 	BC_KGC type;
-	const Prototype* prototype = nullptr;
-	std::vector<TableConstant> array;
-	std::vector<TableNode> table;
-	uint64_t cdata = 0;
-	std::string string;
+
+	union {
+		const Prototype* prototype = nullptr;
+		uint64_t cdata;
+		PoolRange string;
+
+		struct {
+			PoolRange array;
+			PoolRange table;
+		};
+	};
 };
 
 enum BC_KNUM {
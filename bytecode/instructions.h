@@ -1,6 +1,6 @@
 static constexpr uint16_t BC_OP_JMP_BIAS = 0x8000;
 
-enum BC_OP {
+enum BC_OP : uint8_t {
 	BC_OP_ISLT, // if A<VAR> < D<VAR> then JMP
 	BC_OP_ISGE, // if not (A<VAR> < D<VAR>) then JMP
 	BC_OP_ISLE, // if A<VAR> <= D<VAR> then JMP
@@ -101,6 +101,31 @@ enum BC_OP {
 	BC_OP_INVALID
 };
 
+enum BC_OPERAND {
+	BC_OPERAND_NONE,
+	BC_OPERAND_DST,
+	BC_OPERAND_VAR,
+	BC_OPERAND_BASE,
+	BC_OPERAND_RBASE,
+	BC_OPERAND_UV,
+	BC_OPERAND_LIT,
+	BC_OPERAND_LITS,
+	BC_OPERAND_PRI,
+	BC_OPERAND_NUM,
+	BC_OPERAND_STR,
+	BC_OPERAND_TAB,
+	BC_OPERAND_FUNC,
+	BC_OPERAND_CDATA,
+	BC_OPERAND_JUMP
+};
+
+struct Bytecode::OpFormat {
+	BC_OPERAND a = BC_OPERAND_NONE;
+	BC_OPERAND b = BC_OPERAND_NONE;
+	BC_OPERAND c = BC_OPERAND_NONE;
+	BC_OPERAND d = BC_OPERAND_NONE;
+};
+
 struct Bytecode::Instruction {
 	BC_OP type;
 	uint8_t a = 0;
@@ -109,8 +134,23 @@ struct Bytecode::Instruction {
 	uint16_t d = 0;
 };
 
-static BC_OP get_op_type(const uint8_t& byte, const uint8_t& version) {
-	return (BC_OP)(version == Bytecode::BC_VERSION_1 && byte >= BC_OP_ISTYPE ? (byte >= BC_OP_TGETR - 2 ? (byte >= BC_OP_TSETR - 3 ? byte + 4 : byte + 3) : byte + 2) : byte);
+template <uint8_t version>
+static BC_OP get_op_type(const uint8_t& byte) {
+	if constexpr (version == BC_VERSION_1) {
+		static constexpr std::array<uint16_t, 0x100> OP_TYPES = [] {
+			std::array<uint16_t, 0x100> opTypes;
+
+			for (uint16_t i = 0; i < opTypes.size(); i++) {
+				opTypes[i] = i >= BC_OP_ISTYPE ? (i >= BC_OP_TGETR - 2 ? (i >= BC_OP_TSETR - 3 ? i + 4 : i + 3) : i + 2) : i;
+			}
+
+			return opTypes;
+		}();
+
+		return (BC_OP)OP_TYPES[byte];
+	} else {
+		return (BC_OP)byte;
+	}
 }
 
 static bool is_op_abc_format(const BC_OP& instruction) {
@@ -150,3 +190,125 @@ static bool is_op_abc_format(const BC_OP& instruction) {
 
 	return false;
 }
+
+static constexpr OpFormat get_op_format(const BC_OP& instruction) {
+	switch (instruction) {
+	case BC_OP_ISLT:
+	case BC_OP_ISGE:
+	case BC_OP_ISLE:
+	case BC_OP_ISGT:
+	case BC_OP_ISEQV:
+	case BC_OP_ISNEV:
+		return { .a = BC_OPERAND_VAR, .d = BC_OPERAND_VAR };
+	case BC_OP_ISEQS:
+	case BC_OP_ISNES:
+		return { .a = BC_OPERAND_VAR, .d = BC_OPERAND_STR };
+	case BC_OP_ISEQN:
+	case BC_OP_ISNEN:
+		return { .a = BC_OPERAND_VAR, .d = BC_OPERAND_NUM };
+	case BC_OP_ISEQP:
+	case BC_OP_ISNEP:
+		return { .a = BC_OPERAND_VAR, .d = BC_OPERAND_PRI };
+	case BC_OP_ISTC:
+	case BC_OP_ISFC:
+	case BC_OP_MOV:
+	case BC_OP_NOT:
+	case BC_OP_UNM:
+	case BC_OP_LEN:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_VAR };
+	case BC_OP_IST:
+	case BC_OP_ISF:
+		return { .d = BC_OPERAND_VAR };
+	case BC_OP_ADDVN:
+	case BC_OP_SUBVN:
+	case BC_OP_MULVN:
+	case BC_OP_DIVVN:
+	case BC_OP_MODVN:
+	case BC_OP_ADDNV:
+	case BC_OP_SUBNV:
+	case BC_OP_MULNV:
+	case BC_OP_DIVNV:
+	case BC_OP_MODNV:
+		return { .a = BC_OPERAND_DST, .b = BC_OPERAND_VAR, .c = BC_OPERAND_NUM };
+	case BC_OP_ADDVV:
+	case BC_OP_SUBVV:
+	case BC_OP_MULVV:
+	case BC_OP_DIVVV:
+	case BC_OP_MODVV:
+	case BC_OP_POW:
+	case BC_OP_TGETV:
+		return { .a = BC_OPERAND_DST, .b = BC_OPERAND_VAR, .c = BC_OPERAND_VAR };
+	case BC_OP_CAT:
+		return { .a = BC_OPERAND_DST, .b = BC_OPERAND_RBASE, .c = BC_OPERAND_RBASE };
+	case BC_OP_KSTR:
+	case BC_OP_GGET:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_STR };
+	case BC_OP_KCDATA:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_CDATA };
+	case BC_OP_KSHORT:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_LITS };
+	case BC_OP_KNUM:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_NUM };
+	case BC_OP_KPRI:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_PRI };
+	case BC_OP_KNIL:
+		return { .a = BC_OPERAND_BASE, .d = BC_OPERAND_BASE };
+	case BC_OP_UGET:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_UV };
+	case BC_OP_USETV:
+		return { .a = BC_OPERAND_UV, .d = BC_OPERAND_VAR };
+	case BC_OP_USETS:
+		return { .a = BC_OPERAND_UV, .d = BC_OPERAND_STR };
+	case BC_OP_USETN:
+		return { .a = BC_OPERAND_UV, .d = BC_OPERAND_NUM };
+	case BC_OP_USETP:
+		return { .a = BC_OPERAND_UV, .d = BC_OPERAND_PRI };
+	case BC_OP_UCLO:
+	case BC_OP_LOOP:
+	case BC_OP_JMP:
+		return { .a = BC_OPERAND_RBASE, .d = BC_OPERAND_JUMP };
+	case BC_OP_FNEW:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_FUNC };
+	case BC_OP_TNEW:
+		return { .a = BC_OPERAND_DST };
+	case BC_OP_TDUP:
+		return { .a = BC_OPERAND_DST, .d = BC_OPERAND_TAB };
+	case BC_OP_GSET:
+		return { .a = BC_OPERAND_VAR, .d = BC_OPERAND_STR };
+	case BC_OP_TGETS:
+		return { .a = BC_OPERAND_DST, .b = BC_OPERAND_VAR, .c = BC_OPERAND_STR };
+	case BC_OP_TGETB:
+		return { .a = BC_OPERAND_DST, .b = BC_OPERAND_VAR, .c = BC_OPERAND_LIT };
+	case BC_OP_TSETV:
+		return { .a = BC_OPERAND_VAR, .b = BC_OPERAND_VAR, .c = BC_OPERAND_VAR };
+	case BC_OP_TSETS:
+		return { .a = BC_OPERAND_VAR, .b = BC_OPERAND_VAR, .c = BC_OPERAND_STR };
+	case BC_OP_TSETB:
+		return { .a = BC_OPERAND_VAR, .b = BC_OPERAND_VAR, .c = BC_OPERAND_LIT };
+	case BC_OP_TSETM:
+		return { .a = BC_OPERAND_BASE, .d = BC_OPERAND_NUM };
+	case BC_OP_CALLM:
+	case BC_OP_CALL:
+		return { .a = BC_OPERAND_BASE, .b = BC_OPERAND_LIT, .c = BC_OPERAND_LIT };
+	case BC_OP_CALLMT:
+	case BC_OP_CALLT:
+	case BC_OP_RETM:
+		return { .a = BC_OPERAND_BASE, .d = BC_OPERAND_LIT };
+	case BC_OP_ITERC:
+	case BC_OP_ITERN:
+	case BC_OP_VARG:
+		return { .a = BC_OPERAND_BASE, .b = BC_OPERAND_LIT };
+	case BC_OP_ISNEXT:
+	case BC_OP_FORI:
+	case BC_OP_FORL:
+	case BC_OP_ITERL:
+		return { .a = BC_OPERAND_BASE, .d = BC_OPERAND_JUMP };
+	case BC_OP_RET:
+		return { .a = BC_OPERAND_RBASE, .d = BC_OPERAND_LIT };
+	case BC_OP_RET0:
+	case BC_OP_RET1:
+		return { .a = BC_OPERAND_RBASE };
+	}
+
+	return {};
+}
@@ -1,37 +1,103 @@
 #include "..\main.h"
 
-Bytecode::Prototype::Prototype(const Bytecode& bytecode) : bytecode(bytecode) {}
+Bytecode::Prototype::Prototype(const Bytecode& bytecode, const uint32_t& index, const uint64_t& fileOffset) : bytecode(bytecode), index(index), fileOffset(fileOffset) {}
 
 void Bytecode::Prototype::operator()(std::vector<Prototype*>& unlinkedPrototypes) {
+	block = bytecode.fileBuffer;
 	read_header();
-	read_instructions();
-	read_upvalues();
-	read_constants(unlinkedPrototypes);
-	read_number_constants();
-	read_debug_info();
-	assert(prototypeSize == bytecode.fileBuffer.size(), "Prototype has unread bytes left", bytecode.filePath, DEBUG_INFO);
+	childCount = 0;
+	descendants = 0;
+	read_body(unlinkedPrototypes);
 	unlinkedPrototypes.emplace_back(this);
 }
 
+void Bytecode::Prototype::read_header_only(const uint32_t& size) {
+	block = bytecode.fileBuffer;
+	read_header();
+	headerSize = position;
+	prototypeSize = size;
+	block = {};
+}
+
+void Bytecode::Prototype::load() {
+	if (isLoaded) return;
+	std::vector<uint8_t> buffer;
+	bytecode.read_block(*this, buffer);
+	block = buffer;
+
+	if (descendants == INVALID_COUNT) {
+		if (childCount == INVALID_COUNT) count_children();
+		bytecode.get_descendant_count(index);
+	}
+
+	std::vector<Prototype*> unlinkedPrototypes(childCount);
+	bytecode.link_children(*this, unlinkedPrototypes);
+	position = headerSize;
+	read_body(unlinkedPrototypes);
+}
+
+void Bytecode::Prototype::unload() {
+	if (!isLoaded) return;
+	instructions = {};
+	upvalues = {};
+	constants = {};
+	tableArrayPool = {};
+	tableNodePool = {};
+	stringPool = {};
+	numberConstants = {};
+	lineMap = {};
+	nativeLineMap = {};
+	upvalueNames = {};
+	variableInfos = {};
+	isLoaded = false;
+}
+
+uint32_t Bytecode::Prototype::get_child_count() {
+	if (childCount != INVALID_COUNT) return childCount;
+	std::vector<uint8_t> buffer;
+	bytecode.read_block(*this, buffer);
+	block = buffer;
+	count_children();
+	block = {};
+	return childCount;
+}
+
 void Bytecode::Prototype::read_header() {
 	header.flags = get_next_byte();
 	assert(!(header.flags & ~(BC_PROTO_CHILD | BC_PROTO_VARARG | BC_PROTO_FFI)), "Prototype has invalid flags (" + byte_to_string(header.flags) + ")", bytecode.filePath, DEBUG_INFO);
 	header.parameters = get_next_byte();
 	header.framesize = get_next_byte();
-	upvalues.resize(get_next_byte());
-	constants.resize(get_uleb128());
-	numberConstants.resize(get_uleb128());
-	instructions.resize(get_uleb128());
-	assert(instructions.size(), "Prototype has no instructions", bytecode.filePath, DEBUG_INFO);
+	header.upvalueCount = get_next_byte();
+	header.constantCount = get_uleb128();
+	header.numberConstantCount = get_uleb128();
+	header.instructionCount = get_uleb128();
+	assert(header.instructionCount, "Prototype has no instructions", bytecode.filePath, DEBUG_INFO);
 	if (bytecode.header.flags & BC_F_STRIP || !get_uleb128()) return;
 	header.hasDebugInfo = true;
 	header.firstLine = get_uleb128();
 	header.lineCount = get_uleb128();
 }
 
+void Bytecode::Prototype::read_body(std::vector<Prototype*>& unlinkedPrototypes) {
+	instructions.resize(header.instructionCount);
+	upvalues.resize(header.upvalueCount);
+	constants.resize(header.constantCount);
+	numberConstants.resize(header.numberConstantCount);
+	bytecode.header.version == BC_VERSION_1 ? read_instructions<BC_VERSION_1>() : read_instructions<BC_VERSION_2>();
+	read_upvalues();
+	read_constants(unlinkedPrototypes);
+	read_number_constants();
+	read_debug_info();
+	assert(position == block.size(), "Prototype has unread bytes left", bytecode.filePath, DEBUG_INFO);
+	prototypeSize = position;
+	block = {};
+	isLoaded = true;
+}
+
+template <uint8_t version>
 void Bytecode::Prototype::read_instructions() {
 	for (uint32_t i = 0; i < instructions.size(); i++) {
-		instructions[i].type = get_op_type(get_next_byte(), bytecode.header.version);
+		instructions[i].type = get_op_type<version>(get_next_byte());
 		assert(instructions[i].type < BC_OP_INVALID, "Prototype has invalid instruction (" + byte_to_string(instructions[i].type) + ")", bytecode.filePath, DEBUG_INFO);
 
 		switch (instructions[i].type) {
@@ -88,19 +154,26 @@ void Bytecode::Prototype::read_constants(std::vector<Prototype*>& unlinkedProtot
 			assert(unlinkedPrototypes.size(), "Failed to link child prototype", bytecode.filePath, DEBUG_INFO);
 			constants[i].prototype = unlinkedPrototypes.back();
 			unlinkedPrototypes.pop_back();
+			if (bytecode.lazyLoading) continue;
+			childCount++;
+			descendants += constants[i].prototype->descendants + 1;
 			continue;
 		case BC_KGC_TAB:
 			constants[i].type = BC_KGC_TAB;
-			constants[i].array.resize(get_uleb128());
-			constants[i].table.resize(get_uleb128());
-
-			for (uint32_t j = 0; j < constants[i].array.size(); j++) {
-				constants[i].array[j] = get_table_constant();
+			constants[i].array.offset = tableArrayPool.size();
+			constants[i].array.size = get_uleb128();
+			constants[i].table.offset = tableNodePool.size();
+			constants[i].table.size = get_uleb128();
+			tableArrayPool.resize(tableArrayPool.size() + constants[i].array.size);
+			tableNodePool.resize(tableNodePool.size() + constants[i].table.size);
+
+			for (uint32_t j = 0; j < constants[i].array.size; j++) {
+				tableArrayPool[constants[i].array.offset + j] = get_table_constant();
 			}
 
-			for (uint32_t j = 0; j < constants[i].table.size(); j++) {
-				constants[i].table[j].key = get_table_constant();
-				constants[i].table[j].value = get_table_constant();
+			for (uint32_t j = 0; j < constants[i].table.size; j++) {
+				tableNodePool[constants[i].table.offset + j].key = get_table_constant();
+				tableNodePool[constants[i].table.offset + j].value = get_table_constant();
 			}
 
 			continue;
@@ -114,20 +187,19 @@ void Bytecode::Prototype::read_constants(std::vector<Prototype*>& unlinkedProtot
 			continue;
 		default:
 			constants[i].type = BC_KGC_STR;
-			constants[i].string.resize(type - BC_KGC_STR);
-
-			for (uint32_t j = 0; j < constants[i].string.size(); j++) {
-				constants[i].string[j] = get_next_byte();
-			}
-
+			constants[i].string = get_pool_string(type - BC_KGC_STR);
 			continue;
 		}
 	}
+
+	tableArrayPool.shrink_to_fit();
+	tableNodePool.shrink_to_fit();
+	stringPool.shrink_to_fit();
 }
 
 void Bytecode::Prototype::read_number_constants() {
 	for (uint32_t i = 0; i < numberConstants.size(); i++) {
-		if (bytecode.fileBuffer[prototypeSize] & 0x01) {
+		if (block[position] & 0x01) {
 			numberConstants[i].type = BC_KNUM_NUM;
 			numberConstants[i].number = get_uleb128_33();
 			numberConstants[i].number |= (uint64_t)get_uleb128() << 32;
@@ -140,26 +212,7 @@ void Bytecode::Prototype::read_number_constants() {
 
 void Bytecode::Prototype::read_debug_info() {
 	if (!header.hasDebugInfo) return;
-	lineMap.resize(instructions.size());
-
-	if (header.lineCount < 256) {
-		for (uint32_t i = 0; i < lineMap.size(); i++) {
-			lineMap[i] = get_next_byte();
-		}
-	} else if (header.lineCount < 65536) {
-		for (uint32_t i = 0; i < lineMap.size(); i++) {
-			lineMap[i] = get_next_byte();
-			lineMap[i] |= (uint16_t)get_next_byte() << 8;
-		}
-	} else {
-		for (uint32_t i = 0; i < lineMap.size(); i++) {
-			lineMap[i] = get_next_byte();
-			lineMap[i] |= (uint32_t)get_next_byte() << 8;
-			lineMap[i] |= (uint32_t)get_next_byte() << 16;
-			lineMap[i] |= (uint32_t)get_next_byte() << 24;
-		}
-	}
-
+	read_line_map();
 	upvalueNames.resize(upvalues.size());
 
 	for (uint8_t i = 0; i < upvalueNames.size(); i++) {
@@ -196,9 +249,134 @@ void Bytecode::Prototype::read_debug_info() {
 	variableInfos.shrink_to_fit();
 }
 
+void Bytecode::Prototype::read_line_map() {
+	const uint8_t lineSize = get_line_size();
+	assert(instructions.size() * lineSize <= block.size() - position, "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+	const uint8_t* const lines = block.data() + position;
+	position += instructions.size() * lineSize;
+
+	if (bytecode.keepNativeLineMap) {
+		nativeLineMap.assign(lines, lines + instructions.size() * lineSize);
+		return;
+	}
+
+	lineMap.resize(instructions.size());
+	const __m128i zero = _mm_setzero_si128();
+	__m128i vector;
+	uint32_t i = 0;
+
+	switch (lineSize) {
+	case 1:
+		for (; i + 16 <= lineMap.size(); i += 16) {
+			vector = _mm_loadu_si128((const __m128i*)(lines + i));
+			_mm_storeu_si128((__m128i*)(lineMap.data() + i), _mm_unpacklo_epi16(_mm_unpacklo_epi8(vector, zero), zero));
+			_mm_storeu_si128((__m128i*)(lineMap.data() + i + 4), _mm_unpackhi_epi16(_mm_unpacklo_epi8(vector, zero), zero));
+			_mm_storeu_si128((__m128i*)(lineMap.data() + i + 8), _mm_unpacklo_epi16(_mm_unpackhi_epi8(vector, zero), zero));
+			_mm_storeu_si128((__m128i*)(lineMap.data() + i + 12), _mm_unpackhi_epi16(_mm_unpackhi_epi8(vector, zero), zero));
+		}
+
+		for (; i < lineMap.size(); i++) {
+			lineMap[i] = lines[i];
+		}
+
+		return;
+	case 2:
+		for (; i + 8 <= lineMap.size(); i += 8) {
+			vector = _mm_loadu_si128((const __m128i*)(lines + i * 2));
+			_mm_storeu_si128((__m128i*)(lineMap.data() + i), _mm_unpacklo_epi16(vector, zero));
+			_mm_storeu_si128((__m128i*)(lineMap.data() + i + 4), _mm_unpackhi_epi16(vector, zero));
+		}
+
+		for (; i < lineMap.size(); i++) {
+			lineMap[i] = lines[i * 2] | (uint16_t)lines[i * 2 + 1] << 8;
+		}
+
+		return;
+	case 4:
+		std::memcpy(lineMap.data(), lines, lineMap.size() * 4);
+		return;
+	}
+}
+
+void Bytecode::Prototype::count_children() {
+	position = headerSize;
+	assert((uint64_t)header.instructionCount * 4 + header.upvalueCount * 2 <= block.size() - position, "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+	position += header.instructionCount * 4 + header.upvalueCount * 2;
+	childCount = 0;
+	uint32_t type, size;
+
+	for (uint32_t i = header.constantCount; i--;) {
+		type = get_uleb128();
+
+		switch (type) {
+		case BC_KGC_CHILD:
+			childCount++;
+			continue;
+		case BC_KGC_TAB:
+			size = get_uleb128();
+			size += get_uleb128() * 2;
+
+			while (size--) {
+				skip_table_constant();
+			}
+
+			continue;
+		case BC_KGC_COMPLEX:
+			get_uleb128();
+			get_uleb128();
+		case BC_KGC_I64:
+		case BC_KGC_U64:
+			get_uleb128();
+			get_uleb128();
+			continue;
+		default:
+			assert(type - BC_KGC_STR <= block.size() - position, "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+			position += type - BC_KGC_STR;
+			continue;
+		}
+	}
+}
+
+void Bytecode::Prototype::skip_table_constant() {
+	const uint32_t type = get_uleb128();
+
+	switch (type) {
+	case BC_KTAB_NIL:
+	case BC_KTAB_FALSE:
+	case BC_KTAB_TRUE:
+		return;
+	case BC_KTAB_NUM:
+		get_uleb128();
+	case BC_KTAB_INT:
+		get_uleb128();
+		return;
+	default:
+		assert(type - BC_KTAB_STR <= block.size() - position, "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+		position += type - BC_KTAB_STR;
+		return;
+	}
+}
+
+uint32_t Bytecode::Prototype::get_line(const uint32_t& index) const {
+	if (lineMap.size()) return lineMap[index];
+
+	switch (get_line_size()) {
+	case 1:
+		return nativeLineMap[index];
+	case 2:
+		return nativeLineMap[index * 2] | (uint16_t)nativeLineMap[index * 2 + 1] << 8;
+	default:
+		return nativeLineMap[index * 4] | (uint32_t)nativeLineMap[index * 4 + 1] << 8 | (uint32_t)nativeLineMap[index * 4 + 2] << 16 | (uint32_t)nativeLineMap[index * 4 + 3] << 24;
+	}
+}
+
+uint8_t Bytecode::Prototype::get_line_size() const {
+	return header.lineCount < 256 ? 1 : (header.lineCount < 65536 ? 2 : 4);
+}
+
 uint8_t Bytecode::Prototype::get_next_byte() {
-	assert(prototypeSize < bytecode.fileBuffer.size(), "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
-	return bytecode.fileBuffer[prototypeSize++];
+	assert(position < block.size(), "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+	return block[position++];
 }
 
 uint32_t Bytecode::Prototype::get_uleb128() {
@@ -246,6 +424,14 @@ std::string Bytecode::Prototype::get_string() {
 	return string;
 }
 
+Bytecode::PoolRange Bytecode::Prototype::get_pool_string(const uint32_t& size) {
+	assert(size <= block.size() - position, "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+	const PoolRange string = { .offset = (uint32_t)stringPool.size(), .size = size };
+	stringPool.append((const char*)block.data() + position, size);
+	position += size;
+	return string;
+}
+
 Bytecode::TableConstant Bytecode::Prototype::get_table_constant() {
 	TableConstant tableConstant;
 	const uint32_t type = get_uleb128();
@@ -267,12 +453,7 @@ Bytecode::TableConstant Bytecode::Prototype::get_table_constant() {
 		break;
 	default:
 		tableConstant.type = BC_KTAB_STR;
-		tableConstant.string.resize(type - BC_KGC_STR);
-
-		for (uint32_t i = 0; i < tableConstant.string.size(); i++) {
-			tableConstant.string[i] = get_next_byte();
-		}
-
+		tableConstant.string = get_pool_string(type - BC_KTAB_STR);
 		break;
 	}
 
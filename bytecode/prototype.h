@@ -1,9 +1,27 @@
 class Bytecode::Prototype {
 public:
 
-	Prototype(const Bytecode& bytecode);
+	Prototype(const Bytecode& bytecode, const uint32_t& index, const uint64_t& fileOffset);
 
 	void operator()(std::vector<Prototype*>& unlinkedPrototypes);
+	void read_header_only(const uint32_t& size);
+	void load();
+	void unload();
+	uint32_t get_child_count();
+
+	std::string_view get_string(const PoolRange& string) const {
+		return std::string_view(stringPool.data() + string.offset, string.size);
+	}
+
+	std::span<const TableConstant> get_array(const Constant& constant) const {
+		return std::span<const TableConstant>(tableArrayPool.data() + constant.array.offset, constant.array.size);
+	}
+
+	std::span<const TableNode> get_table(const Constant& constant) const {
+		return std::span<const TableNode>(tableNodePool.data() + constant.table.offset, constant.table.size);
+	}
+
+	uint32_t get_line(const uint32_t& index) const;
 
 	struct {
 		uint8_t flags = 0;
@@ -12,13 +30,27 @@ public:
 		bool hasDebugInfo = false;
 		uint32_t firstLine = 0;
 		uint32_t lineCount = 0;
+		uint8_t upvalueCount = 0;
+		uint32_t constantCount = 0;
+		uint32_t numberConstantCount = 0;
+		uint32_t instructionCount = 0;
 	} header;
 
+	const uint32_t index;
+	const uint64_t fileOffset;
+	bool isLoaded = false;
+	uint32_t childCount = INVALID_COUNT;
+	uint32_t descendants = INVALID_COUNT;
+
 	std::vector<Instruction> instructions;
 	std::vector<uint16_t> upvalues;
 	std::vector<Constant> constants;
+	std::vector<TableConstant> tableArrayPool;
+	std::vector<TableNode> tableNodePool;
+	std::string stringPool;
 	std::vector<NumberConstant> numberConstants;
 	std::vector<uint32_t> lineMap;
+	std::vector<uint8_t> nativeLineMap;
 	std::vector<std::string> upvalueNames;
 	std::vector<VariableInfo> variableInfos;
 	uint32_t prototypeSize = 0;
@@ -26,16 +58,26 @@ public:
 private:
 
 	void read_header();
+	void read_body(std::vector<Prototype*>& unlinkedPrototypes);
+	template <uint8_t version>
 	void read_instructions();
 	void read_upvalues();
 	void read_constants(std::vector<Prototype*>& unlinkedPrototypes);
 	void read_number_constants();
 	void read_debug_info();
+	void read_line_map();
+	void count_children();
+	void skip_table_constant();
+	uint8_t get_line_size() const;
 	uint8_t get_next_byte();
 	uint32_t get_uleb128();
 	uint32_t get_uleb128_33();
 	std::string get_string();
+	PoolRange get_pool_string(const uint32_t& size);
 	TableConstant get_table_constant();
 
 	const Bytecode& bytecode;
+	std::span<const uint8_t> block;
+	uint32_t position = 0;
+	uint32_t headerSize = 0;
 };
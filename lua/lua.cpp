@@ -1,45 +1,171 @@
 #include "..\main.h"
 
-Lua::Lua(const Bytecode& bytecode, const Ast& ast, const std::string& filePath, const bool& forceOverwrite, const bool& minimizeDiffs, const bool& unrestrictedAscii)
-	: bytecode(bytecode), ast(ast), filePath(filePath), forceOverwrite(forceOverwrite), minimizeDiffs(minimizeDiffs), unrestrictedAscii(unrestrictedAscii) {}
+Lua::Lua(const Bytecode& bytecode, Ast& ast, const std::string& filePath, const bool& forceOverwrite, const bool& minimizeDiffs, const bool& unrestrictedAscii, const bool& flushFile)
+	: bytecode(bytecode), ast(ast), filePath(filePath), forceOverwrite(forceOverwrite), minimizeDiffs(minimizeDiffs), unrestrictedAscii(unrestrictedAscii), flushFile(flushFile) {}
 
 Lua::~Lua() {
+	if (file == INVALID_HANDLE_VALUE) return;
 	close_file();
+	DeleteFileA((filePath + TEMPORARY_EXTENSION).c_str());
 }
 
 void Lua::operator()() {
 	print_progress_bar();
 	prototypeDataLeft = bytecode.prototypesTotalSize;
-	write_header();
-	if (ast.chunk->block.size()) write_block(*ast.chunk, ast.chunk->block);
-	prototypeDataLeft -= ast.chunk->prototype.prototypeSize;
-	print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	fragments.emplace_back(Fragment{ .function = ast.chunk });
+
+	if (ast.isStreaming) {
+		stream_chunk();
+		fragments.clear();
+		fragmentIndices.clear();
+		erase_progress_bar();
+		return;
+	}
+
+	collect_fragments(*ast.chunk);
+
+	const auto has_smaller_function = [this](const uint32_t& first, const uint32_t& second)->bool {
+		return fragments[first].function->prototype.prototypeSize < fragments[second].function->prototype.prototypeSize;
+	};
+
+	run_task_tree<uint32_t>(std::min<uint32_t>(get_file_thread_count(), fragments.size()), { 0 }, has_smaller_function, [this](const uint32_t& worker, const uint32_t& index, std::vector<uint32_t>& insertedFragments) {
+		if (index) {
+			write_function_body(fragments[index], *fragments[index].function, fragments[index].indentLevel);
+		} else {
+			write_chunk(fragments.front());
+		}
+
+		for (uint32_t i = 0; i < fragments[index].insertions.size(); i++) {
+			insertedFragments.emplace_back(fragments[index].insertions[i].fragment);
+		}
+
+		if (!worker) print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	});
+
+	if (fragments.front().insertions.size()) {
+		uint64_t bufferSize = 0;
+
+		for (uint32_t i = fragments.size(); i--;) {
+			bufferSize += fragments[i].buffer.size();
+		}
+
+		writeBuffer.reserve(bufferSize);
+		write_fragment(fragments.front());
+	} else {
+		writeBuffer = std::move(fragments.front().buffer);
+	}
+
+	fragments.clear();
+	fragmentIndices.clear();
 	create_file();
 	write_file();
-	close_file();
+	commit_file();
 	erase_progress_bar();
 }
 
-void Lua::write_header() {
-	if (!unrestrictedAscii) write(UTF8_BOM);
+void Lua::collect_fragments(const Ast::Function& function) {
+	for (uint32_t i = function.childFunctions.size(); i--;) {
+		if (function.childFunctions[i]->prototype.prototypeSize >= MIN_FRAGMENT_SIZE) {
+			fragmentIndices.emplace(function.childFunctions[i], fragments.size());
+			fragments.emplace_back(Fragment{ .function = function.childFunctions[i] });
+		}
+
+		collect_fragments(*function.childFunctions[i]);
+	}
+}
+
+void Lua::stream_chunk() {
+	for (uint32_t i = 0; i < ast.chunk->childFunctions.size(); i++) {
+		fragmentIndices.emplace(ast.chunk->childFunctions[i], fragments.size());
+		fragments.emplace_back(Fragment{ .function = ast.chunk->childFunctions[i] });
+	}
+
+	write_chunk(fragments.front());
+	create_file();
+	const Fragment& chunk = fragments.front();
+	std::vector<Ast::Function*> functions;
+	uint64_t offset = 0;
+
+	for (uint32_t i = 0, windowBegin; i < chunk.insertions.size();) {
+		windowBegin = i;
+
+		for (; i < chunk.insertions.size() && functions.size() < get_file_thread_count(); i++) {
+			functions.emplace_back(ast.chunk->childFunctions[chunk.insertions[i].fragment - 1]);
+		}
+
+		ast.build_functions(functions);
+
+		run_parallel(functions.size(), [this, &chunk, &windowBegin](const uint32_t& worker) {
+			Fragment& fragment = fragments[chunk.insertions[windowBegin + worker].fragment];
+			write_function_body(fragment, *fragment.function, fragment.indentLevel);
+		});
+
+		for (uint32_t j = windowBegin; j < i; j++) {
+			writeBuffer.append(chunk.buffer, offset, chunk.insertions[j].offset - offset);
+			writeBuffer += fragments[chunk.insertions[j].fragment].buffer;
+			fragments[chunk.insertions[j].fragment].buffer = {};
+			offset = chunk.insertions[j].offset;
+		}
+
+		write_file();
+		ast.release_functions(functions);
+		functions.clear();
+		print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	}
+
+	writeBuffer.append(chunk.buffer, offset);
+	write_file();
+	commit_file();
+}
+
+void Lua::write_fragment(const Fragment& fragment) {
+	uint64_t offset = 0;
+
+	for (uint32_t i = 0; i < fragment.insertions.size(); i++) {
+		writeBuffer.append(fragment.buffer, offset, fragment.insertions[i].offset - offset);
+		write_fragment(fragments[fragment.insertions[i].fragment]);
+		offset = fragment.insertions[i].offset;
+	}
+
+	writeBuffer.append(fragment.buffer, offset);
+}
+
+void Lua::write_chunk(Fragment& fragment) {
+	write_header(fragment);
+
+	if (&ast.chunk->prototype != bytecode.main) {
+		write(fragment, "return function");
+		write_function_definition(fragment, *ast.chunk, false, 0);
+		write(fragment, NEW_LINE);
+		return;
+	}
+
+	if (ast.chunk->block.size()) write_block(fragment, *ast.chunk, ast.chunk->block, 0);
+	prototypeDataLeft -= ast.chunk->prototype.prototypeSize;
+}
+
+void Lua::write_header(Fragment& fragment) {
+	if (!unrestrictedAscii) write(fragment, UTF8_BOM);
 	if (!bytecode.header.chunkname.size()) return;
-	write("-- chunkname: ");
-	write_string(bytecode.header.chunkname);
-	write(NEW_LINE, NEW_LINE);
+	write(fragment, "-- chunkname: ");
+	write_string(fragment, bytecode.header.chunkname);
+	write(fragment, NEW_LINE, NEW_LINE);
 }
 
-void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Statement*>& block) {
-	std::vector<Ast::Statement*>* elseBlock;
+void Lua::write_block(Fragment& fragment, const Ast::Function& function, const std::vector<Ast::Statement*>& block, const uint32_t& indentLevel) {
+	const std::vector<Ast::Statement*>* elseBlock;
 	bool isFunctionDefinition;
 	bool previousLineIsEmpty = true;
 
 	if (!block.size()) {
-		write_indent();
-		write("-- block empty", NEW_LINE);
+		write_indent(fragment, indentLevel);
+		write(fragment, "-- block empty", NEW_LINE);
 		return;
 	}
 
 	for (uint32_t i = 0; i < block.size(); i++) {
+		ast.check_budget();
+
 		if (!previousLineIsEmpty) {
 			switch (block[i - 1]->type) {
 			case Ast::AST_STATEMENT_RETURN:
@@ -72,82 +198,79 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 				break;
 			}
 
-			if (previousLineIsEmpty) write(NEW_LINE);
+			if (previousLineIsEmpty) write(fragment, NEW_LINE);
 		}
 
 		switch (block[i]->type) {
 		case Ast::AST_STATEMENT_RETURN:
-			write_indent();
-			if (i != block.size() - 1) write("do ");
-			write("return");
+			write_indent(fragment, indentLevel);
+			if (i != block.size() - 1) write(fragment, "do ");
+			write(fragment, "return");
 
-			if (block[i]->assignment.expressions.size() || block[i]->assignment.multresReturn) {
-				write(" ");
-				write_expression_list(block[i]->assignment.expressions, block[i]->assignment.multresReturn);
+			if (block[i]->assignment->expressions.size() || block[i]->assignment->multresReturn) {
+				write(fragment, " ");
+				write_expression_list(fragment, block[i]->assignment->expressions, block[i]->assignment->multresReturn, indentLevel);
 			}
 
-			if (i != block.size() - 1) write(" end");
+			if (i != block.size() - 1) write(fragment, " end");
 			break;
 		case Ast::AST_STATEMENT_GOTO:
-			write_indent();
-			write("goto ", function.labels[block[i]->instruction.label].name);
+			write_indent(fragment, indentLevel);
+			write(fragment, "goto ");
+			write_symbol(fragment, function.labels[block[i]->instruction.label].name);
 			break;
 		case Ast::AST_STATEMENT_NUMERIC_FOR:
-			write_indent();
-			write("for ");
-			write_variable(block[i]->assignment.variables.back(), false);
-			write(" = ");
-			write_expression(*block[i]->assignment.expressions[0], false);
-			write(", ");
-			write_expression(*block[i]->assignment.expressions[1], false);
-
-			if (block[i]->assignment.expressions.size() == 3) {
-				write(", ");
-				write_expression(*block[i]->assignment.expressions[2], false);
+			write_indent(fragment, indentLevel);
+			write(fragment, "for ");
+			write_variable(fragment, block[i]->assignment->variables.back(), false, indentLevel);
+			write(fragment, " = ");
+			write_expression(fragment, *block[i]->assignment->expressions[0], false, indentLevel);
+			write(fragment, ", ");
+			write_expression(fragment, *block[i]->assignment->expressions[1], false, indentLevel);
+
+			if (block[i]->assignment->expressions.size() == 3) {
+				write(fragment, ", ");
+				write_expression(fragment, *block[i]->assignment->expressions[2], false, indentLevel);
 			}
 
-			write(" do", NEW_LINE);
-			indentLevel++;
-			write_block(function, block[i]->block);
-			indentLevel--;
-			write_indent();
-			write("end");
+			write(fragment, " do", NEW_LINE);
+			write_block(fragment, function, *block[i]->block, indentLevel + 1);
+			write_indent(fragment, indentLevel);
+			write(fragment, "end");
 			break;
 		case Ast::AST_STATEMENT_GENERIC_FOR:
-			write_indent();
-			write("for ");
-			write_assignment(block[i]->assignment.variables, block[i]->assignment.expressions, " in ", false);
-			write(" do", NEW_LINE);
-			indentLevel++;
-			write_block(function, block[i]->block);
-			indentLevel--;
-			write_indent();
-			write("end");
+			write_indent(fragment, indentLevel);
+			write(fragment, "for ");
+			write_assignment(fragment, block[i]->assignment->variables, block[i]->assignment->expressions, " in ", false, indentLevel);
+			write(fragment, " do", NEW_LINE);
+			write_block(fragment, function, *block[i]->block, indentLevel + 1);
+			write_indent(fragment, indentLevel);
+			write(fragment, "end");
 			break;
 		case Ast::AST_STATEMENT_BREAK:
-			write_indent();
-			if (i != block.size() - 1) write("do ");
-			write("break");
-			if (i != block.size() - 1) write(" end");
+			write_indent(fragment, indentLevel);
+			if (i != block.size() - 1) write(fragment, "do ");
+			write(fragment, "break");
+			if (i != block.size() - 1) write(fragment, " end");
 			break;
 		case Ast::AST_STATEMENT_DECLARATION:
 			isFunctionDefinition = false;
 
-			if (block[i]->assignment.variables.size() == 1
-				&& block[i]->assignment.expressions.size() == 1
-				&& block[i]->assignment.expressions.back()->type == Ast::AST_EXPRESSION_FUNCTION) {
+			if (block[i]->assignment->variables.size() == 1
+				&& block[i]->assignment->expressions.size() == 1
+				&& block[i]->assignment->expressions.back()->type == Ast::AST_EXPRESSION_FUNCTION) {
 				isFunctionDefinition = true;
 
-				if (!block[i]->assignment.expressions.back()->function->assignmentSlotIsUpvalue) {
-					for (uint8_t j = block[i]->assignment.expressions.back()->function->upvalues.size(); j--;) {
-						if ((*block[i]->assignment.expressions.back()->function->upvalues[j].slotScope)->name != (*block[i]->assignment.variables.back().slotScope)->name) continue;
+				if (!block[i]->assignment->expressions.back()->function->assignmentSlotIsUpvalue) {
+					for (uint8_t j = block[i]->assignment->expressions.back()->function->upvalues.size(); j--;) {
+						if ((*block[i]->assignment->expressions.back()->function->upvalues[j].slotScope)->name != (*block[i]->assignment->variables.back().slotScope)->name) continue;
 						isFunctionDefinition = false;
 						break;
 					}
 
 					if (isFunctionDefinition) {
-						for (uint32_t j = block[i]->assignment.expressions.back()->function->usedGlobals.size(); j--;) {
-							if (*block[i]->assignment.expressions.back()->function->usedGlobals[j] != (*block[i]->assignment.variables.back().slotScope)->name) continue;
+						for (uint32_t j = block[i]->assignment->expressions.back()->function->usedGlobals.size(); j--;) {
+							if (block[i]->assignment->expressions.back()->function->usedGlobals[j] != (*block[i]->assignment->variables.back().slotScope)->name) continue;
 							isFunctionDefinition = false;
 							break;
 						}
@@ -156,31 +279,31 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 			}
 
 			if (isFunctionDefinition) {
-				if (!previousLineIsEmpty) write(NEW_LINE);
-				write_indent();
-				write("local function ");
-				write_variable(block[i]->assignment.variables.back(), false);
-				write_function_definition(*block[i]->assignment.expressions.back()->function, false);
+				if (!previousLineIsEmpty) write(fragment, NEW_LINE);
+				write_indent(fragment, indentLevel);
+				write(fragment, "local function ");
+				write_variable(fragment, block[i]->assignment->variables.back(), false, indentLevel);
+				write_function_definition(fragment, *block[i]->assignment->expressions.back()->function, false, indentLevel);
 
 				if (i != block.size() - 1) {
-					write(NEW_LINE, NEW_LINE);
+					write(fragment, NEW_LINE, NEW_LINE);
 					previousLineIsEmpty = true;
 					continue;
 				}
 			} else {
-				write_indent();
-				write("local ");
-				write_assignment(block[i]->assignment.variables, block[i]->assignment.expressions, " = ", false);
+				write_indent(fragment, indentLevel);
+				write(fragment, "local ");
+				write_assignment(fragment, block[i]->assignment->variables, block[i]->assignment->expressions, " = ", false, indentLevel);
 			}
 
 			break;
 		case Ast::AST_STATEMENT_ASSIGNMENT:
 			isFunctionDefinition = false;
 
-			if (block[i]->assignment.variables.size() == 1
-				&& block[i]->assignment.expressions.size() == 1
-				&& block[i]->assignment.expressions.back()->type == Ast::AST_EXPRESSION_FUNCTION) {
-				for (Ast::Variable* variable = &block[i]->assignment.variables.back(); true; variable = variable->table->variable) {
+			if (block[i]->assignment->variables.size() == 1
+				&& block[i]->assignment->expressions.size() == 1
+				&& block[i]->assignment->expressions.back()->type == Ast::AST_EXPRESSION_FUNCTION) {
+				for (const Ast::Variable* variable = &block[i]->assignment->variables.back(); true; variable = variable->table->variable) {
 					switch (variable->type) {
 					case Ast::AST_VARIABLE_SLOT:
 					case Ast::AST_VARIABLE_UPVALUE:
@@ -199,23 +322,23 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 			}
 
 			if (isFunctionDefinition) {
-				if (!previousLineIsEmpty) write(NEW_LINE);
-				write_indent();
-				write("function ");
-
-				if (block[i]->assignment.variables.back().type == Ast::AST_VARIABLE_TABLE_INDEX
-					&& block[i]->assignment.expressions.back()->function->parameterNames.size()
-					&& block[i]->assignment.expressions.back()->function->parameterNames.front() == "self") {
-					write_variable(*block[i]->assignment.variables.back().table->variable, false);
-					write(":", block[i]->assignment.variables.back().tableIndex->constant->string);
-					write_function_definition(*block[i]->assignment.expressions.back()->function, true);
+				if (!previousLineIsEmpty) write(fragment, NEW_LINE);
+				write_indent(fragment, indentLevel);
+				write(fragment, "function ");
+
+				if (block[i]->assignment->variables.back().type == Ast::AST_VARIABLE_TABLE_INDEX
+					&& block[i]->assignment->expressions.back()->function->parameterNames.size()
+					&& block[i]->assignment->expressions.back()->function->parameterNames.front() == "self") {
+					write_variable(fragment, *block[i]->assignment->variables.back().table->variable, false, indentLevel);
+					write(fragment, ":", block[i]->assignment->variables.back().tableIndex->constant->string);
+					write_function_definition(fragment, *block[i]->assignment->expressions.back()->function, true, indentLevel);
 				} else {
-					write_variable(block[i]->assignment.variables.back(), false);
-					write_function_definition(*block[i]->assignment.expressions.back()->function, false);
+					write_variable(fragment, block[i]->assignment->variables.back(), false, indentLevel);
+					write_function_definition(fragment, *block[i]->assignment->expressions.back()->function, false, indentLevel);
 				}
 
 				if (i != block.size() - 1) {
-					write(NEW_LINE, NEW_LINE);
+					write(fragment, NEW_LINE, NEW_LINE);
 					previousLineIsEmpty = true;
 					continue;
 				}
@@ -223,187 +346,175 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 				break;
 			}
 
-			write_indent();
-			write_assignment(block[i]->assignment.variables, block[i]->assignment.expressions, " = ", i);
+			write_indent(fragment, indentLevel);
+			write_assignment(fragment, block[i]->assignment->variables, block[i]->assignment->expressions, " = ", i, indentLevel);
 			break;
 		case Ast::AST_STATEMENT_FUNCTION_CALL:
-			write_indent();
-			write_function_call(*block[i]->assignment.expressions.back()->functionCall, i);
+			write_indent(fragment, indentLevel);
+			write_function_call(fragment, *block[i]->assignment->expressions.back()->functionCall, i, indentLevel);
 			break;
 		case Ast::AST_STATEMENT_IF:
-			write_indent();
-			write("if ");
-			write_expression(*block[i]->assignment.expressions.back(), false);
-			write(" then", NEW_LINE);
-			indentLevel++;
-			write_block(function, block[i]->block);
-			indentLevel--;
-			write_indent();
+			write_indent(fragment, indentLevel);
+			write(fragment, "if ");
+			write_expression(fragment, *block[i]->assignment->expressions.back(), false, indentLevel);
+			write(fragment, " then", NEW_LINE);
+			write_block(fragment, function, *block[i]->block, indentLevel + 1);
+			write_indent(fragment, indentLevel);
 
 			if (i + 1 < block.size() && block[i + 1]->type == Ast::AST_STATEMENT_ELSE) {
 				i++;
-				elseBlock = &block[i]->block;
+				elseBlock = &*block[i]->block;
 
 				while (true) {
 					if (elseBlock->size() == 1 && elseBlock->front()->type == Ast::AST_STATEMENT_IF) {
-						write("elseif ");
-						write_expression(*elseBlock->front()->assignment.expressions.back(), false);
-						write(" then", NEW_LINE);
-						indentLevel++;
-						write_block(function, elseBlock->front()->block);
-						indentLevel--;
-						write_indent();
+						write(fragment, "elseif ");
+						write_expression(fragment, *elseBlock->front()->assignment->expressions.back(), false, indentLevel);
+						write(fragment, " then", NEW_LINE);
+						write_block(fragment, function, *elseBlock->front()->block, indentLevel + 1);
+						write_indent(fragment, indentLevel);
 					} else if (elseBlock->size() == 2
 						&& elseBlock->front()->type == Ast::AST_STATEMENT_IF
 						&& elseBlock->back()->type == Ast::AST_STATEMENT_ELSE) {
-						write("elseif ");
-						write_expression(*elseBlock->front()->assignment.expressions.back(), false);
-						write(" then", NEW_LINE);
-						indentLevel++;
-						write_block(function, elseBlock->front()->block);
-						indentLevel--;
-						write_indent();
-						elseBlock = &elseBlock->back()->block;
+						write(fragment, "elseif ");
+						write_expression(fragment, *elseBlock->front()->assignment->expressions.back(), false, indentLevel);
+						write(fragment, " then", NEW_LINE);
+						write_block(fragment, function, *elseBlock->front()->block, indentLevel + 1);
+						write_indent(fragment, indentLevel);
+						elseBlock = &*elseBlock->back()->block;
 						continue;
 					} else {
-						write("else", NEW_LINE);
-						indentLevel++;
-						write_block(function, *elseBlock);
-						indentLevel--;
-						write_indent();
+						write(fragment, "else", NEW_LINE);
+						write_block(fragment, function, *elseBlock, indentLevel + 1);
+						write_indent(fragment, indentLevel);
 					}
 
 					break;
 				}
 			}
 
-			write("end");
+			write(fragment, "end");
 			break;
 		case Ast::AST_STATEMENT_WHILE:
-			write_indent();
-			write("while ");
-			write_expression(*block[i]->assignment.expressions.back(), false);
-			write(" do", NEW_LINE);
-			indentLevel++;
-			write_block(function, block[i]->block);
-			indentLevel--;
-			write_indent();
-			write("end");
+			write_indent(fragment, indentLevel);
+			write(fragment, "while ");
+			write_expression(fragment, *block[i]->assignment->expressions.back(), false, indentLevel);
+			write(fragment, " do", NEW_LINE);
+			write_block(fragment, function, *block[i]->block, indentLevel + 1);
+			write_indent(fragment, indentLevel);
+			write(fragment, "end");
 			break;
 		case Ast::AST_STATEMENT_REPEAT:
-			write_indent();
-			write("repeat", NEW_LINE);
-			indentLevel++;
-			write_block(function, block[i]->block);
-			indentLevel--;
-			write_indent();
-			write("until ");
-			write_expression(*block[i]->assignment.expressions.back(), false);
+			write_indent(fragment, indentLevel);
+			write(fragment, "repeat", NEW_LINE);
+			write_block(fragment, function, *block[i]->block, indentLevel + 1);
+			write_indent(fragment, indentLevel);
+			write(fragment, "until ");
+			write_expression(fragment, *block[i]->assignment->expressions.back(), false, indentLevel);
 			break;
 		case Ast::AST_STATEMENT_DO:
-			write_indent();
-			write("do", NEW_LINE);
-			indentLevel++;
-			write_block(function, block[i]->block);
-			indentLevel--;
-			write_indent();
-			write("end");
+			write_indent(fragment, indentLevel);
+			write(fragment, "do", NEW_LINE);
+			write_block(fragment, function, *block[i]->block, indentLevel + 1);
+			write_indent(fragment, indentLevel);
+			write(fragment, "end");
 			break;
 		case Ast::AST_STATEMENT_LABEL:
-			write_indent();
-			write("::", function.labels[block[i]->instruction.label].name, "::");
+			write_indent(fragment, indentLevel);
+			write(fragment, "::");
+			write_symbol(fragment, function.labels[block[i]->instruction.label].name);
+			write(fragment, "::");
 			break;
 		default:
 			throw nullptr;
 		}
 
-		write(NEW_LINE);
+		write(fragment, NEW_LINE);
 		previousLineIsEmpty = false;
 	}
 }
 
-void Lua::write_expression(const Ast::Expression& expression, const bool& useParentheses) {
+void Lua::write_expression(Fragment& fragment, const Ast::Expression& expression, const bool& useParentheses, const uint32_t& indentLevel) {
 	uint32_t nextListIndex, nextFieldIndex;
 	uint8_t operatorPrecedence, operandPrecedence;
 	bool parentheses, isFirstField, isFieldFound;
-	if (useParentheses) write("(");
+	if (useParentheses) write(fragment, "(");
 
 	switch (expression.type) {
 	case Ast::AST_EXPRESSION_CONSTANT:
 		switch (expression.constant->type) {
 		case Ast::AST_CONSTANT_NIL:
-			write("nil");
+			write(fragment, "nil");
 			break;
 		case Ast::AST_CONSTANT_FALSE:
-			write("false");
+			write(fragment, "false");
 			break;
 		case Ast::AST_CONSTANT_TRUE:
-			write("true");
+			write(fragment, "true");
 			break;
 		case Ast::AST_CONSTANT_NUMBER:
-			write_number(expression.constant->number);
+			write_number(fragment, expression.constant->number);
 			break;
 		case Ast::AST_CONSTANT_CDATA_SIGNED:
-			write(std::to_string(expression.constant->signed_integer), "LL");
+			write(fragment, std::to_string(expression.constant->signed_integer), "LL");
 			break;
 		case Ast::AST_CONSTANT_CDATA_UNSIGNED:
-			write(std::to_string(expression.constant->unsigned_integer), "ULL");
+			write(fragment, std::to_string(expression.constant->unsigned_integer), "ULL");
 			break;
 		case Ast::AST_CONSTANT_CDATA_IMAGINARY:
-			write_number(expression.constant->number);
-			write("i");
+			write_number(fragment, expression.constant->number);
+			write(fragment, "i");
 			break;
 		case Ast::AST_CONSTANT_STRING:
-			write("\"");
-			write_string(expression.constant->string);
-			write("\"");
+			write(fragment, "\"");
+			write_string(fragment, expression.constant->string);
+			write(fragment, "\"");
 			break;
 		}
 
 		break;
 	case Ast::AST_EXPRESSION_VARARG:
-		write("...");
+		write(fragment, "...");
 		break;
 	case Ast::AST_EXPRESSION_FUNCTION:
-		write("function");
-		write_function_definition(*expression.function, false);
+		write(fragment, "function");
+		write_function_definition(fragment, *expression.function, false, indentLevel);
 		break;
 	case Ast::AST_EXPRESSION_VARIABLE:
-		write_variable(*expression.variable, false);
+		write_variable(fragment, *expression.variable, false, indentLevel);
 		break;
 	case Ast::AST_EXPRESSION_FUNCTION_CALL:
-		write_function_call(*expression.functionCall, false);
+		write_function_call(fragment, *expression.functionCall, false, indentLevel);
 		break;
 	case Ast::AST_EXPRESSION_TABLE:
-		if (!expression.table->constants.list.size()
+		if (!get_constant_list_size(*expression.table)
 			&& !expression.table->constants.fields.size()
+			&& !expression.table->constants.nodeCount
 			&& !expression.table->fields.size()
 			&& !expression.table->multresField) {
-			write("{}");
+			write(fragment, "{}");
 			break;
 		}
 
-		write("{", NEW_LINE);
-		indentLevel++;
-		write_indent();
+		write(fragment, "{", NEW_LINE);
+		write_indent(fragment, indentLevel + 1);
 		nextListIndex = 1;
 		nextFieldIndex = 0;
 		isFirstField = true;
 
-		if (expression.table->constants.list.size() && expression.table->constants.list.front()->constant->type != Ast::AST_CONSTANT_NIL) {
-			write("[0] = ");
-			write_expression(*expression.table->constants.list.front(), false);
+		if (get_constant_list_size(*expression.table) && !is_nil_list_constant(*expression.table, 0)) {
+			write(fragment, "[0] = ");
+			write_list_constant(fragment, *expression.table, 0, indentLevel + 1);
 			isFirstField = false;
 		}
 
 		while (!expression.table->multresField || nextListIndex < expression.table->multresIndex) {
-			if (nextListIndex < expression.table->constants.list.size() && expression.table->constants.list[nextListIndex]->constant->type != Ast::AST_CONSTANT_NIL) {
+			if (nextListIndex < get_constant_list_size(*expression.table) && !is_nil_list_constant(*expression.table, nextListIndex)) {
 				if (!isFirstField) {
-					write(",", NEW_LINE);
-					write_indent();
+					write(fragment, ",", NEW_LINE);
+					write_indent(fragment, indentLevel + 1);
 				}
 
-				write_expression(*expression.table->constants.list[nextListIndex], false);
+				write_list_constant(fragment, *expression.table, nextListIndex, indentLevel + 1);
 				isFirstField = false;
 				nextListIndex++;
 				continue;
@@ -420,20 +531,20 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 
 				while (nextFieldIndex < i) {
 					if (!isFirstField) {
-						write(",", NEW_LINE);
-						write_indent();
+						write(fragment, ",", NEW_LINE);
+						write_indent(fragment, indentLevel + 1);
 					}
 
 					if (expression.table->fields[nextFieldIndex].key->type == Ast::AST_EXPRESSION_CONSTANT && expression.table->fields[nextFieldIndex].key->constant->isName) {
-						write(expression.table->fields[nextFieldIndex].key->constant->string);
+						write(fragment, expression.table->fields[nextFieldIndex].key->constant->string);
 					} else {
-						write("[");
-						write_expression(*expression.table->fields[nextFieldIndex].key, false);
-						write("]");
+						write(fragment, "[");
+						write_expression(fragment, *expression.table->fields[nextFieldIndex].key, false, indentLevel + 1);
+						write(fragment, "]");
 					}
 
-					write(" = ");
-					write_expression(*expression.table->fields[nextFieldIndex].value, false);
+					write(fragment, " = ");
+					write_expression(fragment, *expression.table->fields[nextFieldIndex].value, false, indentLevel + 1);
 					isFirstField = false;
 					nextFieldIndex++;
 				}
@@ -443,22 +554,23 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 
 			if (isFieldFound) {
 				if (!isFirstField) {
-					write(",", NEW_LINE);
-					write_indent();
+					write(fragment, ",", NEW_LINE);
+					write_indent(fragment, indentLevel + 1);
 				}
 
 				if (!expression.table->multresField
 					&& nextFieldIndex == expression.table->fields.size() - 1
 					&& !expression.table->constants.fields.size()
-					&& (!expression.table->constants.list.size()
-						|| nextListIndex >= expression.table->constants.list.size() - 1)) {
+					&& !expression.table->constants.nodeCount
+					&& (!get_constant_list_size(*expression.table)
+						|| nextListIndex >= get_constant_list_size(*expression.table) - 1)) {
 					switch (expression.table->fields.back().value->type) {
 					case Ast::AST_EXPRESSION_VARARG:
 					case Ast::AST_EXPRESSION_FUNCTION_CALL:
-						write_expression(*expression.table->fields.back().value, true);
+						write_expression(fragment, *expression.table->fields.back().value, true, indentLevel + 1);
 						break;
 					default:
-						write_expression(*expression.table->fields.back().value, false);
+						write_expression(fragment, *expression.table->fields.back().value, false, indentLevel + 1);
 						break;
 					}
 
@@ -467,88 +579,109 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 					break;
 				}
 
-				write_expression(*expression.table->fields[nextFieldIndex].value, false);
+				write_expression(fragment, *expression.table->fields[nextFieldIndex].value, false, indentLevel + 1);
 				nextFieldIndex++;
-			} else if (!expression.table->multresField && nextListIndex >= expression.table->constants.list.size()) {
+			} else if (!expression.table->multresField && nextListIndex >= get_constant_list_size(*expression.table)) {
 				break;
 			} else {
 				if (!isFirstField) {
-					write(",", NEW_LINE);
-					write_indent();
+					write(fragment, ",", NEW_LINE);
+					write_indent(fragment, indentLevel + 1);
 				}
 
-				write("nil");
+				write(fragment, "nil");
 			}
 
 			isFirstField = false;
 			nextListIndex++;
 		}
 
-		for (uint32_t i = nextListIndex; i < expression.table->constants.list.size(); i++) {
-			if (expression.table->constants.list[i]->constant->type == Ast::AST_CONSTANT_NIL) continue;
+		for (uint32_t i = nextListIndex; i < get_constant_list_size(*expression.table); i++) {
+			if (is_nil_list_constant(*expression.table, i)) continue;
 
 			if (!isFirstField) {
-				write(",", NEW_LINE);
-				write_indent();
+				write(fragment, ",", NEW_LINE);
+				write_indent(fragment, indentLevel + 1);
 			}
 
-			write("[", std::to_string(i), "] = ");
-			write_expression(*expression.table->constants.list[i], false);
+			write(fragment, "[", std::to_string(i), "] = ");
+			write_list_constant(fragment, *expression.table, i, indentLevel + 1);
 			isFirstField = false;
 		}
 
 		for (uint32_t i = 0; i < expression.table->constants.fields.size(); i++) {
 			if (!isFirstField) {
-				write(",", NEW_LINE);
-				write_indent();
+				write(fragment, ",", NEW_LINE);
+				write_indent(fragment, indentLevel + 1);
 			}
 
 			if (expression.table->constants.fields[i].key->constant->isName) {
-				write(expression.table->constants.fields[i].key->constant->string);
+				write(fragment, expression.table->constants.fields[i].key->constant->string);
+			} else {
+				write(fragment, "[");
+				write_expression(fragment, *expression.table->constants.fields[i].key, false, indentLevel + 1);
+				write(fragment, "]");
+			}
+
+			write(fragment, " = ");
+			write_expression(fragment, *expression.table->constants.fields[i].value, false, indentLevel + 1);
+			isFirstField = false;
+		}
+
+		for (uint32_t i = 0; i < expression.table->constants.nodes.size(); i++) {
+			if (expression.table->constants.excludedNodes.size() && expression.table->constants.excludedNodes[i]) continue;
+
+			if (!isFirstField) {
+				write(fragment, ",", NEW_LINE);
+				write_indent(fragment, indentLevel + 1);
+			}
+
+			if (expression.table->constants.nodes[i].key.type == Bytecode::BC_KTAB_STR
+				&& Ast::is_valid_name(expression.table->constants.prototype->get_string(expression.table->constants.nodes[i].key.string))) {
+				write(fragment, expression.table->constants.prototype->get_string(expression.table->constants.nodes[i].key.string));
 			} else {
-				write("[");
-				write_expression(*expression.table->constants.fields[i].key, false);
-				write("]");
+				write(fragment, "[");
+				write_table_constant(fragment, *expression.table->constants.prototype, expression.table->constants.nodes[i].key);
+				write(fragment, "]");
 			}
 
-			write(" = ");
-			write_expression(*expression.table->constants.fields[i].value, false);
+			write(fragment, " = ");
+			write_table_constant(fragment, *expression.table->constants.prototype, expression.table->constants.nodes[i].value);
 			isFirstField = false;
 		}
 
 		for (uint32_t i = nextFieldIndex; i < expression.table->fields.size(); i++) {
 			if (!isFirstField) {
-				write(",", NEW_LINE);
-				write_indent();
+				write(fragment, ",", NEW_LINE);
+				write_indent(fragment, indentLevel + 1);
 			}
 
 			if (expression.table->fields[i].key->type == Ast::AST_EXPRESSION_CONSTANT && expression.table->fields[i].key->constant->isName) {
-				write(expression.table->fields[i].key->constant->string);
+				write(fragment, expression.table->fields[i].key->constant->string);
 			} else {
-				write("[");
-				write_expression(*expression.table->fields[i].key, false);
-				write("]");
+				write(fragment, "[");
+				write_expression(fragment, *expression.table->fields[i].key, false, indentLevel + 1);
+				write(fragment, "]");
 			}
 
-			write(" = ");
-			write_expression(*expression.table->fields[i].value, false);
+			write(fragment, " = ");
+			write_expression(fragment, *expression.table->fields[i].value, false, indentLevel + 1);
 			isFirstField = false;
 		}
 
 		if (expression.table->multresField) {
 			if (!isFirstField) {
-				write(",", NEW_LINE);
-				write_indent();
+				write(fragment, ",", NEW_LINE);
+				write_indent(fragment, indentLevel + 1);
 			}
 
-			write_expression(*expression.table->multresField, false);
+			write_expression(fragment, *expression.table->multresField, false, indentLevel + 1);
 		}
 
-		indentLevel--;
-		write(",");  // Always add trailing comma for better readability
-		write(NEW_LINE);
-		write_indent();
-		write("}");
+		write(fragment, ",");  // Always add trailing comma for better readability
+		write(fragment, NEW_LINE);
+		write_indent(fragment, indentLevel);
+		write(fragment, "}");
 		break;
 	case Ast::AST_EXPRESSION_BINARY_OPERATION:
 		operatorPrecedence = get_operator_precedence(expression);
@@ -575,53 +708,53 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 			}
 		}
 
-		write_expression(*expression.binaryOperation->leftOperand, parentheses);
+		write_expression(fragment, *expression.binaryOperation->leftOperand, parentheses, indentLevel);
 
 		switch (expression.binaryOperation->type) {
 		case Ast::AST_BINARY_ADDITION:
-			write(" + ");
+			write(fragment, " + ");
 			break;
 		case Ast::AST_BINARY_SUBTRACTION:
-			write(" - ");
+			write(fragment, " - ");
 			break;
 		case Ast::AST_BINARY_MULTIPLICATION:
-			write(" * ");
+			write(fragment, " * ");
 			break;
 		case Ast::AST_BINARY_DIVISION:
-			write(" / ");
+			write(fragment, " / ");
 			break;
 		case Ast::AST_BINARY_EXPONENTATION:
-			write("^");
+			write(fragment, "^");
 			break;
 		case Ast::AST_BINARY_MODULO:
-			write(" % ");
+			write(fragment, " % ");
 			break;
 		case Ast::AST_BINARY_CONCATENATION:
-			write(" .. ");
+			write(fragment, " .. ");
 			break;
 		case Ast::AST_BINARY_LESS_THAN:
-			write(" < ");
+			write(fragment, " < ");
 			break;
 		case Ast::AST_BINARY_LESS_EQUAL:
-			write(" <= ");
+			write(fragment, " <= ");
 			break;
 		case Ast::AST_BINARY_GREATER_THEN:
-			write(" > ");
+			write(fragment, " > ");
 			break;
 		case Ast::AST_BINARY_GREATER_EQUAL:
-			write(" >= ");
+			write(fragment, " >= ");
 			break;
 		case Ast::AST_BINARY_EQUAL:
-			write(" == ");
+			write(fragment, " == ");
 			break;
 		case Ast::AST_BINARY_NOT_EQUAL:
-			write(" ~= ");
+			write(fragment, " ~= ");
 			break;
 		case Ast::AST_BINARY_AND:
-			write(" and ");
+			write(fragment, " and ");
 			break;
 		case Ast::AST_BINARY_OR:
-			write(" or ");
+			write(fragment, " or ");
 			break;
 		}
 
@@ -642,7 +775,7 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 			}
 		}
 
-		write_expression(*expression.binaryOperation->rightOperand, parentheses);
+		write_expression(fragment, *expression.binaryOperation->rightOperand, parentheses, indentLevel);
 		break;
 	case Ast::AST_EXPRESSION_UNARY_OPERATION:
 		parentheses = get_operator_precedence(*expression.unaryOperation->operand) < 6;
@@ -653,89 +786,89 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 				&& expression.unaryOperation->operand->type == Ast::AST_EXPRESSION_UNARY_OPERATION
 				&& expression.unaryOperation->operand->unaryOperation->type == Ast::AST_UNARY_MINUS)
 				parentheses = true;
-			write("-");
+			write(fragment, "-");
 			break;
 		case Ast::AST_UNARY_NOT:
-			write("not ");
+			write(fragment, "not ");
 			break;
 		case Ast::AST_UNARY_LENGTH:
-			write("#");
+			write(fragment, "#");
 			break;
 		}
 
-		write_expression(*expression.unaryOperation->operand, parentheses);
+		write_expression(fragment, *expression.unaryOperation->operand, parentheses, indentLevel);
 		break;
 	}
 
-	if (useParentheses) write(")");
+	if (useParentheses) write(fragment, ")");
 }
 
-void Lua::write_prefix_expression(const Ast::Expression& expression, const bool& isLineStart) {
+void Lua::write_prefix_expression(Fragment& fragment, const Ast::Expression& expression, const bool& isLineStart, const uint32_t& indentLevel) {
 	switch (expression.type) {
 	case Ast::AST_EXPRESSION_VARIABLE:
-		write_variable(*expression.variable, isLineStart);
+		write_variable(fragment, *expression.variable, isLineStart, indentLevel);
 		break;
 	case Ast::AST_EXPRESSION_FUNCTION_CALL:
-		write_function_call(*expression.functionCall, isLineStart);
+		write_function_call(fragment, *expression.functionCall, isLineStart, indentLevel);
 		break;
 	default:
-		if (isLineStart) write(";");
-		write_expression(expression, true);
+		if (isLineStart) write(fragment, ";");
+		write_expression(fragment, expression, true, indentLevel);
 		break;
 	}
 }
 
-void Lua::write_variable(const Ast::Variable& variable, const bool& isLineStart) {
+void Lua::write_variable(Fragment& fragment, const Ast::Variable& variable, const bool& isLineStart, const uint32_t& indentLevel) {
 	switch (variable.type) {
 	case Ast::AST_VARIABLE_SLOT:
 	case Ast::AST_VARIABLE_UPVALUE:
-		if (!(*variable.slotScope)->name.size()) throw nullptr;
-		write((*variable.slotScope)->name);
+		if ((*variable.slotScope)->name.type == Ast::AST_SYMBOL_NONE) throw nullptr;
+		write_symbol(fragment, (*variable.slotScope)->name);
 		break;
 	case Ast::AST_VARIABLE_GLOBAL:
-		write(variable.name);
+		write_symbol(fragment, variable.name);
 		break;
 	case Ast::AST_VARIABLE_TABLE_INDEX:
-		write_prefix_expression(*variable.table, isLineStart);
+		write_prefix_expression(fragment, *variable.table, isLineStart, indentLevel);
 
 		if (variable.tableIndex->type == Ast::AST_EXPRESSION_CONSTANT && variable.tableIndex->constant->isName) {
-			write(".", variable.tableIndex->constant->string);
+			write(fragment, ".", variable.tableIndex->constant->string);
 			break;
 		}
 
-		write("[");
-		write_expression(*variable.tableIndex, false);
-		write("]");
+		write(fragment, "[");
+		write_expression(fragment, *variable.tableIndex, false, indentLevel);
+		write(fragment, "]");
 		break;
 	}
 }
 
-void Lua::write_function_call(const Ast::FunctionCall& functionCall, const bool& isLineStart) {
+void Lua::write_function_call(Fragment& fragment, const Ast::FunctionCall& functionCall, const bool& isLineStart, const uint32_t& indentLevel) {
 	if (functionCall.isMethod) {
-		write_prefix_expression(*functionCall.function->variable->table, isLineStart);
-		write(":", functionCall.function->variable->tableIndex->constant->string);
+		write_prefix_expression(fragment, *functionCall.function->variable->table, isLineStart, indentLevel);
+		write(fragment, ":", functionCall.function->variable->tableIndex->constant->string);
 	} else {
-		write_prefix_expression(*functionCall.function, isLineStart);
+		write_prefix_expression(fragment, *functionCall.function, isLineStart, indentLevel);
 	}
 
-	write("(");
-	write_expression_list(functionCall.arguments, functionCall.multresArgument);
-	write(")");
+	write(fragment, "(");
+	write_expression_list(fragment, functionCall.arguments, functionCall.multresArgument, indentLevel);
+	write(fragment, ")");
 }
 
-void Lua::write_assignment(const std::vector<Ast::Variable>& variables, const std::vector<Ast::Expression*>& expressions, const std::string& separator, const bool& isLineStart) {
+void Lua::write_assignment(Fragment& fragment, const std::vector<Ast::Variable>& variables, const std::vector<Ast::Expression*>& expressions, const std::string& separator, const bool& isLineStart, const uint32_t& indentLevel) {
 	for (uint8_t i = 0; i < variables.size(); i++) {
-		write_variable(variables[i], i ? false : isLineStart);
-		if (i != variables.size() - 1) write(", ");
+		write_variable(fragment, variables[i], i ? false : isLineStart, indentLevel);
+		if (i != variables.size() - 1) write(fragment, ", ");
 	}
 
 	if (!expressions.size()) return;
-	write(separator);
+	write(fragment, separator);
 
 	for (uint8_t i = 0; i < expressions.size(); i++) {
 		if (i != expressions.size() - 1) {
-			write_expression(*expressions[i], false);
-			write(", ");
+			write_expression(fragment, *expressions[i], false, indentLevel);
+			write(fragment, ", ");
 			continue;
 		}
 
@@ -743,14 +876,14 @@ void Lua::write_assignment(const std::vector<Ast::Variable>& variables, const st
 			switch (expressions[i]->type) {
 			case Ast::AST_EXPRESSION_VARARG:
 				if (expressions[i]->returnCount == 1) {
-					write_expression(*expressions[i], true);
+					write_expression(fragment, *expressions[i], true, indentLevel);
 					continue;
 				}
 
 				break;
 			case Ast::AST_EXPRESSION_FUNCTION_CALL:
 				if (expressions[i]->functionCall->returnCount == 1) {
-					write_expression(*expressions[i], true);
+					write_expression(fragment, *expressions[i], true, indentLevel);
 					continue;
 				}
 
@@ -758,61 +891,118 @@ void Lua::write_assignment(const std::vector<Ast::Variable>& variables, const st
 			}
 		}
 
-		write_expression(*expressions[i], false);
+		write_expression(fragment, *expressions[i], false, indentLevel);
 	}
 }
 
-void Lua::write_expression_list(const std::vector<Ast::Expression*>& expressions, const Ast::Expression* const& multres) {
+void Lua::write_expression_list(Fragment& fragment, const std::vector<Ast::Expression*>& expressions, const Ast::Expression* const& multres, const uint32_t& indentLevel) {
 	for (uint8_t i = 0; i < expressions.size(); i++) {
 		if (i != expressions.size() - 1 || multres) {
-			write_expression(*expressions[i], false);
-			write(", ");
+			write_expression(fragment, *expressions[i], false, indentLevel);
+			write(fragment, ", ");
 			continue;
 		}
 
 		switch (expressions[i]->type) {
 		case Ast::AST_EXPRESSION_VARARG:
 		case Ast::AST_EXPRESSION_FUNCTION_CALL:
-			write_expression(*expressions[i], true);
+			write_expression(fragment, *expressions[i], true, indentLevel);
 			continue;
 		}
 
-		write_expression(*expressions[i], false);
+		write_expression(fragment, *expressions[i], false, indentLevel);
 	}
 
-	if (multres) write_expression(*multres, false);
+	if (multres) write_expression(fragment, *multres, false, indentLevel);
 }
 
-void Lua::write_function_definition(const Ast::Function& function, const bool& isMethod) {
-	write("(");
+void Lua::write_function_definition(Fragment& fragment, const Ast::Function& function, const bool& isMethod, const uint32_t& indentLevel) {
+	write(fragment, "(");
 
 	for (uint8_t i = isMethod ? 1 : 0; i < function.parameterNames.size(); i++) {
-		write(function.parameterNames[i]);
-		if (i != function.parameterNames.size() - 1 || function.isVariadic) write(", ");
+		write_symbol(fragment, function.parameterNames[i]);
+		if (i != function.parameterNames.size() - 1 || function.isVariadic) write(fragment, ", ");
+	}
+
+	if (function.isVariadic) write(fragment, "...");
+	write(fragment, ")", NEW_LINE);
+
+	const auto fragmentIndex = fragmentIndices.find(&function);
+
+	if (fragmentIndex != fragmentIndices.end()) {
+		fragments[fragmentIndex->second].indentLevel = indentLevel + 1;
+		fragment.insertions.emplace_back(Fragment::Insertion{ .offset = fragment.buffer.size(), .fragment = fragmentIndex->second });
+	} else {
+		write_function_body(fragment, function, indentLevel + 1);
 	}
 
-	if (function.isVariadic) write("...");
-	write(")", NEW_LINE);
-	indentLevel++;
+	write_indent(fragment, indentLevel);
+	write(fragment, "end");
+}
+
+void Lua::write_function_body(Fragment& fragment, const Ast::Function& function, const uint32_t& indentLevel) {
 #if defined _DEBUG
-	write_indent();
-	write("-- function ", std::to_string(function.id), NEW_LINE);
+	write_indent(fragment, indentLevel);
+	write(fragment, "-- function ", std::to_string(function.id), NEW_LINE);
 #endif
 	if (function.block.size()) {
-		write_block(function, function.block);
+		write_block(fragment, function, function.block, indentLevel);
 	} else {
-		write_indent();
-		write("return", NEW_LINE);
+		write_indent(fragment, indentLevel);
+		write(fragment, "return", NEW_LINE);
 	}
 
-	indentLevel--;
-	write_indent();
-	write("end");
 	prototypeDataLeft -= function.prototype.prototypeSize;
-	print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
 }
 
-void Lua::write_number(const double& number) {
+uint32_t Lua::get_constant_list_size(const Ast::Table& table) {
+	return table.constants.prototype ? table.constants.array.size() : table.constants.list.size();
+}
+
+bool Lua::is_nil_list_constant(const Ast::Table& table, const uint32_t& index) {
+	return table.constants.prototype ? table.constants.array[index].type == Bytecode::BC_KTAB_NIL : table.constants.list[index]->constant->type == Ast::AST_CONSTANT_NIL;
+}
+
+void Lua::write_list_constant(Fragment& fragment, const Ast::Table& table, const uint32_t& index, const uint32_t& indentLevel) {
+	if (table.constants.prototype) return write_table_constant(fragment, *table.constants.prototype, table.constants.array[index]);
+	write_expression(fragment, *table.constants.list[index], false, indentLevel);
+}
+
+void Lua::write_table_constant(Fragment& fragment, const Bytecode::Prototype& prototype, const Bytecode::TableConstant& constant) {
+	uint64_t rawDouble;
+
+	switch (constant.type) {
+	case Bytecode::BC_KTAB_NIL:
+		write(fragment, "nil");
+		break;
+	case Bytecode::BC_KTAB_FALSE:
+		write(fragment, "false");
+		break;
+	case Bytecode::BC_KTAB_TRUE:
+		write(fragment, "true");
+		break;
+	case Bytecode::BC_KTAB_INT:
+		write_number(fragment, std::bit_cast<int32_t>(constant.integer));
+		break;
+	case Bytecode::BC_KTAB_NUM:
+		rawDouble = constant.number;
+
+		if ((rawDouble & DOUBLE_EXPONENT) == DOUBLE_SPECIAL) {
+			write(fragment, rawDouble & DOUBLE_SIGN ? "-1 / 0" : "1 / 0");
+			break;
+		}
+
+		write_number(fragment, std::bit_cast<double>(rawDouble));
+		break;
+	case Bytecode::BC_KTAB_STR:
+		write(fragment, "\"");
+		write_string(fragment, prototype.get_string(constant.string));
+		write(fragment, "\"");
+		break;
+	}
+}
+
+void Lua::write_number(Fragment& fragment, const double& number) {
 	static const auto try_string_to_number = [](const std::string& string, const double& number)->bool {
 		try {
 			return std::stod(string) == number;
@@ -824,7 +1014,7 @@ void Lua::write_number(const double& number) {
 	const uint64_t rawDouble = std::bit_cast<uint64_t>(number);
 
 	if ((rawDouble & DOUBLE_EXPONENT) == DOUBLE_SPECIAL) {
-		write(rawDouble & DOUBLE_SIGN ? "-1e309" : "1e309");
+		write(fragment, rawDouble & DOUBLE_SIGN ? "-1e309" : "1e309");
 		return;
 	}
 
@@ -843,10 +1033,10 @@ void Lua::write_number(const double& number) {
 		}
 	}
 
-	write(string);
+	write(fragment, string);
 }
 
-void Lua::write_string(const std::string& string) {
+void Lua::write_string(Fragment& fragment, const std::string_view& string) {
 	char escapeSequence[] = "\\x00";
 	uint32_t value;
 	uint8_t digit;
@@ -862,34 +1052,34 @@ void Lua::write_string(const std::string& string) {
 				switch (string[i]) {
 				case '"':
 				case '\\':
-					writeBuffer += '\\';
+					fragment.buffer += '\\';
 				}
 
-				writeBuffer += string[i];
+				fragment.buffer += string[i];
 				continue;
 			}
 
 			switch (string[i]) {
 			case '\a':
-				write("\\a");
+				write(fragment, "\\a");
 				continue;
 			case '\b':
-				write("\\b");
+				write(fragment, "\\b");
 				continue;
 			case '\t':
-				write("\\t");
+				write(fragment, "\\t");
 				continue;
 			case '\n':
-				write("\\n");
+				write(fragment, "\\n");
 				continue;
 			case '\v':
-				write("\\v");
+				write(fragment, "\\v");
 				continue;
 			case '\f':
-				write("\\f");
+				write(fragment, "\\f");
 				continue;
 			case '\r':
-				write("\\r");
+				write(fragment, "\\r");
 				continue;
 			}
 		} else if ((value & 0xE0) == 0xC0) {
@@ -900,8 +1090,8 @@ void Lua::write_string(const std::string& string) {
 				if ((value & 0xC0) == 0x80
 					&& value >= 0xC2A0
 					&& value <= 0xDFBF) {
-					writeBuffer += string[i];
-					writeBuffer += string[i + 1];
+					fragment.buffer += string[i];
+					fragment.buffer += string[i + 1];
 					i++;
 					continue;
 				}
@@ -917,9 +1107,9 @@ void Lua::write_string(const std::string& string) {
 							&& value < 0xEDA080)
 						|| (value > 0xEDBFBF
 							&& value <= 0xEFBFBF))) {
-					writeBuffer += string[i];
-					writeBuffer += string[i + 1];
-					writeBuffer += string[i + 2];
+					fragment.buffer += string[i];
+					fragment.buffer += string[i + 1];
+					fragment.buffer += string[i + 2];
 					i += 2;
 					continue;
 				}
@@ -934,10 +1124,10 @@ void Lua::write_string(const std::string& string) {
 				if ((value & 0xC0C0C0) == 0x808080
 					&& value >= 0xF0908080
 					&& value <= 0xF48FBFBF) {
-					writeBuffer += string[i];
-					writeBuffer += string[i + 1];
-					writeBuffer += string[i + 2];
-					writeBuffer += string[i + 3];
+					fragment.buffer += string[i];
+					fragment.buffer += string[i + 1];
+					fragment.buffer += string[i + 2];
+					fragment.buffer += string[i + 3];
 					i += 3;
 					continue;
 				}
@@ -949,7 +1139,7 @@ void Lua::write_string(const std::string& string) {
 			escapeSequence[3 - j] = digit >= 0xA ? 'A' + digit - 0xA : '0' + digit;
 		}
 
-		writeBuffer += escapeSequence;
+		fragment.buffer += escapeSequence;
 	}
 }
 
@@ -987,18 +1177,23 @@ uint8_t Lua::get_operator_precedence(const Ast::Expression& expression) {
 	return 8;
 }
 
-void Lua::write(const std::string& string) {
-	writeBuffer += string;
+void Lua::write_symbol(Fragment& fragment, const Ast::Symbol& symbol) {
+	char buffer[Ast::Symbol::MAX_SIZE];
+	write(fragment, symbol.format(buffer));
+}
+
+void Lua::write(Fragment& fragment, const std::string_view& string) {
+	fragment.buffer += string;
 }
 
 template <typename... Strings>
-void Lua::write(const std::string& string, const Strings&... strings) {
-	write(string);
-	return write(strings...);
+void Lua::write(Fragment& fragment, const std::string_view& string, const Strings&... strings) {
+	write(fragment, string);
+	return write(fragment, strings...);
 }
 
-void Lua::write_indent() {
-	return write(std::string(indentLevel, '\t'));
+void Lua::write_indent(Fragment& fragment, const uint32_t& indentLevel) {
+	return write(fragment, std::string(indentLevel, '\t'));
 }
 
 void Lua::create_file() {
@@ -1013,7 +1208,7 @@ void Lua::create_file() {
 		}
 	}
 #endif
-	file = CreateFileA(filePath.c_str(), GENERIC_WRITE, NULL, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	file = CreateFileA((filePath + TEMPORARY_EXTENSION).c_str(), GENERIC_WRITE, NULL, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
 	assert(file != INVALID_HANDLE_VALUE, "Unable to create file", filePath, DEBUG_INFO);
 }
 
@@ -1023,6 +1218,12 @@ void Lua::close_file() {
 	file = INVALID_HANDLE_VALUE;
 }
 
+void Lua::commit_file() {
+	assert(!flushFile || FlushFileBuffers(file), "Failed writing to file", filePath, DEBUG_INFO);
+	close_file();
+	assert(MoveFileExA((filePath + TEMPORARY_EXTENSION).c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH), "Failed to replace file", filePath, DEBUG_INFO);
+}
+
 void Lua::write_file() {
 	DWORD charsWritten = 0;
 	assert(WriteFile(file, writeBuffer.data(), writeBuffer.size(), &charsWritten, NULL) && !(writeBuffer.size() - charsWritten), "Failed writing to file", filePath, DEBUG_INFO);
@@ -1,7 +1,7 @@
 class Lua {
 public:
 
-	Lua(const Bytecode& bytecode, const Ast& ast, const std::string& filePath, const bool& forceOverwrite, const bool& minimizeDiffs, const bool& unrestrictedAscii);
+	Lua(const Bytecode& bytecode, Ast& ast, const std::string& filePath, const bool& forceOverwrite, const bool& minimizeDiffs, const bool& unrestrictedAscii, const bool& flushFile);
 	~Lua();
 
 	void operator()();
@@ -12,34 +12,61 @@ private:
 
 	static constexpr char UTF8_BOM[] = "\xEF\xBB\xBF";
 	static constexpr char NEW_LINE[] = "\r\n";
+	static constexpr char TEMPORARY_EXTENSION[] = ".tmp";
+	static constexpr uint32_t MIN_FRAGMENT_SIZE = 0x1000;
 
-	void write_header();
-	void write_block(const Ast::Function& function, const std::vector<Ast::Statement*>& block);
-	void write_expression(const Ast::Expression& expression, const bool& useParentheses);
-	void write_prefix_expression(const Ast::Expression& expression, const bool& isLineStart);
-	void write_variable(const Ast::Variable& variable, const bool& isLineStart);
-	void write_function_call(const Ast::FunctionCall& functionCall, const bool& isLineStart);
-	void write_assignment(const std::vector<Ast::Variable>& variables, const std::vector<Ast::Expression*>& expressions, const std::string& separator, const bool& isLineStart);
-	void write_expression_list(const std::vector<Ast::Expression*>& expressions, const Ast::Expression* const& multres);
-	void write_function_definition(const Ast::Function& function, const bool& isMethod);
-	void write_number(const double& number);
-	void write_string(const std::string& string);
+	struct Fragment {
+		struct Insertion {
+			uint64_t offset = 0;
+			uint32_t fragment = 0;
+		};
+
+		const Ast::Function* function = nullptr;
+		uint32_t indentLevel = 0;
+		std::string buffer;
+		std::vector<Insertion> insertions;
+	};
+
+	void collect_fragments(const Ast::Function& function);
+	void stream_chunk();
+	void write_fragment(const Fragment& fragment);
+	void write_chunk(Fragment& fragment);
+	void write_header(Fragment& fragment);
+	void write_block(Fragment& fragment, const Ast::Function& function, const std::vector<Ast::Statement*>& block, const uint32_t& indentLevel);
+	void write_expression(Fragment& fragment, const Ast::Expression& expression, const bool& useParentheses, const uint32_t& indentLevel);
+	void write_prefix_expression(Fragment& fragment, const Ast::Expression& expression, const bool& isLineStart, const uint32_t& indentLevel);
+	void write_variable(Fragment& fragment, const Ast::Variable& variable, const bool& isLineStart, const uint32_t& indentLevel);
+	void write_function_call(Fragment& fragment, const Ast::FunctionCall& functionCall, const bool& isLineStart, const uint32_t& indentLevel);
+	void write_assignment(Fragment& fragment, const std::vector<Ast::Variable>& variables, const std::vector<Ast::Expression*>& expressions, const std::string& separator, const bool& isLineStart, const uint32_t& indentLevel);
+	void write_expression_list(Fragment& fragment, const std::vector<Ast::Expression*>& expressions, const Ast::Expression* const& multres, const uint32_t& indentLevel);
+	void write_function_definition(Fragment& fragment, const Ast::Function& function, const bool& isMethod, const uint32_t& indentLevel);
+	void write_function_body(Fragment& fragment, const Ast::Function& function, const uint32_t& indentLevel);
+	uint32_t get_constant_list_size(const Ast::Table& table);
+	bool is_nil_list_constant(const Ast::Table& table, const uint32_t& index);
+	void write_list_constant(Fragment& fragment, const Ast::Table& table, const uint32_t& index, const uint32_t& indentLevel);
+	void write_table_constant(Fragment& fragment, const Bytecode::Prototype& prototype, const Bytecode::TableConstant& constant);
+	void write_number(Fragment& fragment, const double& number);
+	void write_string(Fragment& fragment, const std::string_view& string);
+	void write_symbol(Fragment& fragment, const Ast::Symbol& symbol);
 	uint8_t get_operator_precedence(const Ast::Expression& expression);
-	void write(const std::string& string);
+	void write(Fragment& fragment, const std::string_view& string);
 	template <typename... Strings>
-	void write(const std::string& string, const Strings&... strings);
-	void write_indent();
+	void write(Fragment& fragment, const std::string_view& string, const Strings&... strings);
+	void write_indent(Fragment& fragment, const uint32_t& indentLevel);
 	void create_file();
 	void close_file();
+	void commit_file();
 	void write_file();
 
 	const Bytecode& bytecode;
-	const Ast& ast;
+	Ast& ast;
 	const bool forceOverwrite;
 	const bool minimizeDiffs;
 	const bool unrestrictedAscii;
+	const bool flushFile;
 	HANDLE file = INVALID_HANDLE_VALUE;
 	std::string writeBuffer;
-	uint32_t indentLevel = 0;
-	uint64_t prototypeDataLeft = 0;
+	std::vector<Fragment> fragments;
+	std::unordered_map<const Ast::Function*, uint32_t> fragmentIndices;
+	std::atomic<uint64_t> prototypeDataLeft = 0;
 };
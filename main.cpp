@@ -1,6 +1,12 @@
 #include "main.h"
 
+enum ERROR_TYPE {
+	ERROR_ASSERTION,
+	ERROR_BUDGET
+};
+
 struct Error {
+	const ERROR_TYPE type;
 	const std::string message;
 	const std::string filePath;
 	const std::string function;
@@ -12,7 +18,9 @@ static const HANDLE CONSOLE_OUTPUT = GetStdHandle(STD_OUTPUT_HANDLE);
 //static const HANDLE CONSOLE_INPUT = GetStdHandle(STD_INPUT_HANDLE);
 static bool isCommandLine;
 static bool isProgressBarActive = false;
-static uint32_t filesSkipped = 0;
+static std::atomic<uint32_t> filesSkipped = 0;
+static std::atomic<uint32_t> filesResumed = 0;
+static constexpr uint32_t MAX_QUEUED_FILES = 0x400;
 
 static struct {
 	bool showHelp = false;
@@ -21,17 +29,46 @@ static struct {
 	bool ignoreDebugInfo = false;
 	bool minimizeDiffs = false;
 	bool unrestrictedAscii = false;
+	bool streaming = false;
+	bool nativeLineMaps = false;
+	bool resume = false;
+	uint32_t jobs = 1;
+	uint32_t shardIndex = 0;
+	uint32_t shardCount = 1;
+	uint32_t prototypeIndex = -1;
+	Ast::Budget budget;
+	uint32_t firstLine = 0;
+	uint32_t lastLine = 0;
 	std::string inputPath;
 	std::string outputPath;
 	std::string extensionFilter;
+	std::string fileList;
+	std::string journalPath;
 } arguments;
 
-struct Directory {
-	const std::string path;
-	std::vector<Directory> folders;
-	std::vector<std::string> files;
+struct BatchFile {
+	std::string path;
+	std::string name;
+	uint64_t size = 0;
+	uint64_t time = 0;
 };
 
+static struct {
+	SRWLOCK lock = SRWLOCK_INIT;
+	CONDITION_VARIABLE queueChanged = CONDITION_VARIABLE_INIT;
+	std::vector<BatchFile> queue;
+	uint32_t filesFound = 0;
+	bool isWalking = true;
+	std::atomic<bool> isAborted = false;
+	std::atomic<uint32_t> workerCount = 0;
+} batch;
+
+static struct {
+	SRWLOCK lock = SRWLOCK_INIT;
+	HANDLE file = INVALID_HANDLE_VALUE;
+	std::unordered_map<std::string, uint64_t> entries;
+} journal;
+
 static std::string string_to_lowercase(const std::string& string) {
 	std::string lowercaseString = string;
 
@@ -43,55 +80,375 @@ static std::string string_to_lowercase(const std::string& string) {
 	return lowercaseString;
 }
 
-static void find_files_recursively(Directory& directory) {
-	WIN32_FIND_DATAA pathData;
-	HANDLE handle = FindFirstFileA((arguments.inputPath + directory.path + '*').c_str(), &pathData);
-	if (handle == INVALID_HANDLE_VALUE) return;
+static bool is_function_selected() {
+	return arguments.prototypeIndex != -1 || arguments.lastLine;
+}
+
+static const Bytecode::Prototype& select_prototype(const Bytecode& bytecode) {
+	if (arguments.lastLine) {
+		const Bytecode::Prototype* const prototype = bytecode.get_prototype_from_lines(arguments.firstLine, arguments.lastLine);
+		assert(prototype, "No function found in lines " + std::to_string(arguments.firstLine) + "-" + std::to_string(arguments.lastLine), bytecode.filePath, DEBUG_INFO);
+		return *prototype;
+	}
+
+	assert(arguments.prototypeIndex < bytecode.get_prototype_count(), "Prototype index " + std::to_string(arguments.prototypeIndex) + " is out of range", bytecode.filePath, DEBUG_INFO);
+	return bytecode.get_prototype(arguments.prototypeIndex);
+}
+
+static bool parse_line_range(const char* const& string) {
+	char* end;
+	arguments.firstLine = std::strtoul(string, &end, 10);
+	if (end == string || *end != '-') return false;
+	arguments.lastLine = std::strtoul(end + 1, &end, 10);
+	return !*end && arguments.lastLine && arguments.firstLine <= arguments.lastLine;
+}
+
+static bool parse_limit(const char* const& string, uint64_t& limit, const uint64_t& unit) {
+	char* end;
+	limit = std::strtoull(string, &end, 10) * unit;
+	return end != string && !*end && limit;
+}
+
+static bool parse_job_count(const char* const& string) {
+	char* end;
+	arguments.jobs = std::strtoul(string, &end, 10);
+	return end != string && !*end && arguments.jobs;
+}
+
+static bool parse_shard(const char* const& string) {
+	char* end;
+	arguments.shardIndex = std::strtoul(string, &end, 10);
+	if (end == string || *end != '/') return false;
+	arguments.shardCount = std::strtoul(end + 1, &end, 10);
+	return !*end && arguments.shardIndex < arguments.shardCount;
+}
+
+static bool parse_prototype_index(const char* const& string) {
+	char* end;
+	arguments.prototypeIndex = std::strtoul(string, &end, 10);
+	return end != string && !*end;
+}
+
+static bool has_smaller_file(const BatchFile& first, const BatchFile& second) {
+	if (first.size != second.size) return first.size < second.size;
+	return std::tie(first.path, first.name) > std::tie(second.path, second.name);
+}
+
+static uint64_t get_hash(const std::string_view& string, uint64_t hash = 0xCBF29CE484222325) {
+	for (uint32_t i = 0; i < string.size(); i++) {
+		hash ^= string[i];
+		hash *= 0x100000001B3;
+	}
+
+	return hash;
+}
+
+static uint64_t get_file_hash(const BatchFile& file) {
+	const HANDLE handle = CreateFileA((arguments.inputPath + file.path + file.name).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return 0;
+	char buffer[0x10000];
+	DWORD bytesRead;
+	uint64_t hash = 0xCBF29CE484222325;
+
+	while (ReadFile(handle, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead) {
+		hash = get_hash(std::string_view(buffer, bytesRead), hash);
+	}
+
+	CloseHandle(handle);
+	return hash;
+}
+
+static std::string get_journal_entry(const BatchFile& file) {
+	return string_to_lowercase(file.path + file.name) + "|" + std::to_string(file.size) + "|" + std::to_string(file.time);
+}
+
+static bool load_journal() {
+	const HANDLE file = CreateFileA(arguments.journalPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return GetLastError() == ERROR_FILE_NOT_FOUND;
+	char buffer[0x10000];
+	DWORD bytesRead;
+	std::string line;
+	size_t hashOffset;
+	size_t fileHashOffset;
+	uint64_t hash;
+	uint64_t fileHash;
+
+	while (ReadFile(file, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead) {
+		for (DWORD i = 0; i < bytesRead; i++) {
+			if (buffer[i] != '\n') {
+				line += buffer[i];
+				continue;
+			}
+
+			hashOffset = line.find_last_of('|');
+
+			// empty lines from earlier resumes and torn lines from a crash are not entries
+			if (hashOffset == std::string::npos || !hashOffset) {
+				line.clear();
+				continue;
+			}
+
+			fileHashOffset = line.find_last_of('|', hashOffset - 1);
+
+			if (fileHashOffset != std::string::npos
+				&& std::from_chars(line.data() + hashOffset + 1, line.data() + line.size(), hash, 16).ptr == line.data() + line.size()
+				&& hash == get_hash(std::string_view(line.data(), hashOffset))
+				&& std::from_chars(line.data() + fileHashOffset + 1, line.data() + hashOffset, fileHash, 16).ptr == line.data() + hashOffset) {
+				journal.entries[line.substr(0, fileHashOffset)] = fileHash;
+			}
 
-	do {
-		if (pathData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-			if (!std::strcmp(pathData.cFileName, ".") || !std::strcmp(pathData.cFileName, "..")) continue;
-			directory.folders.emplace_back(Directory{ .path = directory.path + pathData.cFileName + "\\" });
-			find_files_recursively(directory.folders.back());
-			if (!directory.folders.back().files.size() && !directory.folders.back().folders.size()) directory.folders.pop_back();
-			continue;
+			line.clear();
 		}
+	}
 
-		if (!arguments.extensionFilter.size() || arguments.extensionFilter == string_to_lowercase(PathFindExtensionA(pathData.cFileName))) directory.files.emplace_back(pathData.cFileName);
-	} while (FindNextFileA(handle, &pathData));
+	CloseHandle(file);
+	return true;
+}
 
-	FindClose(handle);
+static bool open_journal() {
+	if (arguments.resume && !load_journal()) return false;
+	journal.file = CreateFileA(arguments.journalPath.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, arguments.resume ? OPEN_ALWAYS : CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_WRITE_THROUGH, NULL);
+	if (journal.file == INVALID_HANDLE_VALUE) return false;
+	DWORD bytesWritten;
+	// a torn last line from a crash must not swallow the next entry
+	return !arguments.resume || WriteFile(journal.file, "\n", 1, &bytesWritten, NULL);
 }
 
-static bool decompile_files_recursively(const Directory& directory) {
-	CreateDirectoryA((arguments.outputPath + directory.path).c_str(), NULL);
-	std::string outputFile;
+static void record_journal_entry(const BatchFile& file, const uint64_t& fileHash) {
+	if (journal.file == INVALID_HANDLE_VALUE) return;
+	std::string line = get_journal_entry(file);
+	char hash[16];
+	line += "|";
+	line.append(hash, std::to_chars(hash, hash + sizeof(hash), fileHash, 16).ptr);
+	line += "|";
+	line.append(hash, std::to_chars(hash, hash + sizeof(hash), get_hash(std::string_view(line.data(), line.size() - 1)), 16).ptr);
+	line += "\n";
+	DWORD bytesWritten;
+	AcquireSRWLockExclusive(&journal.lock);
+	const bool isWritten = WriteFile(journal.file, line.data(), line.size(), &bytesWritten, NULL) && bytesWritten == line.size();
+	ReleaseSRWLockExclusive(&journal.lock);
+	assert(isWritten, "Failed to write journal: " + arguments.journalPath, arguments.inputPath + file.path + file.name, DEBUG_INFO);
+}
+
+static bool queue_file(const BatchFile& file) {
+	if (journal.entries.size()) {
+		const auto entry = journal.entries.find(get_journal_entry(file));
+
+		// size and mtime only pick the candidates, the input bytes decide
+		if (entry != journal.entries.end() && entry->second == get_file_hash(file)) {
+			filesResumed++;
+			return !batch.isAborted;
+		}
+	}
+
+	AcquireSRWLockExclusive(&batch.lock);
+
+	// without a running worker nothing would drain the queue
+	while (batch.queue.size() >= MAX_QUEUED_FILES && batch.workerCount && !batch.isAborted) {
+		SleepConditionVariableSRW(&batch.queueChanged, &batch.lock, INFINITE, 0);
+	}
 
-	for (uint32_t i = 0; i < directory.files.size(); i++) {
-		outputFile = directory.files[i];
-		PathRemoveExtensionA(outputFile.data());
-		outputFile = outputFile.c_str();
-		outputFile += ".lua";
+	const bool isAborted = batch.isAborted;
 
-		Bytecode bytecode(arguments.inputPath + directory.path + directory.files[i]);
-		Ast ast(bytecode, arguments.ignoreDebugInfo, arguments.minimizeDiffs);
-		Lua lua(bytecode, ast, arguments.outputPath + directory.path + outputFile, arguments.forceOverwrite, arguments.minimizeDiffs, arguments.unrestrictedAscii);
+	if (!isAborted) {
+		batch.queue.emplace_back(file);
+		std::push_heap(batch.queue.begin(), batch.queue.end(), has_smaller_file);
+		batch.filesFound++;
+	}
+
+	ReleaseSRWLockExclusive(&batch.lock);
+	WakeAllConditionVariable(&batch.queueChanged);
+	return !isAborted;
+}
 
+static bool dequeue_file(BatchFile& file) {
+	AcquireSRWLockExclusive(&batch.lock);
+
+	while (!batch.queue.size() && batch.isWalking && !batch.isAborted) {
+		SleepConditionVariableSRW(&batch.queueChanged, &batch.lock, INFINITE, 0);
+	}
+
+	const bool hasFile = batch.queue.size() && !batch.isAborted;
+
+	if (hasFile) {
+		std::pop_heap(batch.queue.begin(), batch.queue.end(), has_smaller_file);
+		file = std::move(batch.queue.back());
+		batch.queue.pop_back();
+	}
+
+	ReleaseSRWLockExclusive(&batch.lock);
+	WakeAllConditionVariable(&batch.queueChanged);
+	return hasFile;
+}
+
+static void stop_batch(const bool& isAborted) {
+	AcquireSRWLockExclusive(&batch.lock);
+
+	if (isAborted) {
+		batch.isAborted = true;
+	} else {
+		batch.isWalking = false;
+	}
+
+	ReleaseSRWLockExclusive(&batch.lock);
+	WakeAllConditionVariable(&batch.queueChanged);
+}
+
+static void create_output_directory(const std::string& path) {
+	CreateDirectoryA(arguments.outputPath.c_str(), NULL);
+
+	for (uint32_t i = 0; i < path.size(); i++) {
+		if (path[i] != '\\') continue;
+		CreateDirectoryA((arguments.outputPath + path.substr(0, i)).c_str(), NULL);
+	}
+}
+
+static bool is_file_in_shard(const std::string& path) {
+	if (arguments.shardCount == 1) return true;
+	return get_hash(string_to_lowercase(path)) % arguments.shardCount == arguments.shardIndex;
+}
+
+static bool queue_list_entry(std::string& entry) {
+	if (entry.size() && entry.back() == '\r') entry.pop_back();
+	if (!entry.size()) return true;
+	std::replace(entry.begin(), entry.end(), '/', '\\');
+	if (entry.starts_with(".\\")) entry.erase(0, 2);
+	if (!is_file_in_shard(entry)) return true;
+	const uint32_t nameOffset = entry.find_last_of('\\') + 1;
+	BatchFile file = { .path = entry.substr(0, nameOffset), .name = entry.substr(nameOffset) };
+	WIN32_FILE_ATTRIBUTE_DATA fileData;
+
+	if (GetFileAttributesExA((arguments.inputPath + entry).c_str(), GetFileExInfoStandard, &fileData)) {
+		file.size = ((uint64_t)fileData.nFileSizeHigh << 32) | fileData.nFileSizeLow;
+		file.time = ((uint64_t)fileData.ftLastWriteTime.dwHighDateTime << 32) | fileData.ftLastWriteTime.dwLowDateTime;
+	}
+
+	create_output_directory(file.path);
+	return queue_file(file);
+}
+
+static void read_file_list() {
+	const bool isStandardInput = arguments.fileList == "-";
+	const HANDLE file = isStandardInput ? GetStdHandle(STD_INPUT_HANDLE)
+		: CreateFileA(arguments.fileList.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return;
+	char buffer[0x10000];
+	DWORD bytesRead;
+	std::string entry;
+	bool isQueued = true;
+
+	while (isQueued && ReadFile(file, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead) {
+		for (DWORD i = 0; isQueued && i < bytesRead; i++) {
+			if (buffer[i] != '\n') {
+				entry += buffer[i];
+				continue;
+			}
+
+			isQueued = queue_list_entry(entry);
+			entry.clear();
+		}
+	}
+
+	if (isQueued) queue_list_entry(entry);
+	if (!isStandardInput) CloseHandle(file);
+}
+
+static void walk_directories() {
+	run_task_tree<std::string>(get_processor_count(), { "" }, std::less<std::string>(), [](const uint32_t& worker, const std::string& path, std::vector<std::string>& folders) {
+		if (batch.isAborted) return;
+		WIN32_FIND_DATAA pathData;
+		HANDLE handle = FindFirstFileA((arguments.inputPath + path + '*').c_str(), &pathData);
+		if (handle == INVALID_HANDLE_VALUE) return;
+		bool hasOutputDirectory = false;
+
+		do {
+			if (pathData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				if (!std::strcmp(pathData.cFileName, ".") || !std::strcmp(pathData.cFileName, "..")) continue;
+				folders.emplace_back(path + pathData.cFileName + "\\");
+				continue;
+			}
+
+			if ((arguments.extensionFilter.size() && arguments.extensionFilter != string_to_lowercase(PathFindExtensionA(pathData.cFileName)))
+				|| !is_file_in_shard(path + pathData.cFileName)) continue;
+
+			if (!hasOutputDirectory) {
+				create_output_directory(path);
+				hasOutputDirectory = true;
+			}
+
+			if (queue_file(BatchFile{
+				.path = path,
+				.name = pathData.cFileName,
+				.size = ((uint64_t)pathData.nFileSizeHigh << 32) | pathData.nFileSizeLow,
+				.time = ((uint64_t)pathData.ftLastWriteTime.dwHighDateTime << 32) | pathData.ftLastWriteTime.dwLowDateTime
+			})) continue;
+			folders.clear();
+			break;
+		} while (FindNextFileA(handle, &pathData));
+
+		FindClose(handle);
+	});
+}
+
+static void decompile_file(const BatchFile& file) {
+	const bool isVerbose = arguments.jobs == 1;
+	std::string outputFile = file.name;
+	PathRemoveExtensionA(outputFile.data());
+	outputFile = outputFile.c_str();
+	outputFile += ".lua";
+
+	if (arguments.jobs > 1 && !arguments.forceOverwrite && GetFileAttributesA((arguments.outputPath + file.path + outputFile).c_str()) != INVALID_FILE_ATTRIBUTES) {
+		print("\nFile skipped: " + arguments.inputPath + file.path + file.name + "\nOutput file " + arguments.outputPath + file.path + outputFile + " already exists\n");
+		filesSkipped++;
+		return;
+	}
+
+	const uint64_t fileHash = journal.file != INVALID_HANDLE_VALUE ? get_file_hash(file) : 0;
+	Bytecode bytecode(arguments.inputPath + file.path + file.name, arguments.nativeLineMaps, is_function_selected() || arguments.streaming);
+	Ast ast(bytecode, arguments.ignoreDebugInfo, arguments.minimizeDiffs, arguments.streaming, arguments.budget);
+	Lua lua(bytecode, ast, arguments.outputPath + file.path + outputFile, arguments.forceOverwrite || arguments.jobs > 1, arguments.minimizeDiffs, arguments.unrestrictedAscii, journal.file != INVALID_HANDLE_VALUE);
+
+	if (isVerbose) print("--------------------\nInput file: " + bytecode.filePath + "\nReading bytecode...");
+	bytecode([&ast] { ast.check_budget(); });
+	if (isVerbose) print("Building ast...");
+
+	if (is_function_selected()) {
+		ast(select_prototype(bytecode));
+	} else {
+		ast();
+	}
+
+	if (isVerbose) print("Writing lua source...");
+	lua();
+	record_journal_entry(file, fileHash);
+	print("Output file: " + lua.filePath);
+}
+
+static bool decompile_batch_file(const BatchFile& file) {
+	while (true) {
 		try {
-			print("--------------------\nInput file: " + bytecode.filePath + "\nReading bytecode...");
-			bytecode();
-			print("Building ast...");
-			ast();
-			print("Writing lua source...");
-			lua();
-			print("Output file: " + lua.filePath);
+			decompile_file(file);
+			return true;
 		} catch (const Error& error) {
 			erase_progress_bar();
 
+			if (arguments.jobs > 1) {
+				print("\nFile skipped: " + error.filePath + "\n" + (error.type == ERROR_BUDGET ? "" : "Error running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n") + error.message + "\n");
+				filesSkipped++;
+				return true;
+			}
+
+			if (error.type == ERROR_BUDGET) {
+				print("\nFile skipped: " + error.message);
+				filesSkipped++;
+				return true;
+			}
+
 			if (arguments.silentAssertions) {
 				print("\nError running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n\n" + error.message);
 				filesSkipped++;
-				continue;
+				return true;
 			}
 
 			switch (MessageBoxA(NULL, ("Error running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n\nFile: " + error.filePath + "\n\n" + error.message).c_str(),
@@ -100,23 +457,49 @@ static bool decompile_files_recursively(const Directory& directory) {
 				return false;
 			case IDTRYAGAIN:
 				print("Retrying...");
-				i--;
 				continue;
 			case IDCONTINUE:
 				print("File skipped.");
 				filesSkipped++;
 			}
+
+			return true;
 		} catch (...) {
-			MessageBoxA(NULL, std::string("Unknown exception\n\nFile: " + bytecode.filePath).c_str(), PROGRAM_NAME, MB_ICONERROR | MB_OK);
+			MessageBoxA(NULL, std::string("Unknown exception\n\nFile: " + arguments.inputPath + file.path + file.name).c_str(), PROGRAM_NAME, MB_ICONERROR | MB_OK);
 			throw;
 		}
 	}
+}
 
-	for (uint32_t i = 0; i < directory.folders.size(); i++) {
-		if (!decompile_files_recursively(directory.folders[i])) return false;
-	}
+static bool decompile_directory() {
+	run_parallel(arguments.jobs + 1, [](const uint32_t& worker) {
+		try {
+			if (!worker) {
+				if (arguments.fileList.size()) {
+					read_file_list();
+				} else {
+					walk_directories();
+				}
 
-	return true;
+				stop_batch(false);
+				return;
+			}
+
+			BatchFile file;
+			batch.workerCount++;
+
+			while (dequeue_file(file)) {
+				if (decompile_batch_file(file)) continue;
+				stop_batch(true);
+				break;
+			}
+		} catch (...) {
+			stop_batch(true);
+			throw;
+		}
+	});
+
+	return !batch.isAborted;
 }
 
 static char* parse_arguments(const int& argc, char** const& argv) {
@@ -150,24 +533,80 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 				} else if (argument == "force_overwrite") {
 					arguments.forceOverwrite = true;
 					continue;
+				} else if (argument == "from_list") {
+					if (i <= argc - 2) {
+						i++;
+						arguments.fileList = argv[i];
+						continue;
+					}
 				} else if (argument == "help") {
 					arguments.showHelp = true;
 					continue;
 				} else if (argument == "ignore_debug_info") {
 					arguments.ignoreDebugInfo = true;
 					continue;
+				} else if (argument == "jobs") {
+					if (i <= argc - 2 && parse_job_count(argv[i + 1])) {
+						i++;
+						continue;
+					}
+				} else if (argument == "journal") {
+					if (i <= argc - 2) {
+						i++;
+						arguments.journalPath = argv[i];
+						continue;
+					}
+				} else if (argument == "lines") {
+					if (i <= argc - 2 && parse_line_range(argv[i + 1])) {
+						i++;
+						continue;
+					}
+				} else if (argument == "memory_limit") {
+					if (i <= argc - 2 && parse_limit(argv[i + 1], arguments.budget.memoryLimit, 1 << 20)) {
+						i++;
+						continue;
+					}
 				} else if (argument == "minimize_diffs") {
 					arguments.minimizeDiffs = true;
 					continue;
+				} else if (argument == "native_line_maps") {
+					arguments.nativeLineMaps = true;
+					continue;
+				} else if (argument == "node_limit") {
+					if (i <= argc - 2 && parse_limit(argv[i + 1], arguments.budget.nodeLimit, 1)) {
+						i++;
+						continue;
+					}
 				} else if (argument == "output") {
 					if (i <= argc - 2) {
 						i++;
 						arguments.outputPath = argv[i];
 						continue;
 					}
+				} else if (argument == "prototype") {
+					if (i <= argc - 2 && parse_prototype_index(argv[i + 1])) {
+						i++;
+						continue;
+					}
+				} else if (argument == "resume") {
+					arguments.resume = true;
+					continue;
+				} else if (argument == "shard") {
+					if (i <= argc - 2 && parse_shard(argv[i + 1])) {
+						i++;
+						continue;
+					}
 				} else if (argument == "silent_assertions") {
 					arguments.silentAssertions = true;
 					continue;
+				} else if (argument == "streaming") {
+					arguments.streaming = true;
+					continue;
+				} else if (argument == "time_limit") {
+					if (i <= argc - 2 && parse_limit(argv[i + 1], arguments.budget.timeLimit, 1000)) {
+						i++;
+						continue;
+					}
 				} else if (argument == "unrestricted_ascii") {
 					arguments.unrestrictedAscii = true;
 					continue;
@@ -189,6 +628,14 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 				case 'i':
 					arguments.ignoreDebugInfo = true;
 					continue;
+				case 'j':
+					if (i > argc - 2 || !parse_job_count(argv[i + 1])) break;
+					i++;
+					continue;
+				case 'l':
+					if (i > argc - 2 || !parse_line_range(argv[i + 1])) break;
+					i++;
+					continue;
 				case 'm':
 					arguments.minimizeDiffs = true;
 					continue;
@@ -197,6 +644,10 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 					i++;
 					arguments.outputPath = argv[i];
 					continue;
+				case 'p':
+					if (i > argc - 2 || !parse_prototype_index(argv[i + 1])) break;
+					i++;
+					continue;
 				case 's':
 					arguments.silentAssertions = true;
 					continue;
@@ -256,12 +707,33 @@ int main(int argc, char* argv[]) {
 			"\t\t\t\t  and auto skip files that fail to decompile\n"
 			"  -f, --force_overwrite\t\tAlways overwrite existing files\n"
 			"  -i, --ignore_debug_info\tIgnore bytecode debug info\n"
+			"  -j, --jobs COUNT\t\tDecompile up to COUNT files at once, starting while\n"
+			"\t\t\t\t  the input is listed, largest of the next 1024 first;\n"
+			"\t\t\t\t  existing output files are skipped unless -f is set\n"
 			"  -m, --minimize_diffs\t\tOptimize output formatting to help minimize diffs\n"
-			"  -u, --unrestricted_ascii\tDisable default UTF-8 encoding and string restrictions"
+			"  -u, --unrestricted_ascii\tDisable default UTF-8 encoding and string restrictions\n"
+			"  -p, --prototype INDEX\t\tOnly decompile the function with the specified prototype index\n"
+			"  -l, --lines FIRST-LAST\t\tOnly decompile the innermost function containing the line range\n"
+			"  --streaming\t\t\tDecompile and write one top level function at a time\n"
+			"\t\t\t\t  to keep memory usage bounded for very large files\n"
+			"  --native_line_maps\t\tKeep debug line maps at their stored width\n"
+			"\t\t\t\t  and widen entries only when they are read\n"
+			"  --time_limit SECONDS\t\tSkip files that take longer to decompile\n"
+			"  --node_limit COUNT\t\tSkip files that need more syntax tree nodes\n"
+			"  --memory_limit MB\t\tSkip files whose syntax tree nodes need more memory\n"
+			"  --from_list LIST_FILE\t\tDecompile the files listed in LIST_FILE, or stdin if -,\n"
+			"\t\t\t\t  with paths relative to INPUT_PATH (default: current folder)\n"
+			"  --shard INDEX/COUNT\t\tOnly decompile files whose path hash falls in shard INDEX,\n"
+			"\t\t\t\t  counting from 0, out of COUNT\n"
+			"  --journal JOURNAL_FILE\tRecord each completed input file in JOURNAL_FILE\n"
+			"  --resume\t\t\tSkip input files already completed in the journal\n"
+			"\t\t\t\t  (default: OUTPUT_PATH\\decompile.journal)"
 		);
 		return EXIT_SUCCESS;
 	}
 	
+	if (!arguments.inputPath.size() && arguments.fileList.size()) arguments.inputPath = ".\\";
+
 	if (!arguments.inputPath.size()) {
 		print("No input path specified!");
 		if (isCommandLine) return EXIT_FAILURE;
@@ -330,43 +802,73 @@ int main(int argc, char* argv[]) {
 		return EXIT_FAILURE;
 	}
 
-	Directory root;
+	if ((arguments.fileList.size() || arguments.journalPath.size() || arguments.resume) && !(pathAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		print("Input path is not a folder!");
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
+	if (arguments.fileList.size() && arguments.fileList != "-" && GetFileAttributesA(arguments.fileList.c_str()) == INVALID_FILE_ATTRIBUTES) {
+		print("Failed to open file list: " + arguments.fileList);
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
 
-	if (pathAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-		switch (arguments.inputPath.back()) {
-		case '/':
-		case '\\':
-			break;
-		default:
-			arguments.inputPath += '\\';
-			break;
-		}
+	if (arguments.resume && !arguments.journalPath.size()) arguments.journalPath = arguments.outputPath + "decompile.journal";
 
-		find_files_recursively(root);
+	if (arguments.journalPath.size()) {
+		create_output_directory("");
 
-		if (!root.files.size() && !root.folders.size()) {
-			print("No files " + (arguments.extensionFilter.size() ? "with extension " + arguments.extensionFilter + " " : "") + "found in path: " + arguments.inputPath);
+		if (!open_journal()) {
+			print("Failed to open journal: " + arguments.journalPath);
 			wait_for_exit();
 			return EXIT_FAILURE;
 		}
-	} else {
-		root.files.emplace_back(PathFindFileNameA(arguments.inputPath.c_str()));
-		*PathFindFileNameA(arguments.inputPath.c_str()) = '\x00';
-		arguments.inputPath = arguments.inputPath.c_str();
 	}
 
+	bool isCompleted;
+
 	try {
-		if (!decompile_files_recursively(root)) {
-			print("--------------------\nAborted!");
-			wait_for_exit();
-			return EXIT_FAILURE;
+		if (pathAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			switch (arguments.inputPath.back()) {
+			case '/':
+			case '\\':
+				break;
+			default:
+				arguments.inputPath += '\\';
+				break;
+			}
+
+			isCompleted = decompile_directory();
+
+			if (isCompleted && !batch.filesFound && !filesResumed) {
+				print(arguments.fileList.size() ? "No files found in list: " + arguments.fileList
+					: "No files " + (arguments.extensionFilter.size() ? "with extension " + arguments.extensionFilter + " " : "") + "found in path: " + arguments.inputPath);
+				wait_for_exit();
+				return EXIT_FAILURE;
+			}
+		} else {
+			const BatchFile file = { .name = PathFindFileNameA(arguments.inputPath.c_str()) };
+			*PathFindFileNameA(arguments.inputPath.c_str()) = '\x00';
+			arguments.inputPath = arguments.inputPath.c_str();
+			create_output_directory("");
+			run_parallel(1, [&isCompleted, &file](const uint32_t& worker) {
+				isCompleted = decompile_batch_file(file);
+			});
 		}
 	} catch (...) {
 		throw;
 	}
 
+	if (!isCompleted) {
+		print("--------------------\nAborted!");
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
 #ifndef _DEBUG
-	print("--------------------\n" + (filesSkipped ? "Failed to decompile " + std::to_string(filesSkipped) + " file" + (filesSkipped > 1 ? "s" : "") + ".\n" : "") + "Done!");
+	print("--------------------\n" + (filesResumed ? "Resumed past " + std::to_string(filesResumed) + " completed file" + (filesResumed > 1 ? "s" : "") + ".\n" : "")
+		+ (filesSkipped ? "Failed to decompile " + std::to_string(filesSkipped) + " file" + (filesSkipped > 1 ? "s" : "") + ".\n" : "") + "Done!");
 	wait_for_exit();
 #endif
 	return EXIT_SUCCESS;
@@ -389,6 +891,8 @@ std::string input() {
 void print_progress_bar(const double& progress, const double& total) {
 	static char PROGRESS_BAR[] = "\r[====================]";
 
+	if (arguments.jobs > 1) return;
+
 	const uint8_t threshold = std::round(20 / total * progress);
 
 	for (uint8_t i = 20; i--;) {
@@ -409,6 +913,18 @@ void erase_progress_bar() {
 
 void assert(const bool& assertion, const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line) {
 	if (!assertion) throw Error{
+		.type = ERROR_ASSERTION,
+		.message = message,
+		.filePath = filePath,
+		.function = function,
+		.source = source,
+		.line = std::to_string(line)
+	};
+}
+
+void exceed_budget(const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line) {
+	throw Error{
+		.type = ERROR_BUDGET,
 		.message = message,
 		.filePath = filePath,
 		.function = function,
@@ -428,3 +944,61 @@ std::string byte_to_string(const uint8_t& byte) {
 
 	return string;
 }
+
+uint32_t get_processor_count() {
+	static const uint32_t PROCESSOR_COUNT = std::max<uint32_t>(GetActiveProcessorCount(ALL_PROCESSOR_GROUPS), 1);
+	return PROCESSOR_COUNT;
+}
+
+uint32_t get_file_thread_count() {
+	return std::max<uint32_t>(get_processor_count() / arguments.jobs, 1);
+}
+
+void run_parallel(const uint32_t& threadCount, const std::function<void(const uint32_t& worker)>& task) {
+	struct Worker {
+		const std::function<void(const uint32_t& worker)>& task;
+		const uint32_t index;
+		std::exception_ptr exception;
+	};
+
+	static const LPTHREAD_START_ROUTINE run_worker = [](LPVOID parameter)->DWORD {
+		Worker& worker = *(Worker*)parameter;
+
+		try {
+			worker.task(worker.index);
+		} catch (...) {
+			worker.exception = std::current_exception();
+		}
+
+		return 0;
+	};
+
+	std::vector<Worker> workers;
+	std::vector<HANDLE> threads;
+	workers.reserve(threadCount);
+	threads.reserve(threadCount);
+
+	for (uint32_t i = 0; i < threadCount; i++) {
+		workers.emplace_back(Worker{ .task = task, .index = i });
+	}
+
+	for (uint32_t i = 0; i < workers.size(); i++) {
+		const HANDLE thread = CreateThread(NULL, THREAD_STACK_SIZE, run_worker, &workers[i], STACK_SIZE_PARAM_IS_A_RESERVATION, NULL);
+		if (!thread) break;
+		threads.emplace_back(thread);
+	}
+
+	// workers without a thread still run, one after another on this thread
+	for (uint32_t i = threads.size(); i < workers.size(); i++) {
+		run_worker(&workers[i]);
+	}
+
+	for (uint32_t i = threads.size(); i--;) {
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+
+	for (uint32_t i = 0; i < workers.size(); i++) {
+		if (workers[i].exception) std::rethrow_exception(workers[i].exception);
+	}
+}
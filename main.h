@@ -14,13 +14,26 @@ Requirements:
 #pragma comment(linker, "/manifestdependency:\"type='win32' name='Microsoft.Windows.Common-Controls' version='6.0.0.0' processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 #pragma comment(lib, "shlwapi.lib")
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <bit>
+#include <charconv>
 #include <cmath>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <emmintrin.h>
+
 #include <windows.h>
 #include <conio.h>
 #include <fileapi.h>
@@ -34,13 +47,69 @@ constexpr uint64_t DOUBLE_EXPONENT = 0x7FF0000000000000;
 constexpr uint64_t DOUBLE_FRACTION = 0x000FFFFFFFFFFFFF;
 constexpr uint64_t DOUBLE_SPECIAL = DOUBLE_EXPONENT;
 constexpr uint64_t DOUBLE_NEGATIVE_ZERO = DOUBLE_SIGN;
+constexpr uint32_t THREAD_STACK_SIZE = 268435456;
 
 void print(const std::string& message);
 //std::string input();
 void print_progress_bar(const double& progress = 0, const double& total = 100);
 void erase_progress_bar();
 void assert(const bool& assertion, const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line);
+void exceed_budget(const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line);
 std::string byte_to_string(const uint8_t& byte);
+uint32_t get_processor_count();
+uint32_t get_file_thread_count();
+void run_parallel(const uint32_t& threadCount, const std::function<void(const uint32_t& worker)>& task);
+
+template <typename Task, typename Compare>
+void run_task_tree(const uint32_t& threadCount, std::vector<Task> queue, const Compare& compare, const std::function<void(const uint32_t& worker, const Task& task, std::vector<Task>& subtasks)>& run_task) {
+	uint32_t tasksPending = queue.size();
+	bool isAborted = false;
+	SRWLOCK lock = SRWLOCK_INIT;
+	CONDITION_VARIABLE queueChanged = CONDITION_VARIABLE_INIT;
+	std::make_heap(queue.begin(), queue.end(), compare);
+
+	run_parallel(threadCount, [&](const uint32_t& worker) {
+		std::vector<Task> subtasks;
+		Task task;
+		AcquireSRWLockExclusive(&lock);
+
+		while (true) {
+			while (!queue.size() && tasksPending && !isAborted) {
+				SleepConditionVariableSRW(&queueChanged, &lock, INFINITE, 0);
+			}
+
+			if (!queue.size() || isAborted) break;
+			std::pop_heap(queue.begin(), queue.end(), compare);
+			task = queue.back();
+			queue.pop_back();
+			ReleaseSRWLockExclusive(&lock);
+
+			try {
+				run_task(worker, task, subtasks);
+			} catch (...) {
+				AcquireSRWLockExclusive(&lock);
+				isAborted = true;
+				ReleaseSRWLockExclusive(&lock);
+				WakeAllConditionVariable(&queueChanged);
+				throw;
+			}
+
+			AcquireSRWLockExclusive(&lock);
+
+			for (uint32_t i = 0; i < subtasks.size(); i++) {
+				queue.emplace_back(subtasks[i]);
+				std::push_heap(queue.begin(), queue.end(), compare);
+			}
+
+			tasksPending += subtasks.size();
+			tasksPending--;
+			if (subtasks.size() || !tasksPending) WakeAllConditionVariable(&queueChanged);
+			subtasks.clear();
+		}
+
+		ReleaseSRWLockExclusive(&lock);
+	});
+}
 
 class Bytecode;
 class Ast;